@@ -19,6 +19,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 */
 
 #include "camera.h"
+#include <limits>
 
 namespace mf {
 
@@ -51,6 +52,17 @@ Eigen_vec3 camera::point(const spherical_coordinates& s) const {
 }
 
 
+void camera::project_batch
+(const ndarray_view<1, const point_xyz>& pts, const ndarray_view<1, image_coordinates_type>& coords_out) const {
+	Expects(pts.shape() == coords_out.shape());
+	const real nan = std::numeric_limits<real>::quiet_NaN();
+	for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(pts.size()); ++i) {
+		if(pts[i].is_null()) coords_out[i] = image_coordinates_type(nan, nan);
+		else coords_out[i] = project(Eigen_vec3(pts[i].position()));
+	}
+}
+
+
 Eigen_mat3 essential_matrix(const camera& from, const camera& to) {
 	Eigen_affine3 pose_transformation = from.transformation_to(to);
 	Eigen_vec3 translation = pose_transformation.translation();
@@ -27,6 +27,8 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include "../space_object.h"
 #include "../geometry/spherical_coordinates.h"
 #include "../eigen.h"
+#include "../nd/ndarray_view.h"
+#include "../point_cloud/point.h"
 
 namespace mf {
 
@@ -86,6 +88,12 @@ public:
 		return this->project(point(sp));
 	}
 
+	/// Project points \a pts to image coordinates \a coords_out.
+	/** Null points get NaN coordinates. \a coords_out must have same size as \a pts. Default implementation calls
+	 ** project() for each point, subclass may implement more efficient version. */
+	virtual void project_batch
+		(const ndarray_view<1, const point_xyz>& pts, const ndarray_view<1, image_coordinates_type>& coords_out) const;
+
 	/// Direction vector of ray pointing to point corresponding to image coordinates \a c.
 	/** Implemented by subclass. */
 	virtual Eigen_vec3 ray_direction(const image_coordinates_type& c) const = 0;
@@ -22,6 +22,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #define MF_DEPTH_CAMERA_H_
 
 #include "camera.h"
+#include <limits>
 
 namespace mf {
 
@@ -31,11 +32,28 @@ protected:
 	using camera::camera;
 	
 public:
+	using camera::project_batch;
+
 	virtual real depth(const Eigen_vec3& p) const = 0;
 	
 	virtual real depth(const spherical_coordinates& sp) const {
 		return this->depth(camera::point(sp));
 	}
+	
+	/// Project points \a pts to image coordinates \a coords_out and depths \a depth_out.
+	/** Like `camera::project_batch()`, null points also get NaN depth. Default implementation calls project() and
+	 ** depth() for each point. */
+	virtual void project_batch(
+		const ndarray_view<1, const point_xyz>& pts,
+		const ndarray_view<1, image_coordinates_type>& coords_out,
+		const ndarray_view<1, real>& depth_out
+	) const {
+		Expects(pts.shape() == coords_out.shape() && pts.shape() == depth_out.shape());
+		camera::project_batch(pts, coords_out);
+		const real nan = std::numeric_limits<real>::quiet_NaN();
+		for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(pts.size()); ++i)
+			depth_out[i] = pts[i].is_null() ? nan : depth(Eigen_vec3(pts[i].position()));
+	}
 
 	virtual Eigen_vec3 point(const image_coordinates_type& c, real depth) const = 0;
 };
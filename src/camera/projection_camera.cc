@@ -22,6 +22,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include <stdexcept>
 #include <cmath>
 #include <tuple>
+#include <limits>
 
 #include <iostream>
 
@@ -103,6 +104,65 @@ projection_camera::projection_camera
 	projection_camera(ps, read_intrinsic_matrix_(mat, dpar, img_sz)) { }
 
 
+std::size_t projection_camera::project_batch_(
+	const ndarray_view<1, const point_xyz>& pts,
+	const ndarray_view<1, image_coordinates_type>& coords_out,
+	const ndarray_view<1, real>& depth_out,
+	const cull_bounds* bounds,
+	const ndarray_view<1, byte>& mask_out
+) const {
+	Expects(pts.shape() == coords_out.shape());
+	Expects(depth_out.is_null() || pts.shape() == depth_out.shape());
+	Expects(mask_out.is_null() || pts.shape() == mask_out.shape());
+
+	// Points are stored with homogeneous coordinate w = 1, so one 4x4 product per point gives image coordinates and
+	// depth. Null points have w != 1 and are rejected before.
+	const Eigen_mat4& mat = world_to_image_.matrix();
+	const real nan = std::numeric_limits<real>::quiet_NaN();
+	std::size_t retained_count = 0;
+	for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(pts.size()); ++i) {
+		const point_xyz& pt = pts[i];
+		bool retained = ! pt.is_null();
+		Eigen_vec3 projected(nan, nan, nan);
+		if(retained) {
+			Eigen_vec4 h = mat * pt.homogeneous_coordinates;
+			projected = h.head<3>() / h[3];
+		}
+		if(retained && bounds != nullptr) retained =
+			(projected[0] >= bounds->image_min[0]) && (projected[0] < bounds->image_max[0]) &&
+			(projected[1] >= bounds->image_min[1]) && (projected[1] < bounds->image_max[1]) &&
+			(projected[2] >= bounds->depth_min) && (projected[2] <= bounds->depth_max);
+		if(! retained) projected.setConstant(nan);
+
+		coords_out[i] = projected.head<2>();
+		if(! depth_out.is_null()) depth_out[i] = projected[2];
+		if(! mask_out.is_null()) mask_out[i] = (retained ? 0xff : 0);
+		retained_count += retained;
+	}
+	return retained_count;
+}
+
+
+void projection_camera::project_batch(
+	const ndarray_view<1, const point_xyz>& pts,
+	const ndarray_view<1, image_coordinates_type>& coords_out,
+	const ndarray_view<1, real>& depth_out
+) const {
+	project_batch_(pts, coords_out, depth_out, nullptr, ndarray_view<1, byte>());
+}
+
+
+std::size_t projection_camera::project_batch(
+	const ndarray_view<1, const point_xyz>& pts,
+	const ndarray_view<1, image_coordinates_type>& coords_out,
+	const ndarray_view<1, real>& depth_out,
+	const cull_bounds& bounds,
+	const ndarray_view<1, byte>& mask_out
+) const {
+	return project_batch_(pts, coords_out, depth_out, &bounds, mask_out);
+}
+
+
 Eigen_mat3 projection_camera::intrinsic_matrix() const {
 	const Eigen_mat4& view_to_image = view_to_image_.matrix();
 	Eigen_mat3 intrinsic; intrinsic <<
@@ -37,6 +37,16 @@ public:
 		Eigen_vec2 offset; ///< After scaling, maps coordinates to `[-scale+offset, +scale+offset]`.
 	};
 	
+	/// Bounds for culling in project_batch().
+	/** Point is retained iff `image_min[i] <= c[i] < image_max[i]` for its image coordinates `c`, and
+	 ** `depth_min <= d <= depth_max` for its depth `d`. */
+	struct cull_bounds {
+		Eigen_vec2 image_min;
+		Eigen_vec2 image_max;
+		real depth_min;
+		real depth_max;
+	};
+	
 private:
 	using intrinsic_matrix_result = std::pair<projection_view_frustum, Eigen_projective3>;
 
@@ -45,6 +55,14 @@ private:
 	Eigen_projective3 world_to_image_; ///< Full transformation from world to image. Pose, projection, scale, offset.
 	Eigen_projective3 image_to_world_; ///< Inverse of `world_to_image_`.
 	
+	std::size_t project_batch_(
+		const ndarray_view<1, const point_xyz>&,
+		const ndarray_view<1, image_coordinates_type>&,
+		const ndarray_view<1, real>&,
+		const cull_bounds*,
+		const ndarray_view<1, byte>&
+	) const;
+
 	static intrinsic_matrix_result read_intrinsic_matrix_
 		(const Eigen_mat3& intrinsic_matrix, const depth_projection_parameters&, const ndsize<2>&);
 
@@ -82,6 +100,30 @@ public:
 		return (image_to_world_ * p.homogeneous()).eval().hnormalized();
 	}
 	
+	/// Project points using `world_to_image_transformation()`, without virtual call per point.
+	/** Image coordinates and depth come from the same product per point. \a depth_out may be null view. */
+	void project_batch(
+		const ndarray_view<1, const point_xyz>& pts,
+		const ndarray_view<1, image_coordinates_type>& coords_out,
+		const ndarray_view<1, real>& depth_out
+	) const override;
+	
+	void project_batch
+	(const ndarray_view<1, const point_xyz>& pts, const ndarray_view<1, image_coordinates_type>& coords_out) const override {
+		project_batch(pts, coords_out, ndarray_view<1, real>());
+	}
+	
+	/// Project points, and cull points outside \a bounds in the same pass.
+	/** Null and culled points get NaN coordinates and depth, and value `0` in \a mask_out. Retained points get
+	 ** value `0xff`. Returns number of retained points. \a depth_out may be null view. */
+	std::size_t project_batch(
+		const ndarray_view<1, const point_xyz>& pts,
+		const ndarray_view<1, image_coordinates_type>& coords_out,
+		const ndarray_view<1, real>& depth_out,
+		const cull_bounds& bounds,
+		const ndarray_view<1, byte>& mask_out
+	) const;
+	
 	Eigen_mat3 intrinsic_matrix() const;
 	const Eigen_mat4& intrinsic_matrix_with_depth() const { return view_to_image_.matrix(); }
 	
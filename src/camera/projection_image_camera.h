@@ -38,6 +38,22 @@ public:
 	projection_image_camera(const projection_image_camera&) = default;
 	
 	projection_image_camera& operator=(const projection_image_camera&) = default;
+	
+	using projection_camera::project_batch;
+	
+	/// Bounds of image coordinates that map to pixels in image span, and of depths that map to pixel depth values.
+	cull_bounds image_cull_bounds() const;
+	
+	/// Project points, and cull points that fall outside the image or outside the pixel depth range.
+	/** See `projection_camera::project_batch()` with \ref cull_bounds. */
+	std::size_t project_batch(
+		const ndarray_view<1, const point_xyz>& pts,
+		const ndarray_view<1, image_coordinates_type>& coords_out,
+		const ndarray_view<1, real>& depth_out,
+		const ndarray_view<1, byte>& mask_out
+	) const {
+		return projection_camera::project_batch(pts, coords_out, depth_out, image_cull_bounds(), mask_out);
+	}
 };
 
 }
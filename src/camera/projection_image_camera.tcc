@@ -37,4 +37,19 @@ projection_image_camera<Depth>::projection_image_camera
 	depth_image_camera<Depth>(sz, dproj.depth_min(), dproj.depth_max() - dproj.depth_min()) { }
 
 
+template<typename Depth>
+auto projection_image_camera<Depth>::image_cull_bounds() const -> cull_bounds {
+	// to_pixel() maps image coordinates in [0.5, size + 0.5[ to pixels in image span.
+	// image_size() is in pixel coordinates order, which is flipped relative to image coordinates if flipped.
+	ndsize<2> sz = this->image_size();
+	if(this->pixel_coordinates_flipped()) sz = flip(sz);
+	cull_bounds bounds;
+	bounds.image_min = Eigen_vec2(0.5, 0.5);
+	bounds.image_max = Eigen_vec2(sz[0] + 0.5, sz[1] + 0.5);
+	bounds.depth_min = this->to_depth(std::numeric_limits<Depth>::min());
+	bounds.depth_max = this->to_depth(std::numeric_limits<Depth>::max());
+	return bounds;
+}
+
+
 }
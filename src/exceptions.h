@@ -55,6 +55,7 @@ MF_DEFINE_EXCEPTION_(invalid_node_graph, std::logic_error);
 MF_DEFINE_EXCEPTION_(failed_assertion, std::runtime_error);
 
 MF_DEFINE_EXCEPTION_(sequencing_error, std::runtime_error);
+MF_DEFINE_EXCEPTION_(memory_budget_exceeded, std::runtime_error);
 MF_DEFINE_EXCEPTION_(ply_importer_error, std::runtime_error);
 
 }
@@ -0,0 +1,83 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_DEPTH_WARP_FILTER_H_
+#define MF_DEPTH_WARP_FILTER_H_
+
+#include "filter.h"
+#include "../image/depth_warp.h"
+#include "../camera/projection_image_camera.h"
+
+namespace mf { namespace flow {
+
+/// Depth-image-based rendering filter, warps image with depth from source camera into target camera.
+/** Outputs the warped image, its mask with holes set to `0`, and the warped depth. See \ref forward_warp().
+ ** The cameras are parameters, so they can vary with time. Output frame shape is the image size of the target camera
+ ** at time 0. */
+template<typename Pixel, typename Depth>
+class depth_warp_filter : public filter {
+public:
+	using camera_type = projection_image_camera<Depth>;
+
+	input_type<2, Pixel> image_input;
+	input_type<2, Depth> depth_input;
+	output_type<2, Pixel> image_output;
+	output_type<2, byte> mask_output;
+	output_type<2, Depth> depth_output;
+	
+	parameter_type<camera_type> source_camera;
+	parameter_type<camera_type> target_camera;
+	
+	Depth null_depth = 0;
+	
+	depth_warp_filter() :
+		image_input(*this),
+		depth_input(*this),
+		image_output(*this),
+		mask_output(*this),
+		depth_output(*this) { }
+	
+	void setup() override {
+		ndsize<2> shape = target_camera.get(0).image_size();
+		image_output.define_frame_shape(shape);
+		mask_output.define_frame_shape(shape);
+		depth_output.define_frame_shape(shape);
+	}
+	
+	void process(job_type& job) override {
+		auto out_image = job.out(image_output);
+		auto out_mask = job.out(mask_output);
+		auto out_depth = job.out(depth_output);
+		forward_warp(
+			ndarray_view<2, const Depth>(job.in(depth_input)),
+			ndarray_view<2, const Pixel>(job.in(image_input)),
+			job.param(source_camera),
+			job.param(target_camera),
+			out_image,
+			out_mask,
+			out_depth,
+			null_depth
+		);
+	}
+};
+
+}}
+
+#endif
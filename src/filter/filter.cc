@@ -88,6 +88,42 @@ time_unit filter::prefetch_duration() const {
 	return prefetch_duration_;
 }
 
+
+void filter::set_adaptive_prefetch(time_unit maximal_duration) {
+	Assert(! was_installed());
+	Assert(maximal_duration >= 0, "maximal prefetch duration must be positive");
+	maximal_prefetch_duration_ = maximal_duration;
+}
+
+
+bool filter::has_adaptive_prefetch() const {
+	return (maximal_prefetch_duration_ != -1);
+}
+
+
+void filter::set_batch_duration(time_unit dur) {
+	Assert(! was_installed());
+	Assert(dur >= 1, "batch duration must be at least 1");
+	batch_duration_ = dur;
+}
+
+
+time_unit filter::batch_duration() const {
+	return batch_duration_;
+}
+
+
+void filter::set_ring_allocator(const raw_ring_allocator& alloc) {
+	Assert(! was_installed());
+	ring_allocator_ = alloc;
+}
+
+
+const raw_ring_allocator& filter::ring_allocator() const {
+	return ring_allocator_;
+}
+
+
 bool filter::need_multiplex_node_() const {
 	// multiplex node is needed if there are multiple output edges
 	bool one_output_edge = false;
@@ -106,6 +142,9 @@ void filter::install(graph& gr) {
 	if(asynchronous_) {
 		async_node& nd = gr.add_node<async_node>();
 		nd.set_prefetch_duration(prefetch_duration_);
+		if(has_adaptive_prefetch()) nd.set_adaptive_prefetch(maximal_prefetch_duration_);
+		nd.set_batch_duration(batch_duration_);
+		nd.set_ring_allocator(ring_allocator_);
 		node_ = &nd;
 	} else {
 		sync_node& nd = gr.add_node<sync_node>();
@@ -133,6 +172,8 @@ void sink_filter::install(graph& gr) {
 	Assert(outputs_.size() == 0, "sink filter must have no outputs");
 	Assert(! is_asynchonous(), "sink filter cannot be asynchonous");
 	Assert(prefetch_duration() == 0, "sink filter cannot have prefetch");
+	Assert(! has_adaptive_prefetch(), "sink filter cannot have prefetch");
+	Assert(batch_duration() == 1, "sink filter cannot process batches");
 	
 	sink_node& nd = gr.add_sink<sink_node>();
 	node_ = &nd;
@@ -167,6 +208,9 @@ void source_filter::install(graph& gr) {
 	if(asynchronous_) {
 		async_node& nd = gr.add_node<async_node>();
 		nd.set_prefetch_duration(prefetch_duration_);
+		if(has_adaptive_prefetch()) nd.set_adaptive_prefetch(maximal_prefetch_duration_);
+		nd.set_batch_duration(batch_duration_);
+		nd.set_ring_allocator(ring_allocator_);
 		node_ = &nd;
 	} else {
 		sync_node& nd = gr.add_node<sync_node>();
@@ -25,6 +25,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include "../flow/processing_node.h"
 #include "../flow/processing_node_job.h"
 #include "../queue/frame.h"
+#include "../os/memory.h"
 #include "filter_edge.h"
 #include "filter_parameter.h"
 #include "filter_job.h"
@@ -62,6 +63,9 @@ protected:
 
 	bool asynchronous_ = false;
 	time_unit prefetch_duration_ = 0;
+	time_unit maximal_prefetch_duration_ = -1;
+	time_unit batch_duration_ = 1;
+	raw_ring_allocator ring_allocator_;
 	
 	processing_node* node_ = nullptr;
 	multiplex_node* multiplex_node_ = nullptr;
@@ -84,6 +88,12 @@ public:
 	bool is_asynchonous() const;
 	void set_prefetch_duration(time_unit);
 	time_unit prefetch_duration() const;
+	void set_adaptive_prefetch(time_unit maximal_duration);
+	bool has_adaptive_prefetch() const;
+	void set_batch_duration(time_unit);
+	time_unit batch_duration() const;
+	void set_ring_allocator(const raw_ring_allocator&);
+	const raw_ring_allocator& ring_allocator() const;
 	
 	bool was_installed() const { return (node_ != nullptr); }
 	virtual void install(graph&);
@@ -140,7 +150,10 @@ public:
 
 
 /// Output port of filter.
-/** Has statically defined output frame dimension and element type. */
+/** Has statically defined output frame dimension and element type.
+ ** The frames can be *planar*: then they consist of multiple planes with different shapes, for example Y, Cb, Cr
+ ** planes with subsampled chroma. The planes are stored as consecutive parts of the output frame format, and are
+ ** accessed using \ref filter_job::out_plane(). frame_shape() is the shape of the first plane. */
 template<std::size_t Output_dim, typename Output_elem>
 class filter_output : public filter_output_base {
 public:
@@ -158,6 +171,7 @@ private:
 	processing_node_output_channel* node_output_channel_ = nullptr;
 	
 	frame_shape_type frame_shape_;	
+	std::vector<frame_shape_type> plane_shapes_;
 
 public:
 	explicit filter_output(filter&);
@@ -173,6 +187,7 @@ public:
 	const processing_node_output_channel& this_node_output_channel() const
 		{ Expects(node_output_channel_ != nullptr); return *node_output_channel_; }
 	std::ptrdiff_t index() const { return this_node_output_channel().index(); }
+	std::ptrdiff_t part_index(std::ptrdiff_t plane = 0) const;
 	
 	std::size_t edges_count() const override { return edges_.size(); }
 	const filter& connected_filter_at_edge(std::ptrdiff_t index) const override
@@ -187,7 +202,12 @@ public:
 	const frame_shape_type& frame_shape() const;
 	bool frame_shape_is_defined() const override;
 	
-	view_type get_output_view(const frame_view& generic_view);
+	/// Define planar frame shape, with the shapes of each plane.
+	void define_planar_frame_shape(const std::vector<frame_shape_type>& plane_shapes);
+	std::size_t planes_count() const;
+	const frame_shape_type& plane_shape(std::ptrdiff_t plane) const;
+	
+	view_type get_output_view(const frame_view& generic_view, std::ptrdiff_t plane = 0);
 };
 
 
@@ -238,6 +258,8 @@ public:
 	void connect(filter_output<Output_dim, Output_elem>&, Convert_function&&);
 	
 	const frame_shape_type& frame_shape() const;
+	std::size_t planes_count() const;
+	const frame_shape_type& plane_shape(std::ptrdiff_t plane) const;
 	
 	bool was_installed() const { return (node_input_ != nullptr); }
 	void install(processing_node&) override;
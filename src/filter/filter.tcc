@@ -66,10 +66,19 @@ void filter_output<Output_dim, Output_elem>::install(processing_node& nd, multip
 }
 
 
+template<std::size_t Output_dim, typename Output_elem>
+std::ptrdiff_t filter_output<Output_dim, Output_elem>::part_index(std::ptrdiff_t plane) const {
+	Expects(plane >= 0 && plane < planes_count());
+	const processing_node& nd = this_node_output_channel().this_node();
+	return nd.output().channel_first_part_index(index()) + plane;
+}
+
+
 template<std::size_t Output_dim, typename Output_elem>
 void filter_output<Output_dim, Output_elem>::define_frame_shape(const frame_shape_type& shp) {
 	Assert(node_output_channel_ != nullptr);
 	frame_shape_ = shp;
+	plane_shapes_.assign(1, shp);
 		
 	std::size_t elem_count = frame_shape_.product();
 	ndarray_format frame_format = make_ndarray_format<Output_elem>(elem_count);
@@ -77,6 +86,32 @@ void filter_output<Output_dim, Output_elem>::define_frame_shape(const frame_shap
 }
 
 
+template<std::size_t Output_dim, typename Output_elem>
+void filter_output<Output_dim, Output_elem>::define_planar_frame_shape(const std::vector<frame_shape_type>& plane_shapes) {
+	Assert(node_output_channel_ != nullptr);
+	Expects(plane_shapes.size() > 0);
+	frame_shape_ = plane_shapes.front();
+	plane_shapes_ = plane_shapes;
+	
+	ndarray_opaque_frame_format frame_format;
+	for(const frame_shape_type& plane_shape : plane_shapes_)
+		frame_format.add_part(make_ndarray_format<Output_elem>(plane_shape.product()));
+	node_output_channel_->define_frame_format(frame_format);
+}
+
+
+template<std::size_t Output_dim, typename Output_elem>
+std::size_t filter_output<Output_dim, Output_elem>::planes_count() const {
+	return plane_shapes_.size();
+}
+
+
+template<std::size_t Output_dim, typename Output_elem>
+auto filter_output<Output_dim, Output_elem>::plane_shape(std::ptrdiff_t plane) const -> const frame_shape_type& {
+	return plane_shapes_.at(plane);
+}
+
+
 template<std::size_t Output_dim, typename Output_elem>
 auto filter_output<Output_dim, Output_elem>::frame_shape() const -> const frame_shape_type& {
 	Assert(node_output_channel_ != nullptr);
@@ -93,9 +128,8 @@ bool filter_output<Output_dim, Output_elem>::frame_shape_is_defined() const {
 
 template<std::size_t Output_dim, typename Output_elem>
 auto filter_output<Output_dim, Output_elem>::get_output_view
-(const frame_view& generic_view) -> view_type {
-	std::ptrdiff_t channel_index = index();
-	return from_opaque<Output_dim, Output_elem>(extract_part(generic_view, channel_index), frame_shape());
+(const frame_view& generic_view, std::ptrdiff_t plane) -> view_type {
+	return from_opaque<Output_dim, Output_elem>(extract_part(generic_view, part_index(plane)), plane_shape(plane));
 }
 
 
@@ -128,6 +162,18 @@ auto filter_input<Input_dim, Input_elem>::frame_shape() const -> const frame_sha
 	return edge_->input_frame_shape();
 }
 
+
+template<std::size_t Input_dim, typename Input_elem>
+std::size_t filter_input<Input_dim, Input_elem>::planes_count() const {
+	return edge_->input_planes_count();
+}
+
+
+template<std::size_t Input_dim, typename Input_elem>
+auto filter_input<Input_dim, Input_elem>::plane_shape(std::ptrdiff_t plane) const -> const frame_shape_type& {
+	return edge_->input_plane_shape(plane);
+}
+
 	
 template<std::size_t Input_dim, typename Input_elem>
 void filter_input<Input_dim, Input_elem>::set_activated(bool act) {
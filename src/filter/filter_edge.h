@@ -45,6 +45,8 @@ public:
 	virtual const filter& origin_filter() const = 0;
 	virtual void set_node_input(node_input&) = 0;
 	virtual const input_frame_shape_type& input_frame_shape() const = 0;
+	virtual std::size_t input_planes_count() const = 0;
+	virtual const input_frame_shape_type& input_plane_shape(std::ptrdiff_t plane) const = 0;
 		
 	virtual input_full_view_type cast_connected_node_output_view(const timed_frame_array_view&) const = 0;
 };
@@ -120,7 +122,11 @@ public:
 		{ Assert(node_output_ != nullptr); return node_output_channel_index_; }
 
 	const input_frame_shape_type& input_frame_shape() const override { return output_.frame_shape(); }
+	std::size_t input_planes_count() const override { return output_.planes_count(); }
+	const input_frame_shape_type& input_plane_shape(std::ptrdiff_t plane) const override
+		{ return output_.plane_shape(plane); }
 	const output_frame_shape_type& output_frame_shape() const { return output_.frame_shape(); }
+	std::size_t output_planes_count() const { return output_.planes_count(); }
 };
 
 
@@ -53,8 +53,9 @@ auto filter_edge<Dim, Output_elem, Casted_elem, Input_elem>::output_view_to_cast
 (const timed_frame_array_view& opaque_output_view) const -> casted_full_view_type {
 	if(opaque_output_view.is_null()) return casted_full_view_type::null();
 
+	std::ptrdiff_t part_index = this_node_output().channel_first_part_index(node_output_channel_index());
 	auto concrete_output_view = from_opaque<Dim + 1, Output_elem>(
-		extract_part(opaque_output_view, node_output_channel_index()),
+		extract_part(opaque_output_view, part_index),
 		output_frame_shape()
 	);
 	return ndarray_view_cast<casted_full_view_type>(concrete_output_view);
@@ -106,6 +107,7 @@ void filter_converting_edge<Dim, Output_elem, Casted_elem, Input_elem, Convert_f
 handler_setup(processing_node& nd) {
 	node_input& convert_node_input = *convert_node_->inputs().front();
 	node_output& convert_node_output = convert_node_->output();
+	Assert(base::output_planes_count() == 1, "converting edge does not support planar frames");
 		
 	std::size_t elem_count = base::output_frame_shape().product();
 	ndarray_format frame_format = make_ndarray_format<Input_elem>(elem_count);
@@ -125,8 +127,9 @@ handler_process(processing_node& nd, processing_node_job& job) {
 	auto in = job.input_view(0)[0];
 	const auto& out = job.output_view();
 	
+	std::ptrdiff_t part_index = base::this_node_output().channel_first_part_index(base::node_output_channel_index());
 	auto concrete_in = from_opaque<Dim, Casted_elem>(
-		extract_part(in, base::node_output_channel_index()),
+		extract_part(in, part_index),
 		base::input_frame_shape()
 	);
 	auto concrete_out = from_opaque<Dim, Input_elem>(out, base::input_frame_shape());
@@ -35,6 +35,7 @@ void filter_graph::setup() {
 	Expects(! was_setup());
 	node_graph_.reset(new graph);
 	for(auto&& filt : filters_) filt->install(*node_graph_);
+	node_graph_->set_memory_budget(memory_budget_);
 	node_graph_->setup();
 }
 
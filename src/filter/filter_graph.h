@@ -33,6 +33,7 @@ class filter_graph {
 public:
 	std::vector<std::unique_ptr<filter>> filters_;
 	std::unique_ptr<graph> node_graph_;
+	std::size_t memory_budget_ = 0;
 	
 public:
 	filter_graph() = default;
@@ -50,7 +51,15 @@ public:
 	}
 	
 	bool was_setup() const { return (node_graph_ != nullptr); }
+	
+	/// Maximal total size of ring buffers in bytes, or `0` for no limit. See \ref graph::set_memory_budget().
+	void set_memory_budget(std::size_t bytes) { Expects(! was_setup()); memory_budget_ = bytes; }
+	
 	void setup();
+	
+	/// Underlying node graph, available after setup.
+	graph& node_graph() { Expects(was_setup()); return *node_graph_; }
+	const graph& node_graph() const { Expects(was_setup()); return *node_graph_; }
 
 	time_unit current_time() const;
 	
@@ -38,6 +38,14 @@ public:
 	template<typename Input> decltype(auto) in_full(Input&);
 	template<typename Input> decltype(auto) in(Input&);
 	template<typename Output> decltype(auto) out(Output&);
+	
+	/// \name Planar frames
+	/// Access to individual planes of planar input or output. Plane 0 is also accessed by in_full(), in(), out().
+	///@{
+	template<typename Input> decltype(auto) in_full_plane(Input&, std::ptrdiff_t plane);
+	template<typename Input> decltype(auto) in_plane(Input&, std::ptrdiff_t plane);
+	template<typename Output> decltype(auto) out_plane(Output&, std::ptrdiff_t plane);
+	///@}
 	template<typename Param> decltype(auto) param(Param&);
 };
 
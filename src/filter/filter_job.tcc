@@ -21,38 +21,52 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 namespace mf { namespace flow {
 
 template<typename Input> decltype(auto) filter_job::in_full(Input& pt) {
+	return in_full_plane(pt, 0);
+}
+
+
+template<typename Input> decltype(auto) filter_job::in(Input& pt) {
+	return in_plane(pt, 0);
+}
+
+
+template<typename Output> decltype(auto) filter_job::out(Output& pt) {
+	return out_plane(pt, 0);
+}
+
+
+template<typename Input> decltype(auto) filter_job::in_full_plane(Input& pt, std::ptrdiff_t plane) {
 	constexpr std::size_t dimension = Input::dimension;
 	using elem_type = typename Input::elem_type;
 			
 	std::ptrdiff_t index = pt.index();
 	if(! node_job_.has_input_view(index))
 		return ndarray_timed_view<dimension + 1, elem_type>();
-			
+	
+	// input view has the parts of the one connected output channel
 	timed_frame_array_view gen_vw = node_job_.input_view(index);
 	return from_opaque<dimension + 1, elem_type>(
-		gen_vw,
-		pt.frame_shape()
+		extract_part(gen_vw, plane),
+		pt.plane_shape(plane)
 	);
 }
 
 
-template<typename Input> decltype(auto) filter_job::in(Input& pt) {
-	auto full_vw = in_full(pt);
+template<typename Input> decltype(auto) filter_job::in_plane(Input& pt, std::ptrdiff_t plane) {
+	auto full_vw = in_full_plane(pt, plane);
 	if(full_vw) return full_vw.at_time(node_job_.time());
 	return decltype(full_vw[0])();
 }
 
 
-template<typename Output> decltype(auto) filter_job::out(Output& pt) {
+template<typename Output> decltype(auto) filter_job::out_plane(Output& pt, std::ptrdiff_t plane) {
 	constexpr std::size_t dimension = Output::dimension;
 	using elem_type = typename Output::elem_type;
 	
-	std::ptrdiff_t index = pt.index();
-	
-	frame_view gen_vw = extract_part(node_job_.output_view(), index);
+	frame_view gen_vw = extract_part(node_job_.output_view(), pt.part_index(plane));
 	return from_opaque<dimension, elem_type>(
 		gen_vw,
-		pt.frame_shape()
+		pt.plane_shape(plane)
 	);
 }
 
@@ -32,7 +32,6 @@ async_node::async_node(graph& gr) :
 
 async_node::~async_node() {
 	Assert(! running_);
-	Assert(! thread_.joinable());
 }
 
 
@@ -43,21 +42,28 @@ thread_index async_node::processing_thread_index() const {
 
 void async_node::setup() {
 	handler_setup_();
-		
-	node& connected_node = output().connected_node();
-	time_unit required_capacity = 1 + maximal_offset_to(connected_node) - minimal_offset_to(connected_node);
+	Assert(stream_properties().is_seekable());
+}
+
+
+void async_node::allocate_buffers() {
+	// prefetch and batch durations may have been reduced by the memory plan since setup
+	if(has_adaptive_prefetch()) {
+		Expects(maximal_prefetch_duration_ >= prefetch_duration_);
+		prefetch_controller_.reset(new prefetch_controller(prefetch_duration_, maximal_prefetch_duration_));
+	}
 	
 	auto buffer_frame_format = output_frame_format_();
-	Assert(stream_properties().is_seekable());
-	ring_.reset(new shared_ring(buffer_frame_format, required_capacity, stream_properties().duration()));
+	ring_.reset(new shared_ring(buffer_frame_format, output_ring_capacity(), stream_properties().duration(), ring_allocator_));
 }
 
 void async_node::launch() {
 	Assert(! running_);
-	thread_ = std::move(std::thread(
-		std::bind(&async_node::thread_main_, this)
-	));
+	paused_ = false;
+	write_blocked_ = false;
+	task_finished_ = false;
 	running_ = true;
+	schedule_task_();
 }
 
 void async_node::pre_stop() {
@@ -66,12 +72,13 @@ void async_node::pre_stop() {
 	MF_DEBUG("ring_->break_reader()");
 	ring_->break_reader();
 	MF_RAND_SLEEP;
-	continuation_cv_.notify_one();
+	schedule_task_();
 }
 
 void async_node::stop() {
 	Expects(running_);
-	thread_.join();
+	std::unique_lock<std::mutex> lock(continuation_mutex_);
+	task_finished_cv_.wait(lock, [&] { return task_finished_; });
 	running_ = false;
 }
 
@@ -86,78 +93,133 @@ time_unit async_node::minimal_offset_to(const node& target_node) const {
 time_unit async_node::maximal_offset_to(const node& target_node) const {
 	if(&target_node == this) return 0;
 	const node_input& in = output().connected_input();
-	return in.this_node().minimal_offset_to(target_node) + in.future_window_duration() + prefetch_duration_;
+	return in.this_node().minimal_offset_to(target_node) + in.future_window_duration() + maximal_prefetch_duration()
+		+ batch_duration_ - 1;
+}
+
+
+time_unit async_node::maximal_prefetch_duration() const {
+	if(has_adaptive_prefetch()) return maximal_prefetch_duration_;
+	else return prefetch_duration_;
+}
+
+
+time_unit async_node::effective_prefetch_duration() const {
+	if(prefetch_controller_) return prefetch_controller_->duration();
+	else return prefetch_duration_;
+}
+
+
+time_unit async_node::effective_batch_duration_(time_unit write_start) const {
+	// batch gets truncated at end of stream
+	time_unit end_time = ring_->end_time();
+	if(end_time != -1) return std::max(std::min(batch_duration_, end_time - write_start), time_unit(1));
+	else return batch_duration_;
 }
 
 
-bool async_node::pause_() {
+bool async_node::may_continue_() const {
 	// pause as long as either:
-	// - next write time (determined by shared_ring, and reader may seek) is beyond time limit (set by reader)
+	// - next batch (starting at next write time, determined by shared_ring, and reader may seek)
+	//   crosses time limit (set by reader)
 	// - next write time is beyond end of stream (marked in shared_ring)
 	// - received temporary failure from input and reader has not made new request since
-	// not pause when graph stopped and return false instead then
-	// conditions are rechecked when continuation_cv_ is notified
+	// - ring buffer is full, because reader has not read the frames yet
+	time_unit next_write_time = ring_->write_start_time();
+	MF_DEBUG_EXPR(next_write_time, failed_request_id_.load(), current_request_id_.load(), time_limit_.load(), ring_->end_time(), this_graph().was_stopped());
+	if(failed_request_id_ != -1 && current_request_id_ == failed_request_id_) return false;
+	else if(next_write_time + effective_batch_duration_(next_write_time) > time_limit_) return false;
+	else if(ring_->end_time() != -1 && next_write_time >= ring_->end_time()) return false;
+	else if(ring_->writable_duration() == 0) return false;
+	else return true;
+}
+
+
+bool async_node::resume_() {
+	// called by paused task. returns false when task must end instead: it is then parked,
+	// and conditions are rechecked when it gets rescheduled
 	// = when reader pulls new frame (after setting request_id)
-	//   or when graph is stopped
+	//   or when reader ends reading frames
+	//   or when graph is stopped, then the task finishes
+	// task_scheduled_ is reset before the conditions are checked, so that either schedule_task_() resubmits the task,
+	// or the check here sees the new state
+	std::lock_guard<std::mutex> lock(continuation_mutex_);
+	task_scheduled_ = false;
+	bool stopped = this_graph().was_stopped();
+	if(! stopped && ! may_continue_()) return false;
+	else if(task_scheduled_.exchange(true)) return false; // other instance of task was submitted in the meantime
 	
-	auto may_continue = [&]()->bool {
-		time_unit next_write_time = ring_->write_start_time();
-		MF_DEBUG_EXPR(next_write_time, failed_request_id_, current_request_id_.load(), time_limit_.load(), ring_->end_time(), this_graph().was_stopped());
-		if(this_graph().was_stopped()) return true;
-		else if(failed_request_id_ != -1 && current_request_id_ == failed_request_id_) return false;
-		else if(next_write_time >= time_limit_) return false;
-		else if(ring_->end_time() != -1 && next_write_time >= ring_->end_time()) return false;
-		else return true;
-	};
-
-	MF_DEBUG("pause..locking");
-	std::unique_lock<std::mutex> lock(continuation_mutex_);
-	MF_DEBUG("pause..waiting");
-	continuation_cv_.wait(lock, may_continue);
-	return ! this_graph().was_stopped();
+	if(stopped) {
+		task_finished_ = true;
+		task_scheduled_ = false;
+		task_finished_cv_.notify_all();
+		return false;
+	} else {
+		return true;
+	}
 }
 
 
-void async_node::thread_main_() {
-	bool pause = false;
-	
-	if(inputs().size() == 1)
-		MF_DEBUG("thread (input: -", inputs().front()->past_window_duration(), ", +", inputs().front()->future_window_duration(), ")");
-	else
-		MF_DEBUG("thread (source)");
-		
-	for(;;) {
-		if(pause) {
-			MF_DEBUG("pause...");
-			bool cont = pause_();
-			if(! cont) break;
-			pause = false;
-		}
-		
-		MF_DEBUG("continuation...");
-		
-		request_id_type request_id = current_request_id_.load();	
-		process_result result = process_frame_();
-		if(result == process_result::failure) {
-			failed_request_id_ = request_id;
-			ring_->break_reader();
-			pause = true;
-		} else if(result == process_result::should_pause) {
-			pause = true;
+void async_node::schedule_task_() {
+	if(! task_scheduled_.exchange(true))
+		this_graph().task_executor().submit(std::bind(&async_node::task_main_, this), thread_index_);
+}
+
+
+void async_node::task_main_() {
+	// one run of the task processes one batch, and then resubmits the task
+	// so that tasks of other nodes on the same worker can run in between
+	if(paused_) {
+		MF_DEBUG("pause...");
+		bool cont = resume_();
+		if(! cont) return;
+		paused_ = false;
+		if(write_blocked_) {
+			metrics().record_write_blocked(node_metrics::clock_type::now() - write_blocked_clock_time_);
+			write_blocked_ = false;
 		}
 	}
-	MF_DEBUG("thread end.");
+	
+	MF_DEBUG("continuation...");
+	
+	request_id_type request_id = current_request_id_.load();	
+	process_result result = process_frames_();
+	if(result == process_result::failure) {
+		failed_request_id_ = request_id;
+		ring_->break_reader();
+		paused_ = true;
+	} else if(result == process_result::should_pause) {
+		paused_ = true;
+	}
+	
+	this_graph().task_executor().submit(std::bind(&async_node::task_main_, this), thread_index_);
 }
 
 
-async_node::process_result async_node::process_frame_() {
+async_node::process_result async_node::process_frames_() {
 	MF_RAND_SLEEP;
-	auto out_vw = ring_->try_begin_write(1);
-	if(out_vw.is_null()) { MF_DEBUG("process: out_vw=null  --> should_pause"); return process_result::should_pause; }
+	
+	// batch to reserve in ring buffer
+	// truncated so that it does not cross time limit, and fits into writable frames
+	time_unit write_start = ring_->write_start_time();
+	time_unit batch = effective_batch_duration_(write_start);
+	batch = std::min(batch, time_limit_ - write_start);
+	batch = std::min(batch, ring_->writable_duration());
+	batch = std::max(batch, time_unit(1));
+	
+	auto out_vw = ring_->try_begin_write(batch);
+	if(out_vw.is_null()) {
+		MF_DEBUG("process: out_vw=null  --> should_pause");
+		if(ring_->writable_duration() == 0) {
+			write_blocked_ = true;
+			write_blocked_clock_time_ = node_metrics::clock_type::now();
+		}
+		return process_result::should_pause;
+	}
 	if(out_vw.duration() == 0) { MF_DEBUG("process: out_vw=()  --> should_pause"); return process_result::should_pause; }
 
 	time_unit request_time = out_vw.start_time();
-	MF_DEBUG("process frame... request_time=", request_time, " limit=", time_limit_);
+	MF_DEBUG("process frames... request_time=", request_time, " batch=", out_vw.duration(), " limit=", time_limit_);
 
 	MF_RAND_SLEEP;
 	if(request_time >= time_limit_) {
@@ -166,12 +228,35 @@ async_node::process_result async_node::process_frame_() {
 		return process_result::failure;
 	}
 	
-	time_unit t = out_vw.start_time();
+	// process frames of batch, and commit them at once
+	// reader may lower time limit in the meantime (when it seeks): then batch ends early
+	auto start_clock_time = prefetch_controller::clock_type::now();
+	time_unit written_duration = 0;
+	process_result result = process_result::should_continue;
+	while(written_duration < out_vw.duration()) {
+		time_unit t = out_vw.start_time() + written_duration;
+		if(t >= time_limit_) break;
+		
+		result = process_frame_(out_vw[written_duration], t);
+		if(result == process_result::failure) break;
+		
+		++written_duration;
+		if(result == process_result::should_pause) break;
+	}
+	
+	ring_->end_write(written_duration);
+	if(prefetch_controller_)
+		prefetch_controller_->record_produced(written_duration, std::chrono::duration_cast<prefetch_controller::duration_type>(
+			prefetch_controller::clock_type::now() - start_clock_time));
+	return result;
+}
 
+
+async_node::process_result async_node::process_frame_(const frame_view& out_vw, time_unit t) {
 	set_current_time_(t);
 	processing_node_job job = begin_job_();
 
-	job.attach_output_view(out_vw[0]);
+	job.attach_output_view(out_vw);
 	MF_RAND_SLEEP;
 	
 	MF_RAND_SLEEP;
@@ -182,28 +267,26 @@ async_node::process_result async_node::process_frame_() {
 	
 	handler_pre_process_(job);
 			
-	for(std::ptrdiff_t i = 0; i < inputs_count(); ++i) {
+	for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(inputs_count()); ++i) {
 		input_type& in = input_at(i);
 		if(! in.is_activated()) continue;
 		
 		pull_result res = in.pull();
 		if(res == pull_result::stopped || res == pull_result::transitory_failure) {
 			job.detach_output_view();
-			ring_->end_write(0);
-			MF_DEBUG("process frame... t=", request_time, " in fail --> failure");
+			MF_DEBUG("process frame... t=", t, " in fail --> failure");
 			return process_result::failure;
 		}
 	}
 	
-	for(std::ptrdiff_t i = 0; i < inputs_count(); ++i) {
+	for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(inputs_count()); ++i) {
 		input_type& in = input_at(i);
 		if(! in.is_activated()) continue;
 
 		bool cont = job.begin_input(in);
 		if(! cont) {
 			job.detach_output_view();
-			ring_->end_write(0);
-			MF_DEBUG("process frame... t=", request_time, " in broke --> failure");
+			MF_DEBUG("process frame... t=", t, " in broke --> failure");
 			return process_result::failure;
 		}
 	}
@@ -216,12 +299,10 @@ async_node::process_result async_node::process_frame_() {
 	job.detach_output_view();
 	
 	if(reached_end()) {
-		ring_->end_write(1);
-		MF_DEBUG("process frame... t=", request_time, " --> should_pause");	
+		MF_DEBUG("process frame... t=", t, " --> should_pause");	
 		return process_result::should_pause;
 	} else {
-		ring_->end_write(1);
-		MF_DEBUG("process frame... t=", request_time, " --> should_continue");	
+		MF_DEBUG("process frame... t=", t, " --> should_continue");	
 		return process_result::should_continue;
 	}
 }
@@ -229,9 +310,11 @@ async_node::process_result async_node::process_frame_() {
 
 node::pull_result async_node::output_pull_(time_span& pull_span, bool reconnect) {
 	MF_DEBUG("output: pull ", pull_span);
+	if(prefetch_controller_) prefetch_controller_->record_request(prefetch_controller::clock_type::now());
 	{
 		std::lock_guard<std::mutex> lock(continuation_mutex_);
-		time_limit_.store(pull_span.end_time() + prefetch_duration_ + 1);
+		// writer may run ahead by the prefetch duration, and complete its batch
+		time_limit_.store(pull_span.end_time() + effective_prefetch_duration() + batch_duration_);
 		
 		// multi-channel: foreach. first: set next_write_time variable
 		// writer: pause if next_write_time != ring_.write_start_time for any ring
@@ -243,12 +326,15 @@ node::pull_result async_node::output_pull_(time_span& pull_span, bool reconnect)
 	}
 	
 	MF_RAND_SLEEP;
-	continuation_cv_.notify_one();
+	schedule_task_();
 	
 	if(! stream_properties().is_seekable()) {
 		throw std::logic_error("forward async currently unsupported");
 	}
 	
+	bool prefetch_hit = (ring_->readable_duration() >= pull_span.duration());
+	metrics().record_prefetch(prefetch_hit);
+	if(prefetch_controller_ && prefetch_hit) prefetch_controller_->record_hit();
 
 	while(ring_->readable_duration() < pull_span.duration()) {
 		MF_RAND_SLEEP;		
@@ -257,7 +343,17 @@ node::pull_result async_node::output_pull_(time_span& pull_span, bool reconnect)
 		if(this_graph().was_stopped()) return pull_result::stopped;
 		
 		MF_DEBUG("output: pull ", pull_span, " : wait_readable...");
-		ring_->wait_readable();
+		{
+			// writer sets failed_request_id_ before break_reader(), and graph sets was_stopped() before pre_stop()
+			auto stop = [&] { return this_graph().was_stopped() || (failed_request_id_ == current_request_id_); };
+			executor::blocking_scope blocking;
+			auto wait_start_clock_time = node_metrics::clock_type::now();
+			ring_->wait_readable(pull_span.duration(), stop);
+			auto blocked = node_metrics::clock_type::now() - wait_start_clock_time;
+			metrics().record_read_blocked(blocked);
+			if(prefetch_controller_)
+				prefetch_controller_->record_stall(std::chrono::duration_cast<prefetch_controller::duration_type>(blocked));
+		}
 		MF_RAND_SLEEP;
 		MF_DEBUG("output: pull ", pull_span, " : wait_readable. readable=", ring_->readable_duration());
 	
@@ -287,7 +383,11 @@ timed_frame_array_view async_node::output_begin_read_(time_unit duration)  {
 }
 
 void async_node::output_end_read_(time_unit duration) {
+	// task may be parked because ring buffer was full
+	// if not detected here, it gets rescheduled by the next pull
+	bool was_full = (ring_->writable_duration() == 0);
 	ring_->end_read(duration);
+	if(was_full) schedule_task_();
 }
 
 
@@ -23,13 +23,18 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #define MF_FLOW_ASYNC_NODE_H_
 
 #include "processing_node.h"
+#include "prefetch_controller.h"
 #include "../queue/shared_ring.h"
-#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace mf { namespace flow {
 
 class graph;
 
+/// Node which gets processed asynchronously, and writes its output frames into a \ref shared_ring.
+/** Processing runs as a task on the \ref executor of the graph. The task processes one batch per run and then
+ ** resubmits itself. When the node must pause, the task gets parked, and is resubmitted when the reader pulls. */
 class async_node final : public processing_node {	
 private:
 	enum class process_result { should_continue, should_pause, failure };
@@ -37,24 +42,36 @@ private:
 	using request_id_type = int;
 	
 	time_unit prefetch_duration_ = 0;
+	time_unit maximal_prefetch_duration_ = -1; ///< When not `-1`, prefetch duration is adaptive.
+	std::unique_ptr<prefetch_controller> prefetch_controller_;
+	time_unit batch_duration_ = 1;
+	raw_ring_allocator ring_allocator_;
 	
 	thread_index thread_index_ = undefined_thread_index;
-	std::thread thread_;
 	std::atomic<bool> running_ {false};
+	std::atomic<bool> task_scheduled_ {false};
+	bool task_finished_ = false;
+	std::condition_variable task_finished_cv_;
 
 	std::unique_ptr<shared_ring> ring_;
 	
 	std::mutex continuation_mutex_;
-	std::condition_variable continuation_cv_;
 	std::atomic<time_unit> time_limit_ {-1};
 	std::atomic<request_id_type> current_request_id_ {-1};
 	std::atomic<bool> reconnect_flag_ {false};
 	
-	request_id_type failed_request_id_ = -1;
+	std::atomic<request_id_type> failed_request_id_ {-1};
+	bool paused_ = false;
+	bool write_blocked_ = false; ///< Whether task paused because the ring buffer was full.
+	node_metrics::clock_type::time_point write_blocked_clock_time_;
 	
-	bool pause_();
-	process_result process_frame_();
-	void thread_main_();
+	bool may_continue_() const;
+	bool resume_();
+	time_unit effective_batch_duration_(time_unit write_start) const;
+	process_result process_frames_();
+	process_result process_frame_(const frame_view& out_vw, time_unit t);
+	void schedule_task_();
+	void task_main_();
 
 	pull_result output_pull_(time_span&, bool reconnected) override;
 	timed_frame_array_view output_begin_read_(time_unit duration) override;
@@ -69,7 +86,30 @@ public:
 	time_unit prefetch_duration() const { return prefetch_duration_; }
 	void set_prefetch_duration(time_unit dur) { prefetch_duration_ = dur; }
 	
+	/// Let prefetch duration adapt at runtime between prefetch_duration() and \a maximal_duration.
+	/** The ring buffer is allocated for the maximal prefetch duration, and only partially used. The current duration
+	 ** is controlled by a \ref prefetch_controller, based on measured producer and consumer rates. */
+	void set_adaptive_prefetch(time_unit maximal_duration) { maximal_prefetch_duration_ = maximal_duration; }
+	bool has_adaptive_prefetch() const { return (maximal_prefetch_duration_ != -1); }
+	time_unit maximal_prefetch_duration() const;
+	
+	/// Prefetch duration currently in effect.
+	time_unit effective_prefetch_duration() const;
+	
+	/// Number of frames that are reserved in the ring buffer, processed, and committed at once.
+	/** With larger batch, the synchronization with the reader is done once per batch instead of once per frame.
+	 ** The writer then also waits until the time limit allows for a whole batch to be written. */
+	time_unit batch_duration() const { return batch_duration_; }
+	void set_batch_duration(time_unit dur) { Expects(dur >= 1); batch_duration_ = dur; }
+	
+	/// Allocator used for the output ring buffer, allocated at setup.
+	/** Can request huge pages and NUMA node binding for the ring. Processing runs on the executor and has no fixed
+	 ** writer thread, so the NUMA node needs to be chosen by the caller, for example using \ref current_numa_node(). */
+	const raw_ring_allocator& ring_allocator() const { return ring_allocator_; }
+	void set_ring_allocator(const raw_ring_allocator& alloc) { ring_allocator_ = alloc; }
+	
 	void setup() override;
+	void allocate_buffers() override;
 	void launch() override;
 	void pre_stop() override;
 	void stop() override;
@@ -0,0 +1,169 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "chrome_trace.h"
+#include "../graph.h"
+#include "../processing_node.h"
+#include "../multiplex_node.h"
+#include <ostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <typeinfo>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace mf { namespace flow {
+
+namespace {
+	constexpr int process_id_ = 1;
+}
+
+
+chrome_trace::chrome_trace(processing_timeline& timeline, std::ostream& output) :
+	output_(output),
+	timeline_(timeline) { }
+
+
+std::string chrome_trace::escape_(const std::string& str) {
+	std::ostringstream escaped;
+	for(char c : str) {
+		if(c == '"' || c == '\\') escaped << '\\' << c;
+		else if(static_cast<unsigned char>(c) < 0x20)
+			escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+		else escaped << c;
+	}
+	return escaped.str();
+}
+
+
+const node& chrome_trace::producer_node_(const node& nd) {
+	// multiplex nodes do not process jobs, the frames come from the node connected to their input
+	if(typeid(nd) == typeid(multiplex_node)) return producer_node_(nd.input_at(0).connected_node());
+	else return nd;
+}
+
+
+double chrome_trace::timestamp_(processing_timeline::clock_time_type clock_time) const {
+	return std::chrono::duration<double, std::micro>(clock_time - origin_clock_time_).count();
+}
+
+
+void chrome_trace::begin_event_() {
+	if(! first_event_) output_ << ",\n";
+	first_event_ = false;
+}
+
+
+void chrome_trace::generate_threads_() {
+	begin_event_();
+	output_ << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << process_id_
+		<< ",\"args\":{\"name\":\"flow graph\"}}";
+	
+	std::set<thread_index> threads;
+	for(const job& jb : jobs_) threads.insert(jb.thread);
+	for(thread_index thread : threads) {
+		begin_event_();
+		output_ << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << process_id_ << ",\"tid\":" << thread
+			<< ",\"args\":{\"name\":\"thread " << thread << "\"}}";
+		begin_event_();
+		output_ << "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":" << process_id_ << ",\"tid\":" << thread
+			<< ",\"args\":{\"sort_index\":" << thread << "}}";
+	}
+}
+
+
+void chrome_trace::generate_jobs_() {
+	for(const job& jb : jobs_) {
+		begin_event_();
+		output_ << "{\"name\":\"" << escape_(jb.node->name()) << "\",\"cat\":\"job\",\"ph\":\"X\""
+			<< ",\"pid\":" << process_id_ << ",\"tid\":" << jb.thread
+			<< ",\"ts\":" << timestamp_(jb.start_clock_time)
+			<< ",\"dur\":" << timestamp_(jb.end_clock_time) - timestamp_(jb.start_clock_time)
+			<< ",\"args\":{\"frame\":" << jb.frame_time << "}}";
+	}
+}
+
+
+void chrome_trace::generate_flows_() {
+	// jobs_ is ordered by start time, so for each (node, frame) the indices are ordered too
+	std::map<std::pair<const node*, time_unit>, std::vector<std::size_t>> node_frame_jobs;
+	for(std::size_t i = 0; i < jobs_.size(); ++i)
+		node_frame_jobs[std::make_pair(jobs_[i].node, jobs_[i].frame_time)].push_back(i);
+	
+	std::ptrdiff_t flow_id = 0;
+	for(const job& consumer_job : jobs_) {
+		const processing_node& consumer = *consumer_job.node;
+		for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(consumer.inputs_count()); ++i) {
+			const node_input& in = consumer.input_at(i);
+			if(! in.is_connected()) continue;
+			
+			// newest frame pulled by the job, and latest job of producer which processed it before
+			const node& producer = producer_node_(in.connected_node());
+			time_unit pulled_frame_time = consumer_job.frame_time + in.future_window_duration();
+			auto it = node_frame_jobs.find(std::make_pair(&producer, pulled_frame_time));
+			if(it == node_frame_jobs.end()) continue;
+			const job* producer_job = nullptr;
+			for(std::size_t index : it->second) {
+				if(jobs_[index].start_clock_time > consumer_job.start_clock_time) break;
+				producer_job = &jobs_[index];
+			}
+			if(producer_job == nullptr) continue;
+			
+			++flow_id;
+			begin_event_();
+			output_ << "{\"name\":\"pull\",\"cat\":\"pull\",\"ph\":\"s\",\"id\":" << flow_id
+				<< ",\"pid\":" << process_id_ << ",\"tid\":" << producer_job->thread
+				<< ",\"ts\":" << timestamp_(producer_job->start_clock_time) << "}";
+			begin_event_();
+			output_ << "{\"name\":\"pull\",\"cat\":\"pull\",\"ph\":\"f\",\"bp\":\"e\",\"id\":" << flow_id
+				<< ",\"pid\":" << process_id_ << ",\"tid\":" << consumer_job.thread
+				<< ",\"ts\":" << timestamp_(consumer_job.start_clock_time) << "}";
+		}
+	}
+}
+
+
+void chrome_trace::generate() {
+	jobs_ = timeline_.jobs();
+	if(! jobs_.empty()) origin_clock_time_ = jobs_.front().start_clock_time;
+	first_event_ = true;
+	
+	std::ios_base::fmtflags flags = output_.flags();
+	output_ << std::fixed << std::setprecision(3);
+	
+	output_ << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	generate_threads_();
+	generate_jobs_();
+	generate_flows_();
+	output_ << "\n]}\n";
+	
+	output_.flags(flags);
+}
+
+
+void export_chrome_trace(processing_timeline& timeline, const std::string& filename) {
+	std::ofstream fstr(filename);
+	chrome_trace trace(timeline, fstr);
+	trace.generate();
+}
+
+}}
@@ -0,0 +1,67 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_FLOW_CHROME_TRACE_H_
+#define MF_FLOW_CHROME_TRACE_H_
+
+#include "processing_timeline.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace mf { namespace flow {
+
+class node;
+
+/// Writes jobs recorded by \ref processing_timeline in the Chrome Trace Event JSON format.
+/** The output can be opened in `chrome://tracing` or in Perfetto. There is one track per processing thread index,
+ ** with one span per job labelled with the node name and frame time. Flow arrows go from the job of a predecessor
+ ** node which produced the newest frame pulled by a job, to that job. */
+class chrome_trace {
+private:
+	using job = processing_timeline::job;
+
+	std::ostream& output_;
+	processing_timeline& timeline_;
+	std::vector<job> jobs_;
+	processing_timeline::clock_time_type origin_clock_time_;
+	bool first_event_ = true;
+
+	static std::string escape_(const std::string&);
+	static const node& producer_node_(const node&);
+	
+	double timestamp_(processing_timeline::clock_time_type) const;
+	void begin_event_();
+	void generate_threads_();
+	void generate_jobs_();
+	void generate_flows_();
+
+public:
+	chrome_trace(processing_timeline&, std::ostream&);
+	
+	void generate();
+};
+
+
+void export_chrome_trace(processing_timeline&, const std::string& filename);
+
+}}
+
+#endif
@@ -0,0 +1,166 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "node_metrics.h"
+#include "../graph.h"
+#include "../node.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mf { namespace flow {
+
+constexpr unsigned latency_histogram::sub_buckets_bits;
+constexpr std::size_t latency_histogram::sub_buckets_count;
+constexpr std::size_t latency_histogram::buckets_count;
+constexpr std::size_t sharded_counter::shards_count;
+
+
+std::size_t latency_histogram::bucket_index(std::uint64_t value) {
+	// values below sub_buckets_count have their own buckets. others are in bucket of their most significant bit,
+	// and in sub-bucket given by the following sub_buckets_bits bits
+	if(value < sub_buckets_count) return value;
+	// index of most significant bit, by binary search
+	unsigned msb = 0;
+	for(unsigned shift = 32; shift > 0; shift /= 2)
+		if((value >> (msb + shift)) != 0) msb += shift;
+	std::size_t bucket = msb - sub_buckets_bits + 1;
+	std::size_t sub_bucket = (value >> (msb - sub_buckets_bits)) - sub_buckets_count;
+	return bucket * sub_buckets_count + sub_bucket;
+}
+
+
+std::uint64_t latency_histogram::bucket_lower_bound(std::size_t index) {
+	Expects(index < buckets_count);
+	if(index < sub_buckets_count) return index;
+	std::size_t bucket = index / sub_buckets_count;
+	std::size_t sub_bucket = index % sub_buckets_count;
+	return std::uint64_t(sub_buckets_count + sub_bucket) << (bucket - 1);
+}
+
+
+void latency_histogram::record(duration_type d) {
+	std::uint64_t value = (d.count() > 0 ? d.count() : 0);
+	counts_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+	sum_.fetch_add(value, std::memory_order_relaxed);
+	std::uint64_t old_max = max_.load(std::memory_order_relaxed);
+	while(value > old_max && ! max_.compare_exchange_weak(old_max, value, std::memory_order_relaxed)) { }
+}
+
+
+void latency_histogram::reset() {
+	for(auto& count : counts_) count.store(0, std::memory_order_relaxed);
+	sum_.store(0, std::memory_order_relaxed);
+	max_.store(0, std::memory_order_relaxed);
+}
+
+
+latency_histogram::snapshot::snapshot(const latency_histogram& hist) :
+	counts_(buckets_count)
+{
+	for(std::size_t i = 0; i < buckets_count; ++i) {
+		counts_[i] = hist.counts_[i].load(std::memory_order_relaxed);
+		count_ += counts_[i];
+	}
+	sum_ = hist.sum_.load(std::memory_order_relaxed);
+	max_ = hist.max_.load(std::memory_order_relaxed);
+}
+
+
+auto latency_histogram::snapshot::mean() const -> duration_type {
+	if(count_ == 0) return duration_type::zero();
+	else return duration_type(sum_ / count_);
+}
+
+
+auto latency_histogram::snapshot::percentile(real p) const -> duration_type {
+	Expects(p >= 0.0 && p <= 1.0);
+	if(count_ == 0) return duration_type::zero();
+	
+	std::uint64_t rank = std::max<std::uint64_t>(std::ceil(p * count_), 1);
+	std::uint64_t cumulative_count = 0;
+	for(std::size_t i = 0; i < counts_.size(); ++i) {
+		cumulative_count += counts_[i];
+		if(cumulative_count >= rank) return duration_type(std::min(bucket_lower_bound(i), max_));
+	}
+	return duration_type(max_);
+}
+
+
+///////////////
+
+
+std::size_t sharded_counter::this_thread_shard_() {
+	// threads get consecutive shards in order of their first use of any sharded counter
+	static std::atomic<std::size_t> next_shard{0};
+	thread_local std::size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % shards_count;
+	return shard;
+}
+
+
+std::uint64_t sharded_counter::load() const {
+	std::uint64_t sum = 0;
+	for(const shard& sh : shards_) sum += sh.value.load(std::memory_order_relaxed);
+	return sum;
+}
+
+
+void sharded_counter::reset() {
+	for(shard& sh : shards_) sh.value.store(0, std::memory_order_relaxed);
+}
+
+
+///////////////
+
+
+void node_metrics::reset() {
+	processing_latency_.reset();
+	for(auto* counter : { &frames_, &write_blocked_ns_, &pull_failures_ })
+		counter->store(0, std::memory_order_relaxed);
+	for(auto* counter : { &read_blocked_ns_, &prefetch_hits_, &prefetch_misses_ })
+		counter->reset();
+}
+
+
+///////////////
+
+
+node_metrics_snapshot::node_metrics_snapshot(const node& nd, std::chrono::duration<real> running_time) :
+	this_node(&nd),
+	node_name(nd.name()),
+	processing_latency(nd.metrics().processing_latency())
+{
+	const node_metrics& metrics = nd.metrics();
+	frames = metrics.frames();
+	if(running_time.count() > 0.0) frames_per_second = frames / running_time.count();
+	read_blocked_time = metrics.read_blocked_time();
+	write_blocked_time = metrics.write_blocked_time();
+	pull_failures = metrics.pull_failures();
+	prefetch_hits = metrics.prefetch_hits();
+	prefetch_misses = metrics.prefetch_misses();
+}
+
+
+real node_metrics_snapshot::prefetch_hit_rate() const {
+	std::uint64_t requests = prefetch_hits + prefetch_misses;
+	if(requests == 0) return 0.0;
+	else return real(prefetch_hits) / requests;
+}
+
+}}
@@ -0,0 +1,190 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_FLOW_NODE_METRICS_H_
+#define MF_FLOW_NODE_METRICS_H_
+
+#include "../../common.h"
+#include <chrono>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace mf { namespace flow {
+
+class node;
+
+/// Histogram of durations with logarithmic buckets, each subdivided into linear sub-buckets.
+/** Like a HDR histogram, the relative error of a recorded value is bounded (by `1 / sub_buckets_count`), for values
+ ** ranging from nanoseconds to hours, using constant memory. Recording is lock-free and wait-free. */
+class latency_histogram {
+public:
+	using clock_type = std::chrono::steady_clock;
+	using duration_type = std::chrono::nanoseconds;
+
+	static constexpr unsigned sub_buckets_bits = 3;
+	static constexpr std::size_t sub_buckets_count = std::size_t(1) << sub_buckets_bits;
+	static constexpr std::size_t buckets_count = (64 - sub_buckets_bits + 1) * sub_buckets_count;
+
+	/// Copy of histogram counts, on which statistics are computed.
+	class snapshot {
+	private:
+		std::vector<std::uint64_t> counts_;
+		std::uint64_t count_ = 0;
+		std::uint64_t sum_ = 0;
+		std::uint64_t max_ = 0;
+	
+	public:
+		snapshot() = default;
+		explicit snapshot(const latency_histogram&);
+		
+		std::uint64_t count() const { return count_; }
+		duration_type mean() const;
+		duration_type max() const { return duration_type(max_); }
+		
+		/// Duration below which fraction \a p of recorded durations lie, with \a p in `[0, 1]`.
+		/** Returns the lower bound of the bucket, so that result underestimates by at most the bucket width. */
+		duration_type percentile(real p) const;
+	};
+	
+private:
+	std::array<std::atomic<std::uint64_t>, buckets_count> counts_;
+	std::atomic<std::uint64_t> sum_;
+	std::atomic<std::uint64_t> max_;
+
+public:
+	latency_histogram() { reset(); }
+	latency_histogram(const latency_histogram&) = delete;
+	latency_histogram& operator=(const latency_histogram&) = delete;
+
+	static std::size_t bucket_index(std::uint64_t value);
+	static std::uint64_t bucket_lower_bound(std::size_t index);
+
+	void record(duration_type);
+	void reset();
+};
+
+
+/// Counter incremented concurrently by several threads, split into shards so that the threads do not contend.
+/** Each thread adds to the shard selected by its thread-local shard index. Reading sums all shards. */
+class sharded_counter {
+public:
+	static constexpr std::size_t shards_count = 8;
+
+private:
+	/// Counter padded to the size of a cache line, so that shards are not on the same cache line.
+	struct shard {
+		std::atomic<std::uint64_t> value{0};
+		char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+	};
+	
+	std::array<shard, shards_count> shards_;
+	
+	static std::size_t this_thread_shard_();
+
+public:
+	void add(std::uint64_t value) { shards_[this_thread_shard_()].value.fetch_add(value, std::memory_order_relaxed); }
+	std::uint64_t load() const;
+	void reset();
+};
+
+
+/// Low-overhead counters of a node, recorded continuously while the graph is running.
+/** All counters are relaxed atomics, so recording never takes a lock, and a snapshot can be taken at any time from
+ ** another thread. Counters that are written by the node's own thread are plain atomics. Counters written by the
+ ** readers of the node, which may run on several threads, are \ref sharded_counter objects. Values in the snapshot
+ ** are not mutually synchronized. */
+class node_metrics {
+public:
+	using clock_type = latency_histogram::clock_type;
+	using duration_type = latency_histogram::duration_type;
+	
+private:
+	latency_histogram processing_latency_;
+	std::atomic<std::uint64_t> frames_{0};
+	sharded_counter read_blocked_ns_;
+	std::atomic<std::uint64_t> write_blocked_ns_{0};
+	std::atomic<std::uint64_t> pull_failures_{0};
+	sharded_counter prefetch_hits_;
+	sharded_counter prefetch_misses_;
+	
+	static void add_(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+		counter.fetch_add(value, std::memory_order_relaxed);
+	}
+	static std::uint64_t ns_(duration_type d) { return (d.count() > 0 ? d.count() : 0); }
+	
+public:
+	/// Record processing of one frame, which took duration \a d.
+	void record_frame(duration_type d) { processing_latency_.record(d); add_(frames_, 1); }
+	
+	/// Record that a reader was blocked during \a d, waiting for frames to be produced by this node.
+	void record_read_blocked(duration_type d) { read_blocked_ns_.add(ns_(d)); }
+	
+	/// Record that this node was blocked during \a d, waiting for its output buffer to become writable.
+	void record_write_blocked(duration_type d) { add_(write_blocked_ns_, ns_(d)); }
+	
+	/// Record that a pull from one of the inputs of this node failed.
+	void record_pull_failure() { add_(pull_failures_, 1); }
+	
+	/// Record whether frames requested from this node were already prefetched.
+	void record_prefetch(bool hit) { (hit ? prefetch_hits_ : prefetch_misses_).add(1); }
+	
+	const latency_histogram& processing_latency() const { return processing_latency_; }
+	std::uint64_t frames() const { return frames_.load(std::memory_order_relaxed); }
+	duration_type read_blocked_time() const { return duration_type(read_blocked_ns_.load()); }
+	duration_type write_blocked_time() const { return duration_type(write_blocked_ns_.load(std::memory_order_relaxed)); }
+	std::uint64_t pull_failures() const { return pull_failures_.load(std::memory_order_relaxed); }
+	std::uint64_t prefetch_hits() const { return prefetch_hits_.load(); }
+	std::uint64_t prefetch_misses() const { return prefetch_misses_.load(); }
+	
+	/// Reset all counters. Must not be called while the graph is running.
+	void reset();
+};
+
+
+/// Snapshot of the metrics of one node, taken using \ref graph::metrics_snapshot().
+struct node_metrics_snapshot {
+	using duration_type = node_metrics::duration_type;
+
+	const node* this_node = nullptr;
+	std::string node_name;
+	
+	std::uint64_t frames = 0; ///< Number of frames processed.
+	real frames_per_second = 0.0; ///< Processed frames per second of wall-clock time the graph has been running.
+	latency_histogram::snapshot processing_latency; ///< Processing time of individual frames.
+
+	duration_type read_blocked_time; ///< Total time readers waited for frames from this node.
+	duration_type write_blocked_time; ///< Total time this node waited for space in its output buffer.
+	std::uint64_t pull_failures = 0; ///< Number of failed pulls from inputs of this node.
+	std::uint64_t prefetch_hits = 0; ///< Number of requests for frames that had already been prefetched.
+	std::uint64_t prefetch_misses = 0; ///< Number of requests for frames that had not yet been prefetched.
+	
+	node_metrics_snapshot() = default;
+	node_metrics_snapshot(const node&, std::chrono::duration<real> running_time);
+	
+	/// Fraction of requests for frames that were already prefetched, or `0` if no frames were requested.
+	real prefetch_hit_rate() const;
+};
+
+}}
+
+#endif
@@ -1,44 +1,223 @@
 #include "processing_timeline.h"
 #include "../graph.h"
 #include "../processing_node.h"
-#include <ostream>
+#include <algorithm>
+#include <utility>
 
 namespace mf { namespace flow {
 
-processing_timeline::processing_timeline(graph& gr) :
-	graph_(gr) { }
+constexpr std::size_t processing_timeline::default_thread_capacity;
+constexpr std::size_t processing_timeline::default_retained_capacity;
 
+std::atomic<std::uint64_t> processing_timeline::last_id_{0};
 
-void processing_timeline::processing_node_job_started(const processing_node& nd, time_unit t) {
-	clock_time_type start_clock_time = clock_type::now();
-	std::lock_guard<std::mutex> lock(jobs_mutex_);
+
+processing_timeline::thread_buffer::thread_buffer(std::size_t capacity) :
+	ring_(capacity) { }
+
+
+void processing_timeline::thread_buffer::started(const processing_node& nd, time_unit t, clock_time_type clock_time) {
+	open_jobs_.push_back({ &nd, t, nd.processing_thread_index(), clock_time, clock_time_type() });
+}
+
+
+void processing_timeline::thread_buffer::finished
+(const processing_node& nd, time_unit t, clock_time_type clock_time, clock_type::duration threshold) {
+	// jobs of sync nodes can be nested in jobs of other nodes on the same thread
+	auto it = std::find_if(open_jobs_.rbegin(), open_jobs_.rend(), [&nd](const job& jb) { return (jb.node == &nd); });
+	Assert(it != open_jobs_.rend());
+	job jb = *it;
+	jb.end_clock_time = clock_time;
+	open_jobs_.erase(std::next(it).base());
 	
-	jobs_.push_back({ nd, t, start_clock_time, clock_time_type() });
+	if(jb.end_clock_time - jb.start_clock_time < threshold) return;
+
+	std::uint64_t head = head_.load(std::memory_order_relaxed);
+	std::uint64_t tail = tail_.load(std::memory_order_acquire);
+	if(head - tail == ring_.size()) {
+		dropped_count_.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	ring_[head % ring_.size()] = jb;
+	head_.store(head + 1, std::memory_order_release);
+}
+
+
+void processing_timeline::thread_buffer::drain(std::vector<job>& jobs) {
+	std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+	std::uint64_t head = head_.load(std::memory_order_acquire);
+	for(std::uint64_t i = tail; i < head; ++i) jobs.push_back(ring_[i % ring_.size()]);
+	tail_.store(head, std::memory_order_release);
+}
+
+
+///////////////
+
+
+processing_timeline::processing_timeline(graph& gr, std::size_t thread_capacity, std::size_t retained_capacity) :
+	graph_(gr),
+	id_(++last_id_),
+	thread_capacity_(thread_capacity),
+	retained_capacity_(retained_capacity)
+{
+	Expects(thread_capacity > 0);
+}
+
+
+processing_timeline::~processing_timeline() {
+	stop_drainer_();
+}
+
+
+auto processing_timeline::this_thread_buffer_() -> thread_buffer& {
+	// each thread caches pointers to its buffers, keyed by unique timeline id
+	thread_local std::vector<std::pair<std::uint64_t, thread_buffer*>> cached_buffers;
+	for(const auto& cached : cached_buffers)
+		if(cached.first == id_) return *cached.second;
+
+	thread_buffer* buffer = new thread_buffer(thread_capacity_);
+	{
+		std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
+		thread_buffers_.emplace_back(buffer);
+	}
+	cached_buffers.emplace_back(id_, buffer);
+	return *buffer;
+}
+
+
+void processing_timeline::set_frame_sampling(time_unit period) {
+	Expects(period >= 1);
+	Expects(! graph_.is_launched());
+	frame_sampling_period_ = period;
+}
+
+
+void processing_timeline::set_latency_threshold(clock_type::duration threshold) {
+	Expects(! graph_.is_launched());
+	latency_threshold_ = threshold;
+}
+
+
+void processing_timeline::set_drain_interval(std::chrono::milliseconds interval) {
+	Expects(interval.count() > 0);
+	Expects(! graph_.is_launched());
+	drain_interval_ = interval;
+}
+
 
-	current_node_jobs_.emplace(&nd, &jobs_.back());
+void processing_timeline::processing_node_job_started(const processing_node& nd, time_unit t) {
+	if(! is_sampled_(t)) return;
+	this_thread_buffer_().started(nd, t, clock_type::now());
 }
 
 
 void processing_timeline::processing_node_job_finished(const processing_node& nd, time_unit t) {
+	if(! is_sampled_(t)) return;
 	clock_time_type end_clock_time = clock_type::now();
-	std::lock_guard<std::mutex> lock(jobs_mutex_);
-	
-	auto it = current_node_jobs_.find(&nd);
-	Assert(it != current_node_jobs_.end());
-	
-	it->second->end_clock_time = end_clock_time;
-	
-	current_node_jobs_.erase(it);
+	this_thread_buffer_().finished(nd, t, end_clock_time, latency_threshold_);
+}
+
+
+void processing_timeline::drainer_main_() {
+	std::unique_lock<std::mutex> lock(drainer_mutex_);
+	while(! drainer_stop_) {
+		drainer_cv_.wait_for(lock, drain_interval_, [&] { return drainer_stop_; });
+		lock.unlock();
+		drain();
+		lock.lock();
+	}
+}
+
+
+void processing_timeline::start_drainer_() {
+	if(drainer_thread_.joinable()) return;
+	drainer_stop_ = false;
+	drainer_thread_ = std::thread(&processing_timeline::drainer_main_, this);
+}
+
+
+void processing_timeline::stop_drainer_() {
+	if(! drainer_thread_.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(drainer_mutex_);
+		drainer_stop_ = true;
+	}
+	drainer_cv_.notify_one();
+	drainer_thread_.join();
 }
 
 
 void processing_timeline::launched(const graph& gr) {
-	
+	start_drainer_();
 }
 
 
 void processing_timeline::stopped(const graph& gr) {
+	stop_drainer_();
+	drain();
+}
+
+
+void processing_timeline::drain() {
+	std::lock_guard<std::mutex> drained_lock(drained_mutex_);
+	
+	drain_buffer_.clear();
+	{
+		std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
+		for(const auto& buffer : thread_buffers_) buffer->drain(drain_buffer_);
+	}
 	
+	for(const job& jb : drain_buffer_) {
+		std::unique_ptr<latency_histogram>& durations = node_durations_[jb.node];
+		if(durations == nullptr) durations.reset(new latency_histogram);
+		durations->record(std::chrono::duration_cast<latency_histogram::duration_type>(
+			jb.end_clock_time - jb.start_clock_time));
+		
+		if(retained_capacity_ == 0) { ++discarded_jobs_count_; continue; }
+		if(retained_jobs_.size() == retained_capacity_) {
+			retained_jobs_.pop_front();
+			++discarded_jobs_count_;
+		}
+		retained_jobs_.push_back(jb);
+	}
+}
+
+
+auto processing_timeline::jobs() -> std::vector<job> {
+	drain();
+	std::vector<job> all_jobs;
+	{
+		std::lock_guard<std::mutex> lock(drained_mutex_);
+		all_jobs.assign(retained_jobs_.begin(), retained_jobs_.end());
+	}
+	std::stable_sort(all_jobs.begin(), all_jobs.end(), [](const job& a, const job& b) {
+		return (a.start_clock_time < b.start_clock_time);
+	});
+	return all_jobs;
+}
+
+
+auto processing_timeline::summaries() -> std::vector<node_summary> {
+	drain();
+	std::lock_guard<std::mutex> lock(drained_mutex_);
+	std::vector<node_summary> node_summaries;
+	for(const auto& kv : node_durations_)
+		node_summaries.push_back({ kv.first, latency_histogram::snapshot(*kv.second) });
+	return node_summaries;
+}
+
+
+std::size_t processing_timeline::dropped_jobs_count() const {
+	std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
+	std::size_t count = 0;
+	for(const auto& buffer : thread_buffers_) count += buffer->dropped_count();
+	return count;
+}
+
+
+std::size_t processing_timeline::discarded_jobs_count() const {
+	std::lock_guard<std::mutex> lock(drained_mutex_);
+	return discarded_jobs_count_;
 }
 
 
@@ -2,44 +2,153 @@
 #define MF_FLOW_PROCESSING_TIMELINE_H_
 
 #include "diagnostic_handler.h"
+#include "node_metrics.h"
+#include "../executor.h"
 #include <chrono>
 #include <vector>
+#include <deque>
 #include <map>
+#include <memory>
+#include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
 
 namespace mf { namespace flow {
 
+/// Diagnostic handler which records start and end clock times of processing node jobs.
+/** Each thread records its jobs into its own bounded ring buffer, so that recording takes no lock and does not
+ ** distort the timings. While the graph is launched, a background thread periodically drains the ring buffers: it
+ ** aggregates the jobs into per-node summaries, and retains the most recent jobs up to a fixed capacity. When the
+ ** ring buffer of a thread is full nonetheless, further jobs of that thread are dropped, and counted. Memory usage
+ ** is bounded, so the timeline can stay enabled for long runs.
+ ** Jobs can be sampled by frame time, or by duration. Unsampled jobs are not recorded at all, and also not included
+ ** in the summaries. (Exact per-node statistics of all jobs are available in \ref node_metrics.)
+ ** The retained jobs can be exported in the Chrome trace format using \ref export_chrome_trace(). */
 class processing_timeline : public diagnostic_handler {
 public:
 	using clock_type = std::chrono::high_resolution_clock;
 	using clock_time_type = clock_type::time_point;
 
 	struct job {
-		const processing_node& node;
+		const processing_node* node;
 		time_unit frame_time;
+		thread_index thread; ///< Processing thread index of the node, not the index of the OS thread.
 		clock_time_type start_clock_time;
 		clock_time_type end_clock_time;
 	};
-	
+
+	/// Summary of the durations of the recorded jobs of one node.
+	struct node_summary {
+		const processing_node* node;
+		latency_histogram::snapshot durations;
+	};
+
+	static constexpr std::size_t default_thread_capacity = 1 << 14;
+	static constexpr std::size_t default_retained_capacity = 1 << 18;
+
 private:
+	/// Ring buffer of jobs recorded by one OS thread.
+	/** Single producer, which is the owning thread, and single consumer, which drains the jobs in `[tail, head[`. */
+	class thread_buffer {
+	private:
+		std::vector<job> ring_;
+		std::atomic<std::uint64_t> head_{0};
+		std::atomic<std::uint64_t> tail_{0};
+		std::atomic<std::size_t> dropped_count_{0};
+		std::vector<job> open_jobs_; ///< Started but not finished jobs, accessed by owning thread only.
+
+	public:
+		explicit thread_buffer(std::size_t capacity);
+
+		void started(const processing_node&, time_unit t, clock_time_type);
+		void finished(const processing_node&, time_unit t, clock_time_type, clock_type::duration threshold);
+		void drain(std::vector<job>&);
+		std::size_t dropped_count() const { return dropped_count_.load(std::memory_order_relaxed); }
+	};
+
+	static std::atomic<std::uint64_t> last_id_;
+
 	graph& graph_;
-	std::vector<job> jobs_;
-	std::map<const processing_node*, job*> current_node_jobs_;
-	std::mutex jobs_mutex_;
-	
+	const std::uint64_t id_;
+	std::size_t thread_capacity_;
+	std::size_t retained_capacity_;
+
+	time_unit frame_sampling_period_ = 1;
+	clock_type::duration latency_threshold_ = clock_type::duration::zero();
+	std::chrono::milliseconds drain_interval_{100};
+
+	mutable std::mutex thread_buffers_mutex_; ///< Taken only when a thread records its first job, and by drain().
+	std::vector<std::unique_ptr<thread_buffer>> thread_buffers_;
+
+	mutable std::mutex drained_mutex_; ///< Protects drained jobs and summaries, and serializes drain().
+	std::deque<job> retained_jobs_;
+	std::size_t discarded_jobs_count_ = 0;
+	std::map<const processing_node*, std::unique_ptr<latency_histogram>> node_durations_;
+	std::vector<job> drain_buffer_;
+
+	std::thread drainer_thread_;
+	std::mutex drainer_mutex_;
+	std::condition_variable drainer_cv_;
+	bool drainer_stop_ = false;
+
+	thread_buffer& this_thread_buffer_();
+	bool is_sampled_(time_unit t) const { return (t % frame_sampling_period_ == 0); }
+	void drainer_main_();
+	void start_drainer_();
+	void stop_drainer_();
+
 public:
-	explicit processing_timeline(graph&);
+	explicit processing_timeline(graph&,
+		std::size_t thread_capacity = default_thread_capacity, std::size_t retained_capacity = default_retained_capacity);
+	~processing_timeline();
 
 	void processing_node_job_started(const processing_node&, time_unit t) override;
 	void processing_node_job_finished(const processing_node&, time_unit t) override;
 	void launched(const graph&) override;
 	void stopped(const graph&) override;
-	
+
 	graph& this_graph() { return graph_; }
 	const graph& this_graph() const { return graph_; }
-	
-	std::size_t jobs_count() const { return jobs_.size(); }
-	const job& job_at(std::ptrdiff_t index) const { return jobs_.at(index); }
+
+	/// Maximal number of jobs pending in the ring buffer of each OS thread.
+	std::size_t thread_capacity() const { return thread_capacity_; }
+
+	/// Maximal number of most recent jobs retained for export.
+	std::size_t retained_capacity() const { return retained_capacity_; }
+
+	/// Record only jobs for frames whose time is a multiple of \a period.
+	/** Must not be called while the graph is launched. */
+	void set_frame_sampling(time_unit period);
+	time_unit frame_sampling() const { return frame_sampling_period_; }
+
+	/// Record only jobs whose duration is at least \a threshold.
+	/** Must not be called while the graph is launched. */
+	void set_latency_threshold(clock_type::duration threshold);
+	clock_type::duration latency_threshold() const { return latency_threshold_; }
+
+	/// Interval at which the background thread drains the per-thread ring buffers.
+	/** Must not be called while the graph is launched. */
+	void set_drain_interval(std::chrono::milliseconds interval);
+	std::chrono::milliseconds drain_interval() const { return drain_interval_; }
+
+	/// Move all jobs from the per-thread ring buffers into the summaries and the retained jobs.
+	/** Called periodically by the background thread, and by the accessors below. */
+	void drain();
+
+	/// Copy of the retained jobs, ordered by start clock time.
+	/** Jobs which get recorded concurrently to this call may be missing. */
+	std::vector<job> jobs();
+
+	/// Summaries of the recorded jobs of each node, including the jobs no longer retained.
+	std::vector<node_summary> summaries();
+
+	/// Number of jobs which were not recorded because a thread ring buffer was full.
+	std::size_t dropped_jobs_count() const;
+
+	/// Number of recorded jobs which are included in the summaries, but no longer retained.
+	std::size_t discarded_jobs_count() const;
 };
 
 }}
@@ -0,0 +1,206 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "executor.h"
+#include "../os/worker_pool.h"
+#include <algorithm>
+
+namespace mf { namespace flow {
+
+namespace {
+	/// Executor and worker index of the calling thread.
+	/** Worker index is -1 for threads that were started while other threads were blocked: they have no own queue. */
+	struct executor_thread_info {
+		executor* exec = nullptr;
+		std::ptrdiff_t worker_index = -1;
+	};
+
+	thread_local executor_thread_info this_executor_thread_;
+	
+	/// Schedules the helpers of \ref worker_pool loops called from a thread of the executor, on its other workers.
+	class loop_scheduler_ : public worker_pool::scheduler {
+	private:
+		executor& executor_;
+		std::ptrdiff_t worker_index_;
+	
+	public:
+		loop_scheduler_(executor& exec, std::ptrdiff_t worker_index) :
+			executor_(exec), worker_index_(worker_index) { }
+		
+		std::size_t helpers_count() override {
+			return executor_.workers_count() - 1;
+		}
+		
+		void schedule_helper(const std::function<void()>& task, std::ptrdiff_t helper_index) override {
+			executor_.submit(task, thread_index(worker_index_ + 1 + helper_index));
+		}
+	};
+}
+
+
+executor::executor(std::size_t workers_count) {
+	Expects(workers_count >= 1);
+	for(std::size_t i = 0; i < workers_count; ++i) workers_.emplace_back(new worker);
+	
+	std::lock_guard<std::mutex> lock(state_mutex_);
+	for(std::size_t i = 0; i < workers_count; ++i)
+		threads_.emplace_back(&executor::thread_main_, this, i);
+}
+
+
+executor::~executor() {
+	// threads end once remaining tasks have been executed
+	// no more threads get started after stopped_ was set
+	{
+		std::lock_guard<std::mutex> lock(state_mutex_);
+		stopped_ = true;
+	}
+	wake_cv_.notify_all();
+	for(std::thread& th : threads_) th.join();
+}
+
+
+std::size_t executor::threads_count() {
+	std::lock_guard<std::mutex> lock(state_mutex_);
+	return threads_.size();
+}
+
+
+std::size_t executor::running_threads_count_() const {
+	return threads_.size() - sleeping_threads_count_ - blocked_threads_count_;
+}
+
+
+void executor::wake_(std::unique_lock<std::mutex>& lock) {
+	Expects(lock.owns_lock());
+	if(sleeping_threads_count_ > 0)
+		wake_cv_.notify_one();
+	else if(! stopped_ && running_threads_count_() < workers_count())
+		threads_.emplace_back(&executor::thread_main_, this, -1);
+}
+
+
+bool executor::try_pop_(std::ptrdiff_t worker_index, std::function<task_function_type>& task) {
+	if(worker_index == -1) return false;
+	worker& wk = *workers_[worker_index];
+	std::lock_guard<std::mutex> lock(wk.mutex);
+	if(wk.tasks.empty()) return false;
+	task = std::move(wk.tasks.front());
+	wk.tasks.pop_front();
+	return true;
+}
+
+
+bool executor::try_steal_(std::ptrdiff_t thief_index, std::function<task_function_type>& task) {
+	std::ptrdiff_t count = workers_count();
+	std::ptrdiff_t start = (thief_index == -1 ? 0 : thief_index + 1);
+	for(std::ptrdiff_t i = 0; i < count; ++i) {
+		std::ptrdiff_t victim_index = (start + i) % count;
+		if(victim_index == thief_index) continue;
+		
+		worker& wk = *workers_[victim_index];
+		std::unique_lock<std::mutex> lock(wk.mutex, std::try_to_lock);
+		if(! lock.owns_lock() || wk.tasks.empty()) continue;
+		task = std::move(wk.tasks.front());
+		wk.tasks.pop_front();
+		return true;
+	}
+	return false;
+}
+
+
+void executor::thread_main_(std::ptrdiff_t worker_index) {
+	this_executor_thread_.exec = this;
+	this_executor_thread_.worker_index = worker_index;
+	loop_scheduler_ loop_scheduler(*this, worker_index);
+	worker_pool::set_this_thread_scheduler(&loop_scheduler);
+	
+	std::function<task_function_type> task;
+	for(;;) {
+		if(try_pop_(worker_index, task) || try_steal_(worker_index, task)) {
+			--pending_tasks_count_;
+			task();
+			task = nullptr;
+			continue;
+		}
+		
+		std::unique_lock<std::mutex> lock(state_mutex_);
+		// pending task may be in queue whose mutex was held by another thread during try_steal_
+		// surplus threads (started while others were blocked, which are now running again) go to sleep instead
+		if(pending_tasks_count_ > 0 && (stopped_ || running_threads_count_() <= workers_count())) continue;
+		else if(stopped_) break;
+		
+		++sleeping_threads_count_;
+		wake_cv_.wait(lock);
+		--sleeping_threads_count_;
+	}
+	
+	worker_pool::set_this_thread_scheduler(nullptr);
+}
+
+
+void executor::submit(const std::function<task_function_type>& task, thread_index affinity) {
+	bool on_worker_thread = (this_executor_thread_.exec == this && this_executor_thread_.worker_index != -1);
+	
+	std::ptrdiff_t worker_index;
+	if(affinity != undefined_thread_index) worker_index = affinity % workers_count();
+	else if(on_worker_thread) worker_index = this_executor_thread_.worker_index;
+	else worker_index = next_worker_index_++ % workers_count();
+	bool own_queue = (on_worker_thread && worker_index == this_executor_thread_.worker_index);
+	
+	++pending_tasks_count_;
+	bool was_empty;
+	{
+		worker& wk = *workers_[worker_index];
+		std::lock_guard<std::mutex> lock(wk.mutex);
+		was_empty = wk.tasks.empty();
+		wk.tasks.push_back(task);
+	}
+	
+	// task submitted into empty queue of calling worker will be taken by it after the current task
+	// (or when the current task blocks, blocking_scope wakes another thread)
+	if(own_queue && was_empty) return;
+
+	std::unique_lock<std::mutex> lock(state_mutex_);
+	wake_(lock);
+}
+
+
+///////////////
+
+
+executor::blocking_scope::blocking_scope() :
+	executor_(this_executor_thread_.exec)
+{
+	if(executor_ == nullptr) return;
+	std::unique_lock<std::mutex> lock(executor_->state_mutex_);
+	++executor_->blocked_threads_count_;
+	if(executor_->pending_tasks_count_ > 0) executor_->wake_(lock);
+}
+
+
+executor::blocking_scope::~blocking_scope() {
+	if(executor_ == nullptr) return;
+	std::lock_guard<std::mutex> lock(executor_->state_mutex_);
+	--executor_->blocked_threads_count_;
+}
+
+
+}}
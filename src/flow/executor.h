@@ -0,0 +1,114 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_FLOW_EXECUTOR_H_
+#define MF_FLOW_EXECUTOR_H_
+
+#include "../common.h"
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace mf { namespace flow {
+
+/// Logical thread on which a node gets processed.
+/** Asynchronous nodes get their own thread index, but run on a fixed number of \ref executor workers. The thread index
+ ** then serves as affinity hint: the tasks of a node get submitted to the same worker. */
+using thread_index = int;
+static constexpr thread_index undefined_thread_index = -1;
+
+
+/// Pool of worker threads on which the asynchronous nodes of a \ref graph get executed.
+/** Tasks are submitted with a logical \ref thread_index as affinity hint, which selects the worker in whose queue the
+ ** task gets placed. Each worker takes the tasks from its own queue in submission order, so that the nodes sharing a
+ ** worker get processed in turn. When its queue is empty, it steals the oldest task from the queue of another worker.
+ ** Tasks that resubmit themselves thus cannot starve the other tasks of a queue.
+ ** A task that waits for another task (for example for frames from another node) must do so inside a
+ ** \ref blocking_scope. While workers are blocked, additional threads get started so that the number of running
+ ** threads stays at \ref workers_count(), and the awaited task can always run. */
+class executor {
+public:
+	using task_function_type = void();
+	class blocking_scope;
+
+private:
+	struct worker {
+		std::mutex mutex;
+		std::deque<std::function<task_function_type>> tasks;
+	};
+	
+	std::vector<std::unique_ptr<worker>> workers_;
+	std::vector<std::thread> threads_;
+
+	std::mutex state_mutex_;
+	std::condition_variable wake_cv_;
+	std::size_t sleeping_threads_count_ = 0;
+	std::size_t blocked_threads_count_ = 0;
+	bool stopped_ = false;
+	
+	std::atomic<std::ptrdiff_t> pending_tasks_count_ {0};
+	std::atomic<std::size_t> next_worker_index_ {0};
+	
+	std::size_t running_threads_count_() const;
+	void wake_(std::unique_lock<std::mutex>&);
+	bool try_pop_(std::ptrdiff_t worker_index, std::function<task_function_type>&);
+	bool try_steal_(std::ptrdiff_t thief_index, std::function<task_function_type>&);
+	void thread_main_(std::ptrdiff_t worker_index);
+
+public:
+	explicit executor(std::size_t workers_count);
+	executor(const executor&) = delete;
+	executor& operator=(const executor&) = delete;
+	~executor();
+	
+	/// Number of workers, each with its own task queue.
+	std::size_t workers_count() const { return workers_.size(); }
+	
+	/// Number of threads started so far, including those started while other threads were blocked.
+	std::size_t threads_count();
+	
+	/// Submit task for execution on the worker selected by \a affinity.
+	/** If \a affinity is \ref undefined_thread_index, the task is placed in the queue of the calling worker, or
+	 ** distributed over the workers when not called from a worker thread. */
+	void submit(const std::function<task_function_type>&, thread_index affinity = undefined_thread_index);
+};
+
+
+/// Marks the calling thread as blocked, during the lifetime of the object.
+/** Has no effect if the calling thread is not a thread of an \ref executor. */
+class executor::blocking_scope {
+private:
+	executor* executor_ = nullptr;
+
+public:
+	blocking_scope();
+	blocking_scope(const blocking_scope&) = delete;
+	blocking_scope& operator=(const blocking_scope&) = delete;
+	~blocking_scope();
+};
+
+}}
+
+#endif
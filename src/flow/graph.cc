@@ -24,6 +24,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 
 #include "graph_visualization.h"
 #include <thread>
+#include <algorithm>
 
 namespace mf { namespace flow {
 
@@ -50,6 +51,15 @@ void graph::setup() {
 	sink_->setup_graph();
 	for(const auto& nd : nodes_) Assert(nd->was_setup());
 	
+	// plan ring buffers of all nodes before allocating any of them
+	memory_plan_ = ring_memory_plan(*this);
+	if(memory_budget_ != 0) memory_plan_.enforce_budget(memory_budget_);
+	for(const auto& nd : nodes_) nd->allocate_buffers();
+	
+	{
+		std::lock_guard<std::mutex> lock(metrics_time_mutex_);
+		metrics_running_time_ = metrics_clock_type::duration::zero();
+	}
 	was_setup_ = true;
 }
 
@@ -64,13 +74,24 @@ thread_index graph::root_thread_index() const {
 }
 
 
+std::size_t graph::workers_count() const {
+	if(workers_count_ != 0) return workers_count_;
+	else return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+
 void graph::launch() {
 	if(launched_) return;
 	
 	if(has_diagnostic()) diagnostic().launched(*this);
 		
 	was_stopped_ = false;
-	launched_ = true;
+	{
+		std::lock_guard<std::mutex> lock(metrics_time_mutex_);
+		launched_ = true;
+		launch_clock_time_ = metrics_clock_type::now();
+	}
+	executor_.reset(new executor(workers_count()));
 	for(const auto& nd : nodes_) nd->launch();
 }
 
@@ -84,7 +105,34 @@ void graph::stop() {
 	was_stopped_.store(true);
 	for(const auto& nd : nodes_) nd->pre_stop();
 	for(const auto& nd : nodes_) nd->stop();
+	executor_.reset();
+	
+	std::lock_guard<std::mutex> lock(metrics_time_mutex_);
 	launched_ = false;
+	metrics_running_time_ += metrics_clock_type::now() - launch_clock_time_;
+}
+
+
+std::vector<node_metrics_snapshot> graph::metrics_snapshot() const {
+	std::chrono::duration<real> running_time;
+	{
+		std::lock_guard<std::mutex> lock(metrics_time_mutex_);
+		running_time = metrics_running_time_;
+		if(launched_) running_time += metrics_clock_type::now() - launch_clock_time_;
+	}
+	
+	std::vector<node_metrics_snapshot> snapshots;
+	snapshots.reserve(nodes_.size());
+	for(const auto& nd : nodes_) snapshots.emplace_back(*nd, running_time);
+	return snapshots;
+}
+
+
+void graph::reset_metrics() {
+	Expects(! launched_);
+	for(const auto& nd : nodes_) nd->metrics().reset();
+	std::lock_guard<std::mutex> lock(metrics_time_mutex_);
+	metrics_running_time_ = metrics_clock_type::duration::zero();
 }
 
 
@@ -23,7 +23,10 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 
 #include "../common.h"
 #include "diagnostic/diagnostic_handler.h"
+#include "diagnostic/node_metrics.h"
 #include "node.h"
+#include "executor.h"
+#include "ring_memory_plan.h"
 #include "sink_node.h"
 #include <utility>
 #include <vector>
@@ -31,6 +34,8 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include <stdexcept>
 #include <type_traits>
 #include <functional>
+#include <chrono>
+#include <mutex>
 
 namespace mf { namespace flow {
 
@@ -48,10 +53,19 @@ private:
 	bool was_setup_ = false;
 	bool launched_ = false;
 	thread_index last_thread_index_ = 0;
+	std::size_t workers_count_ = 0;
+	std::size_t memory_budget_ = 0;
+	ring_memory_plan memory_plan_;
 	
+	std::unique_ptr<executor> executor_;
 	std::atomic<bool> was_stopped_ {false};
 
 	diagnostic_handler* diagnostic_handler_ = nullptr;
+	
+	using metrics_clock_type = node_metrics::clock_type;
+	mutable std::mutex metrics_time_mutex_; ///< Protects running time, and launched_ state seen by metrics_snapshot().
+	metrics_clock_type::duration metrics_running_time_ = metrics_clock_type::duration::zero();
+	metrics_clock_type::time_point launch_clock_time_;
 
 	void pull_next_frame_();
 
@@ -83,12 +97,33 @@ public:
 	thread_index root_thread_index() const;
 	bool was_stopped() const { return was_stopped_; }
 	
+	/// Number of executor workers. Defaults to the hardware concurrency when set to 0.
+	std::size_t workers_count() const;
+	void set_workers_count(std::size_t count) { Expects(! launched_); workers_count_ = count; }
+	executor& task_executor() { Assert(executor_ != nullptr); return *executor_; }
+	
+	/// Maximal total size of ring buffers in bytes, enforced at setup, or `0` for no limit.
+	/** See \ref ring_memory_plan. */
+	std::size_t memory_budget() const { return memory_budget_; }
+	void set_memory_budget(std::size_t bytes) { Expects(! was_setup_); memory_budget_ = bytes; }
+	
+	/// Plan of the ring buffers, computed at setup.
+	const ring_memory_plan& memory_plan() const { Expects(was_setup_); return memory_plan_; }
+	
 	void set_diagnostic(diagnostic_handler& handler) { diagnostic_handler_ = &handler; }
 	void unset_diagnostic() { diagnostic_handler_ = nullptr; }
 	bool has_diagnostic() const { return (diagnostic_handler_ != nullptr); }
 	diagnostic_handler& diagnostic() { Assert(has_diagnostic()); return *diagnostic_handler_; }
 	const diagnostic_handler& diagnostic() const { Assert(has_diagnostic()); return *diagnostic_handler_; }
 	
+	/// Take snapshot of the metrics of all nodes, in the order in which they were added.
+	/** Can be called from any thread, also while the graph is running. Frame rates are relative to the wall-clock
+	 ** time during which the graph has been launched, since setup or the last call to reset_metrics(). */
+	std::vector<node_metrics_snapshot> metrics_snapshot() const;
+	
+	/// Reset the metrics of all nodes. Graph must not be launched.
+	void reset_metrics();
+	
 	std::size_t nodes_count() const { return nodes_.size(); }
 	const node& node_at(std::ptrdiff_t i) const { return *nodes_.at(i); }
 	node& node_at(std::ptrdiff_t i) { return *nodes_.at(i); }
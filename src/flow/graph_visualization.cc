@@ -112,7 +112,21 @@ void graph_visualization::generate_processing_node_(const processing_node& nd, b
 	else html << "sync node";
 	if(async) {
 		html << R"(<BR/>)";
-		html << "prefetch = " << static_cast<const async_node&>(nd).prefetch_duration();
+		const async_node& async_nd = static_cast<const async_node&>(nd);
+		html << "prefetch = " << async_nd.prefetch_duration();
+		if(async_nd.has_adaptive_prefetch())
+			html << " to " << async_nd.maximal_prefetch_duration() << " (" << async_nd.effective_prefetch_duration() << ")";
+		time_unit batch = static_cast<const async_node&>(nd).batch_duration();
+		if(batch > 1) html << R"(<BR/>)" << "batch = " << batch;
+	}
+	if(with_memory_plan_ && graph_.was_setup()) {
+		const ring_memory_plan::ring* rg = graph_.memory_plan().ring_of(nd);
+		if(rg != nullptr) {
+			html << R"(<BR/>)";
+			html << "ring = " << rg->capacity << " &#215; " << format_memory_size(rg->frame_size)
+				<< " = " << format_memory_size(rg->size());
+			if(rg->reduced) html << " (reduced)";
+		}
 	}
 	html << R"(</FONT>)";
 	if(with_state_) {
@@ -279,6 +293,12 @@ void graph_visualization::generate_ranks_() {
 void graph_visualization::generate() {
 	output_ << "digraph " << graph_id_ << "{\n";
 	output_ << "\trankdir=TB\n";
+	if(with_memory_plan_ && graph_.was_setup()) {
+		const ring_memory_plan& plan = graph_.memory_plan();
+		output_ << "\tlabel=\"ring buffers: " << format_memory_size(plan.total_size());
+		if(plan.budget() != 0) output_ << " (budget " << format_memory_size(plan.budget()) << ")";
+		output_ << "\"\n\tlabelloc=t\n";
+	}
 
 	for(std::ptrdiff_t i = 0; i < graph_.nodes_count(); ++i) generate_node_dispatch_(graph_.node_at(i));
 	for(std::ptrdiff_t i = 0; i < graph_.nodes_count(); ++i) generate_node_input_connections_(graph_.node_at(i));
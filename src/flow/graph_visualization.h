@@ -43,6 +43,7 @@ private:
 	std::string graph_id_ = "G";
 	bool thread_index_colors_ = true;
 	bool with_state_ = true;
+	bool with_memory_plan_ = true;
 	std::map<std::uintptr_t, std::string> uids_;
 	
 	template<typename T> std::string uid_(const T& object, const std::string& prefix);
@@ -171,6 +171,17 @@ std::string multiplex_node_output::channel_name_at(std::ptrdiff_t i) const {
 }
 
 
+std::ptrdiff_t multiplex_node_output::channel_first_part_index(std::ptrdiff_t i) const {
+	return 0;
+}
+
+
+std::size_t multiplex_node_output::channel_parts_count(std::ptrdiff_t i) const {
+	// the one channel has all parts of the input channel
+	return this_node().input().connected_output().channel_parts_count(input_channel_index_);
+}
+
+
 node::pull_result multiplex_node_output::pull(time_span& span, bool reconnect) {
 	Assert(this_node().loader_);
 
@@ -191,7 +202,7 @@ timed_frame_array_view multiplex_node_output::begin_read(time_unit duration) {
 	Assert(! vw.is_null());
 	Assert(vw.span().includes(pulled_span), "multiplex input view span does not include span to read");
 
-	return extract_part(vw, input_channel_index_);
+	return extract_channel(vw, this_node().input().connected_output(), input_channel_index_);
 }
 
 
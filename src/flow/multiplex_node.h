@@ -42,6 +42,8 @@ public:
 	
 	std::size_t channels_count() const noexcept override;
 	std::string channel_name_at(std::ptrdiff_t i) const override;
+	std::ptrdiff_t channel_first_part_index(std::ptrdiff_t i) const override;
+	std::size_t channel_parts_count(std::ptrdiff_t i) const override;
 	node::pull_result pull(time_span& span, bool reconnect) override;
 	timed_frame_array_view begin_read(time_unit duration) override;
 	void end_read(time_unit duration) override;
@@ -89,62 +89,95 @@ multiplex_node::async_loader::async_loader(multiplex_node& nd) :
 
 
 multiplex_node::async_loader::~async_loader() {
-	Assert(! thread_.joinable(), "multiplex_node::async_loader must be stopped before destruction");
+	Assert(task_finished_, "multiplex_node::async_loader must be stopped before destruction");
 }
 
 
-void multiplex_node::async_loader::thread_main_() {
-	for(;;) {
-		time_unit successor_time = -1;
-		
-		// wait until current  successor_time no longer equal to the successor time for which input view was loaded 
-		std::unique_lock<std::mutex> lock(successor_time_mutex_);
-		successor_time_changed_cv_.wait(lock, [&] {
-			if(stopped_) return true;
+void multiplex_node::async_loader::schedule_task_() {
+	if(! task_scheduled_.exchange(true))
+		this_node().this_graph().task_executor().submit(
+			std::bind(&multiplex_node::async_loader::task_main_, this),
+			loader_thread_index()
+		);
+}
+
+
+void multiplex_node::async_loader::lock_input_view_shared_(std::shared_lock<std::shared_timed_mutex>& lock) {
+	// loader holds exclusive lock while loading input view, which may wait for frames from other node
+	if(lock.try_lock()) return;
+	executor::blocking_scope blocking;
+	lock.lock();
+}
+
+
+void multiplex_node::async_loader::task_main_() {
+	time_unit successor_time = -1;
+	
+	{
+		// task gets parked while current successor_time is equal to the successor time for which input view was loaded
+		// task_scheduled_ is reset before checking, so that either schedule_task_() resubmits it, or the check sees
+		// the new successor time
+		std::lock_guard<std::mutex> lock(successor_time_mutex_);
+		task_scheduled_ = false;
+		bool stopped = stopped_;
+		if(! stopped) {
 			successor_time = this_node().capture_successor_time_();
-			return (successor_time != this_node().successor_time_of_input_view_());
-		});
-		lock.unlock();
-		Assert(successor_time != -1);
-		
-		if(stopped_) break;
-		
-		// acquire exclusive lock on input view mutex --> waits until all readers end
-		// and load the new input view
-		{
-			std::lock_guard<std::shared_timed_mutex> view_lock(input_view_mutex_);
-			this_node().load_input_view_(successor_time);
+			if(successor_time == this_node().successor_time_of_input_view_()) return;
+		}
+		if(task_scheduled_.exchange(true)) return; // other instance of task was submitted in the meantime
+
+		if(stopped) {
+			if(! task_finished_) {
+				std::lock_guard<std::shared_timed_mutex> view_lock(input_view_mutex_);
+				this_node().unload_input_view_();
+			}
+			task_finished_ = true;
+			task_scheduled_ = false;
+			task_finished_cv_.notify_all();
+			return;
 		}
-		
-		// notify waiting readers that input view was changed
-		input_view_updated_cv_.notify_all();
 	}
+	Assert(successor_time != -1);
 	
+	// acquire exclusive lock on input view mutex --> waits until all readers end
+	// and load the new input view
 	{
-		std::lock_guard<std::shared_timed_mutex> view_lock(input_view_mutex_);
-		this_node().unload_input_view_();
+		std::unique_lock<std::shared_timed_mutex> view_lock(input_view_mutex_, std::defer_lock);
+		{
+			executor::blocking_scope blocking;
+			view_lock.lock();
+		}
+		this_node().load_input_view_(successor_time);
 	}
+	
+	// notify waiting readers that input view was changed
+	input_view_updated_cv_.notify_all();
+	
+	// successor time may have changed again in the meantime
+	this_node().this_graph().task_executor().submit(
+		std::bind(&multiplex_node::async_loader::task_main_, this),
+		loader_thread_index()
+	);
 }
 
 
 void multiplex_node::async_loader::stop() {
 	Assert(this_node().this_graph().was_stopped());
-	Assert(thread_.joinable());
 	
 	stopped_ = true;
 
-	successor_time_changed_cv_.notify_one();
 	input_view_updated_cv_.notify_all();
+	schedule_task_();
 	
-	thread_.join();	
+	std::unique_lock<std::mutex> lock(successor_time_mutex_);
+	task_finished_cv_.wait(lock, [&] { return task_finished_; });
 }
 
 
 void multiplex_node::async_loader::launch() {
 	stopped_ = false;
-	thread_ = std::move(std::thread(
-		std::bind(&multiplex_node::async_loader::thread_main_, this)
-	));
+	task_finished_ = false;
+	schedule_task_();
 }
 
 
@@ -162,12 +195,14 @@ node::pull_result multiplex_node::async_loader::pull(time_span span) {
 	// acquire shared lock on input view
 	// shared with other readers calling pull() on different threads
 	// loader can modify the input view when all readers release the shared lock
-	std::shared_lock<std::shared_timed_mutex> lock(input_view_mutex_);
+	std::shared_lock<std::shared_timed_mutex> lock(input_view_mutex_, std::defer_lock);
+	lock_input_view_shared_(lock);
 	
 	// wail until loader updates the input view for the current time of the common successor node
 	while(this_node().current_time() != this_node().capture_successor_time_()) {
 		if(stopped_) return node::pull_result::stopped;
-		successor_time_changed_cv_.notify_one();
+		schedule_task_();
+		executor::blocking_scope blocking;
 		input_view_updated_cv_.wait(lock);
 	}
 	if(stopped_) return node::pull_result::stopped;
@@ -181,7 +216,9 @@ node::pull_result multiplex_node::async_loader::pull(time_span span) {
 
 
 timed_frame_array_view multiplex_node::async_loader::begin_read(time_span span) {
-	input_view_mutex_.lock_shared();
+	std::shared_lock<std::shared_timed_mutex> lock(input_view_mutex_, std::defer_lock);
+	lock_input_view_shared_(lock);
+	lock.release();
 	
 	timed_frame_array_view input_view = this_node().input_view_();
 		
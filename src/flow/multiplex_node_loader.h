@@ -22,7 +22,6 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #define MF_FLOW_MULTIPLEX_NODE_LOADER_H_
 
 #include "multiplex_node.h"
-#include <thread>
 #include <condition_variable>
 #include <mutex>
 #include <shared_mutex>
@@ -76,16 +75,19 @@ public:
 
 class multiplex_node::async_loader : public multiplex_node::loader {
 private:
-	std::thread thread_;
 	std::atomic<bool> stopped_ {false};
+	std::atomic<bool> task_scheduled_ {false};
+	bool task_finished_ = true;
 	
 	std::mutex successor_time_mutex_;	
-	std::condition_variable successor_time_changed_cv_;
+	std::condition_variable task_finished_cv_;
 
 	std::shared_timed_mutex input_view_mutex_;
 	std::condition_variable_any input_view_updated_cv_;
 
-	void thread_main_();
+	void lock_input_view_shared_(std::shared_lock<std::shared_timed_mutex>&);
+	void schedule_task_();
+	void task_main_();
 
 public:
 	explicit async_loader(multiplex_node&);
@@ -24,6 +24,8 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include "../common.h"
 #include "../queue/frame.h"
 #include "node_stream_properties.h"
+#include "executor.h"
+#include "diagnostic/node_metrics.h"
 #include <vector>
 #include <atomic>
 #include <string>
@@ -37,9 +39,6 @@ class graph;
 class node_output;
 class node_input;
 
-using thread_index = int;
-static constexpr thread_index undefined_thread_index = -1;
-
 /// Node in flow graph, base class.
 class node {
 public:
@@ -61,6 +60,7 @@ private:
 	std::atomic<bool> reached_end_ {false};
 	
 	std::string name_ = "node";
+	node_metrics metrics_;
 	
 	/// Recursively pre-setup nodes in sink-to-source order.
 	/** Must be called on sink node. Calls pre_setup() once on each node in graph, in an order such that when one node
@@ -127,6 +127,10 @@ public:
 	const std::string& name() const { return name_; }
 	void set_name(const std::string& nm) { name_ = nm; }
 	
+	/// Counters recorded while the graph is running, see \ref graph::metrics_snapshot().
+	node_metrics& metrics() noexcept { return metrics_; }
+	const node_metrics& metrics() const noexcept { return metrics_; }
+	
 	void setup_sink();
 
 	online_state state() const { return state_; }
@@ -136,6 +140,10 @@ public:
 			
 	virtual void pre_setup() { }
 	virtual void setup() { }
+	
+	/// Allocate buffers, after all nodes were setup and the graph applied its \ref ring_memory_plan.
+	virtual void allocate_buffers() { }
+	
 	virtual void launch() { }
 	virtual void pre_stop() { }
 	virtual void stop() { }
@@ -58,6 +58,7 @@ node::pull_result node_input::pull() {
 	Assert(span.includes(t));
 	
 	pulled_span_ = span;
+	if(result == node::transitory_failure) this_node().metrics().record_pull_failure();
 	return result;
 }
 
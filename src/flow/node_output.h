@@ -28,7 +28,8 @@ namespace mf { namespace flow {
 
 /// Output port of node in node graph.
 /** One output port have multiple *channels*. The output is *pulled* as a whole, but data is read from individual
- ** channels. The channels may have different formats. */
+ ** channels. The channels may have different formats. Each channel consists of one or more consecutive parts of
+ ** the output frame format. */
 class node_output {
 private:
 	node& node_;
@@ -62,6 +63,8 @@ public:
 
 	virtual std::size_t channels_count() const noexcept = 0;
 	virtual std::string channel_name_at(std::ptrdiff_t i) const = 0;
+	virtual std::ptrdiff_t channel_first_part_index(std::ptrdiff_t i) const = 0;
+	virtual std::size_t channel_parts_count(std::ptrdiff_t i) const = 0;
 	virtual node::pull_result pull(time_span& span, bool reconnect) = 0;
 	virtual timed_frame_array_view begin_read(time_unit duration) = 0;
 	virtual void end_read(time_unit duration) = 0;
@@ -70,6 +73,13 @@ public:
 };
 
 
+/// View to the frames of channel \a channel_index, from view \a vw to the whole frames of \a out.
+template<typename View>
+View extract_channel(const View& vw, const node_output& out, std::ptrdiff_t channel_index) {
+	return extract_parts(vw, out.channel_first_part_index(channel_index), out.channel_parts_count(channel_index));
+}
+
+
 }}
 
 #endif
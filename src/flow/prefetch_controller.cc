@@ -0,0 +1,93 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "prefetch_controller.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mf { namespace flow {
+
+constexpr int prefetch_controller::shrink_streak;
+constexpr real prefetch_controller::smoothing;
+
+
+prefetch_controller::prefetch_controller(time_unit minimal_duration, time_unit maximal_duration) :
+	minimal_duration_(minimal_duration),
+	maximal_duration_(maximal_duration),
+	duration_(minimal_duration)
+{
+	Expects(minimal_duration >= 0);
+	Expects(maximal_duration >= minimal_duration);
+}
+
+
+real prefetch_controller::average_(real average, real value) {
+	if(average == 0.0) return value;
+	else return average + smoothing * (value - average);
+}
+
+
+auto prefetch_controller::producer_frame_time() const -> duration_type {
+	return duration_type(static_cast<duration_type::rep>(producer_frame_time_.load()));
+}
+
+
+auto prefetch_controller::consumer_period() const -> duration_type {
+	return duration_type(static_cast<duration_type::rep>(consumer_period_));
+}
+
+
+void prefetch_controller::record_produced(time_unit frames, duration_type elapsed) {
+	if(frames <= 0) return;
+	real frame_time = real(elapsed.count()) / frames;
+	producer_frame_time_.store(average_(producer_frame_time_.load(), frame_time));
+}
+
+
+void prefetch_controller::record_request(clock_type::time_point clock_time) {
+	if(had_request_) {
+		real period = std::chrono::duration<real, std::nano>(clock_time - last_request_clock_time_).count();
+		consumer_period_ = average_(consumer_period_, period);
+	}
+	last_request_clock_time_ = clock_time;
+	had_request_ = true;
+}
+
+
+void prefetch_controller::record_hit() {
+	if(++hits_streak_ < shrink_streak) return;
+	hits_streak_ = 0;
+	
+	real producer_frame_time = producer_frame_time_.load();
+	bool producer_faster = (producer_frame_time > 0.0) && (producer_frame_time < consumer_period_);
+	if(producer_faster) duration_ = std::max(duration_ - 1, minimal_duration_);
+}
+
+
+void prefetch_controller::record_stall(duration_type blocked) {
+	hits_streak_ = 0;
+	
+	time_unit missed_frames = 1;
+	if(consumer_period_ > 0.0)
+		missed_frames = std::max<time_unit>(std::ceil(blocked.count() / consumer_period_), 1);
+	duration_ = std::min(duration_ + missed_frames, maximal_duration_);
+}
+
+}}
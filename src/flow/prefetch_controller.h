@@ -0,0 +1,85 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_FLOW_PREFETCH_CONTROLLER_H_
+#define MF_FLOW_PREFETCH_CONTROLLER_H_
+
+#include "../common.h"
+#include <chrono>
+#include <atomic>
+
+namespace mf { namespace flow {
+
+/// Adapts the prefetch duration of an \ref async_node at runtime, within fixed bounds.
+/** Measures the producer rate (processing time per frame, recorded by the writer) and the consumer rate (interval
+ ** between requests, recorded by the reader). When the reader stalls because the requested frames were not
+ ** prefetched, the duration grows by the number of frames the consumer would have requested during the stall. After
+ ** a streak of requests that were all prefetched, and if the producer is faster than the consumer, so that it can
+ ** refill the buffer, the duration shrinks by one frame.
+ ** Prefetch duration grows fast for bursty producers, and slowly returns to the minimum for steady ones. */
+class prefetch_controller {
+public:
+	using clock_type = std::chrono::steady_clock;
+	using duration_type = std::chrono::nanoseconds;
+	
+	static constexpr int shrink_streak = 32; ///< Number of consecutive prefetch hits before shrinking.
+	static constexpr real smoothing = 1.0 / 8.0; ///< Weight of new measurement in moving averages.
+
+private:
+	time_unit minimal_duration_;
+	time_unit maximal_duration_;
+	std::atomic<time_unit> duration_;
+	
+	std::atomic<real> producer_frame_time_{0.0}; ///< Moving average, in nanoseconds. Written by writer.
+	real consumer_period_ = 0.0; ///< Moving average, in nanoseconds. Written by reader.
+	clock_type::time_point last_request_clock_time_;
+	bool had_request_ = false;
+	int hits_streak_ = 0;
+	
+	static real average_(real average, real value);
+
+public:
+	prefetch_controller(time_unit minimal_duration, time_unit maximal_duration);
+
+	time_unit minimal_duration() const { return minimal_duration_; }
+	time_unit maximal_duration() const { return maximal_duration_; }
+	
+	/// Current prefetch duration, in `[minimal_duration, maximal_duration]`.
+	time_unit duration() const { return duration_; }
+	
+	duration_type producer_frame_time() const;
+	duration_type consumer_period() const;
+	
+	/// Called by writer after processing \a frames frames during \a elapsed.
+	void record_produced(time_unit frames, duration_type elapsed);
+	
+	/// Called by reader when it requests frames, at \a clock_time.
+	void record_request(clock_type::time_point clock_time);
+	
+	/// Called by reader when the requested frames were already prefetched.
+	void record_hit();
+	
+	/// Called by reader after it was blocked during \a blocked, waiting for the requested frames.
+	void record_stall(duration_type blocked);
+};
+
+}}
+
+#endif
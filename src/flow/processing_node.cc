@@ -36,6 +36,18 @@ std::string processing_node_output::channel_name_at(std::ptrdiff_t i) const {
 }
 
 
+std::ptrdiff_t processing_node_output::channel_first_part_index(std::ptrdiff_t i) const {
+	std::ptrdiff_t first_part_index = 0;
+	for(std::ptrdiff_t j = 0; j < i; ++j) first_part_index += channel_parts_count(j);
+	return first_part_index;
+}
+
+
+std::size_t processing_node_output::channel_parts_count(std::ptrdiff_t i) const {
+	return this_node().output_channels_.at(i)->frame_format().parts_count();
+}
+
+
 node::pull_result processing_node_output::pull(time_span& span, bool reconnect) {
 	return this_node().output_pull_(span, reconnect);
 }
@@ -95,13 +107,22 @@ void processing_node::handler_process_(processing_node_job& job) {
 	if(this_graph().has_diagnostic())
 		this_graph().diagnostic().processing_node_job_started(*this, job.time());
 	
+	auto start_clock_time = node_metrics::clock_type::now();
 	handler_->handler_process(*this, job);
+	metrics().record_frame(node_metrics::clock_type::now() - start_clock_time);
 
 	if(this_graph().has_diagnostic())
 		this_graph().diagnostic().processing_node_job_finished(*this, job.time());
 }
 
 
+time_unit processing_node::output_ring_capacity() const {
+	Expects(has_output());
+	const node& connected_node = output().connected_node();
+	return 1 + maximal_offset_to(connected_node) - minimal_offset_to(connected_node);
+}
+
+
 processing_node_job processing_node::begin_job_() {
 	return processing_node_job(*this);
 }
@@ -167,9 +188,9 @@ const processing_node_output_channel& processing_node::output_channel_at(std::pt
 ndarray_opaque_frame_format processing_node::output_frame_format_() const {
 	ndarray_opaque_frame_format frm;
 	for(auto&& chan : output_channels_) {
-		const ndarray_format& channel_frame_format = chan->frame_format();
+		const ndarray_opaque_frame_format& channel_frame_format = chan->frame_format();
 		Assert(channel_frame_format.is_defined());
-		frm.add_part(channel_frame_format);
+		frm.add_parts(channel_frame_format);
 	}
 	return frm;
 }
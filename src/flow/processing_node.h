@@ -46,14 +46,15 @@ public:
 
 
 /// Channel of the \ref processing_node_output of a \ref processing_node.
-/** Defines \ref ndarray_format for the frames on that channel.
+/** Defines the format for the frames on that channel. This is either one \ref ndarray_format, or a multi-part
+ ** \ref ndarray_opaque_frame_format, for example for planar images.
  ** Has index value for use with \ref processing_node_job. */
 class processing_node_output_channel final {
 private:
 	processing_node& node_;
 	std::string name_;
 	const std::ptrdiff_t index_;
-	ndarray_format frame_format_;
+	ndarray_opaque_frame_format frame_format_;
 
 public:
 	processing_node_output_channel(processing_node& nd, std::ptrdiff_t index) :
@@ -66,8 +67,9 @@ public:
 	const processing_node& this_node() const { return node_; }
 	std::ptrdiff_t index() const { return index_; }
 	
-	void define_frame_format(const ndarray_format& frm) { frame_format_ = frm; }
-	const ndarray_format& frame_format() const noexcept { return frame_format_; }
+	void define_frame_format(const ndarray_format& frm) { frame_format_ = ndarray_opaque_frame_format(frm); }
+	void define_frame_format(const ndarray_opaque_frame_format& frm) { Expects(! frm.is_raw()); frame_format_ = frm; }
+	const ndarray_opaque_frame_format& frame_format() const noexcept { return frame_format_; }
 };
 
 
@@ -83,6 +85,8 @@ public:
 	
 	std::size_t channels_count() const noexcept override;
 	std::string channel_name_at(std::ptrdiff_t i) const override;
+	std::ptrdiff_t channel_first_part_index(std::ptrdiff_t i) const override;
+	std::size_t channel_parts_count(std::ptrdiff_t i) const override;
 	
 	node::pull_result pull(time_span& span, bool reconnect) override;
 	timed_frame_array_view begin_read(time_unit duration) override;
@@ -146,6 +150,14 @@ public:
 
 	virtual thread_index processing_thread_index() const = 0;
 	
+	/// Capacity needed for the ring buffer of the output, in frames.
+	/** Depends on the time windows of successors, and for \ref async_node also on its prefetch and batch durations.
+	 ** Available after pre-setup. */
+	time_unit output_ring_capacity() const;
+	
+	/// Size of one output frame, in bytes. Available after setup.
+	std::size_t output_frame_size() const { return output_frame_format_().frame_size(); }
+	
 	input_type& add_input();
 	output_channel_type& add_output_channel();
 				
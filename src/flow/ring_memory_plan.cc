@@ -0,0 +1,112 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ring_memory_plan.h"
+#include "graph.h"
+#include "processing_node.h"
+#include "async_node.h"
+#include "../exceptions.h"
+#include <sstream>
+#include <iomanip>
+
+namespace mf { namespace flow {
+
+ring_memory_plan::ring_memory_plan(graph& gr) {
+	for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(gr.nodes_count()); ++i) {
+		auto* nd = dynamic_cast<processing_node*>(&gr.node_at(i));
+		if(nd == nullptr || ! nd->has_output()) continue;
+		bool asynchronous = (dynamic_cast<async_node*>(nd) != nullptr);
+		rings_.push_back({ nd, asynchronous, 0, nd->output_frame_size(), false });
+	}
+	compute_capacities_();
+}
+
+
+void ring_memory_plan::compute_capacities_() {
+	for(ring& rg : rings_) rg.capacity = rg.node->output_ring_capacity();
+}
+
+
+bool ring_memory_plan::reduce_(async_node& nd) {
+	if(nd.has_adaptive_prefetch() && nd.maximal_prefetch_duration() > nd.prefetch_duration()) {
+		nd.set_adaptive_prefetch(nd.maximal_prefetch_duration() - 1);
+	} else if(nd.prefetch_duration() > 0) {
+		nd.set_prefetch_duration(nd.prefetch_duration() - 1);
+		if(nd.has_adaptive_prefetch()) nd.set_adaptive_prefetch(nd.prefetch_duration());
+	} else if(nd.batch_duration() > 1) {
+		nd.set_batch_duration(nd.batch_duration() - 1);
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+void ring_memory_plan::enforce_budget(std::size_t budget) {
+	Expects(budget > 0);
+	budget_ = budget;
+	
+	while(total_size() > budget_) {
+		// reduce largest ring of an async node that can still be reduced
+		ring* largest = nullptr;
+		for(ring& rg : rings_) {
+			if(! rg.asynchronous) continue;
+			const async_node& nd = static_cast<const async_node&>(*rg.node);
+			bool reducible = (nd.maximal_prefetch_duration() > 0) || (nd.batch_duration() > 1);
+			if(reducible && (largest == nullptr || rg.size() > largest->size())) largest = &rg;
+		}
+		if(largest == nullptr)
+			throw memory_budget_exceeded("ring buffers need " + format_memory_size(total_size())
+				+ ", budget is " + format_memory_size(budget_));
+		
+		bool reduced = reduce_(static_cast<async_node&>(*largest->node));
+		Assert(reduced);
+		largest->reduced = true;
+		compute_capacities_();
+	}
+}
+
+
+auto ring_memory_plan::ring_of(const node& nd) const -> const ring* {
+	for(const ring& rg : rings_) if(rg.node == &nd) return &rg;
+	return nullptr;
+}
+
+
+std::size_t ring_memory_plan::total_size() const {
+	std::size_t total = 0;
+	for(const ring& rg : rings_) total += rg.size();
+	return total;
+}
+
+
+std::string format_memory_size(std::size_t bytes) {
+	const char* units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+	std::ptrdiff_t unit = 0;
+	double size = bytes;
+	while(size >= 1024.0 && unit < 4) { size /= 1024.0; ++unit; }
+	
+	std::ostringstream str;
+	if(unit == 0) str << bytes << ' ' << units[0];
+	else str << std::fixed << std::setprecision(1) << size << ' ' << units[unit];
+	return str.str();
+}
+
+}}
@@ -0,0 +1,84 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_FLOW_RING_MEMORY_PLAN_H_
+#define MF_FLOW_RING_MEMORY_PLAN_H_
+
+#include "../common.h"
+#include <vector>
+#include <string>
+
+namespace mf { namespace flow {
+
+class graph;
+class node;
+class processing_node;
+class async_node;
+
+/// Plan of the ring buffers of all nodes in a graph, with their sizes in bytes.
+/** Computed by \ref graph::setup() after all nodes were setup, and before the ring buffers get allocated. When a
+ ** memory budget is set, the plan reduces the durations of asynchronous nodes until the total size fits: first the
+ ** maximal adaptive prefetch durations, then the prefetch durations, and then the batch durations, taking one frame
+ ** at a time from the largest reducible ring. An async node with no prefetch and no batching needs the same ring
+ ** capacity as a sync node. If the budget still cannot be met, \ref memory_budget_exceeded is thrown. */
+class ring_memory_plan {
+public:
+	/// Planned ring buffer of the output of one node.
+	struct ring {
+		processing_node* node;
+		bool asynchronous;
+		time_unit capacity; ///< Capacity in frames.
+		std::size_t frame_size; ///< Size of one frame in bytes, excluding padding between frames.
+		bool reduced; ///< Whether the durations of the (async) node were reduced to meet the budget.
+		
+		std::size_t size() const { return capacity * frame_size; }
+	};
+	
+private:
+	std::vector<ring> rings_;
+	std::size_t budget_ = 0;
+	
+	void compute_capacities_();
+	static bool reduce_(async_node&);
+
+public:
+	ring_memory_plan() = default;
+	explicit ring_memory_plan(graph&);
+	
+	/// Reduce the durations of asynchronous nodes such that total size is at most \a budget bytes.
+	void enforce_budget(std::size_t budget);
+	
+	const std::vector<ring>& rings() const { return rings_; }
+	const ring* ring_of(const node&) const;
+	
+	/// Sum of sizes of all ring buffers, in bytes.
+	std::size_t total_size() const;
+	
+	/// Memory budget in bytes, or `0` if none is enforced.
+	std::size_t budget() const { return budget_; }
+};
+
+
+/// Format size in bytes as human-readable string, with binary unit prefix.
+std::string format_memory_size(std::size_t bytes);
+
+}}
+
+#endif
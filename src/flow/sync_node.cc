@@ -49,12 +49,12 @@ thread_index sync_node::processing_thread_index() const {
 
 void sync_node::setup() {
 	handler_setup_();
-		
-	node& connected_node = output().connected_node();
-	time_unit required_capacity = 1 + maximal_offset_to(connected_node) - minimal_offset_to(connected_node);
-	
+}
+
+
+void sync_node::allocate_buffers() {
 	auto buffer_frame_format = output_frame_format_();
-	ring_.reset(new timed_ring(buffer_frame_format, required_capacity));
+	ring_.reset(new timed_ring(buffer_frame_format, output_ring_capacity()));
 }
 
 
@@ -46,6 +46,7 @@ public:
 	time_unit maximal_offset_to(const node&) const override;
 	
 	void setup() final override;
+	void allocate_buffers() final override;
 			
 	pull_result output_pull_(time_span&, bool reconnected) override;
 	timed_frame_array_view output_begin_read_(time_unit duration) override;
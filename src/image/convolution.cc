@@ -0,0 +1,412 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "convolution.h"
+#include "../utility/misc.h"
+#include "../os/cpu.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#ifdef MF_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace mf {
+
+namespace {
+
+using multiply_add_function = std::ptrdiff_t(float* acc, const float* src, float weight, std::ptrdiff_t count);
+
+
+#ifdef MF_X86_SIMD
+
+/// Compute `acc[i] += weight * src[i]`, 8 elements at a time.
+/** Returns number of elements processed, the remaining elements need to be processed by scalar code. */
+std::ptrdiff_t multiply_add_sse2_(float* acc, const float* src, float weight, std::ptrdiff_t count) {
+	const __m128 w = _mm_set1_ps(weight);
+	std::ptrdiff_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		__m128 a0 = _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(w, _mm_loadu_ps(src + i)));
+		__m128 a1 = _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(w, _mm_loadu_ps(src + i + 4)));
+		_mm_storeu_ps(acc + i, a0);
+		_mm_storeu_ps(acc + i + 4, a1);
+	}
+	return i;
+}
+
+
+/// Compute `acc[i] += weight * src[i]`, 16 elements at a time.
+/** Like multiply_add_sse2_(). Does not use FMA instructions, so that results are identical to the other code paths. */
+MF_TARGET_AVX2 std::ptrdiff_t multiply_add_avx2_(float* acc, const float* src, float weight, std::ptrdiff_t count) {
+	const __m256 w = _mm256_set1_ps(weight);
+	std::ptrdiff_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		__m256 a0 = _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(w, _mm256_loadu_ps(src + i)));
+		__m256 a1 = _mm256_add_ps(_mm256_loadu_ps(acc + i + 8), _mm256_mul_ps(w, _mm256_loadu_ps(src + i + 8)));
+		_mm256_storeu_ps(acc + i, a0);
+		_mm256_storeu_ps(acc + i + 8, a1);
+	}
+	return i;
+}
+
+
+/// Convert contiguous 8 bit row to `float`, 16 elements at a time.
+std::ptrdiff_t load_row_sse2_(const std::uint8_t* src, float* dst, std::ptrdiff_t count) {
+	const __m128i zero = _mm_setzero_si128();
+	std::ptrdiff_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i lo = _mm_unpacklo_epi8(v, zero);
+		__m128i hi = _mm_unpackhi_epi8(v, zero);
+		_mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+		_mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+		_mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+		_mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+	}
+	return i;
+}
+
+
+/// Round and saturate `float` row into contiguous 8 bit row, 16 elements at a time.
+/** Rounds to nearest even, like `std::nearbyint` in the default rounding mode. */
+std::ptrdiff_t store_row_sse2_(const float* src, std::uint8_t* dst, std::ptrdiff_t count) {
+	const __m128 minimum = _mm_setzero_ps();
+	const __m128 maximum = _mm_set1_ps(255.0f);
+	auto convert = [&](const float* s) {
+		return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(s), minimum), maximum));
+	};
+	std::ptrdiff_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		__m128i lo = _mm_packs_epi32(convert(src + i), convert(src + i + 4));
+		__m128i hi = _mm_packs_epi32(convert(src + i + 8), convert(src + i + 12));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	return i;
+}
+
+#endif
+
+
+/// Select vectorized multiply-add function for processor, or `nullptr` if none available.
+multiply_add_function* select_multiply_add_() {
+	#ifdef MF_X86_SIMD
+	if(cpu_supports_avx2()) return &multiply_add_avx2_;
+	else return &multiply_add_sse2_;
+	#else
+	return nullptr;
+	#endif
+}
+
+
+/// Compute `acc[i] += weight * src[i]` for \a count elements.
+void multiply_add_(float* acc, const float* src, float weight, std::ptrdiff_t count) {
+	static multiply_add_function* const multiply_add = select_multiply_add_();
+	std::ptrdiff_t i = 0;
+	if(multiply_add != nullptr) i = multiply_add(acc, src, weight, count);
+	for(; i < count; ++i) acc[i] += weight * src[i];
+}
+
+
+void load_row_(const float* src, std::ptrdiff_t stride, float* dst, std::ptrdiff_t count) {
+	if(stride == sizeof(float)) {
+		std::memcpy(dst, src, count * sizeof(float));
+	} else {
+		for(std::ptrdiff_t i = 0; i < count; ++i, src = advance_raw_ptr(src, stride)) dst[i] = *src;
+	}
+}
+
+
+void load_row_(const std::uint8_t* src, std::ptrdiff_t stride, float* dst, std::ptrdiff_t count) {
+	std::ptrdiff_t i = 0;
+	if(stride == 1) {
+		#ifdef MF_X86_SIMD
+		i = load_row_sse2_(src, dst, count);
+		#endif
+		src += i;
+	}
+	for(; i < count; ++i, src = advance_raw_ptr(src, stride)) dst[i] = *src;
+}
+
+
+void store_row_(const float* src, float* dst, std::ptrdiff_t stride, std::ptrdiff_t count) {
+	if(stride == sizeof(float)) {
+		std::memcpy(dst, src, count * sizeof(float));
+	} else {
+		for(std::ptrdiff_t i = 0; i < count; ++i, dst = advance_raw_ptr(dst, stride)) *dst = src[i];
+	}
+}
+
+
+void store_row_(const float* src, std::uint8_t* dst, std::ptrdiff_t stride, std::ptrdiff_t count) {
+	std::ptrdiff_t i = 0;
+	if(stride == 1) {
+		#ifdef MF_X86_SIMD
+		i = store_row_sse2_(src, dst, count);
+		#endif
+		dst += i;
+	}
+	for(; i < count; ++i, dst = advance_raw_ptr(dst, stride))
+		*dst = static_cast<std::uint8_t>(std::nearbyint(clamp(src[i], 0.0f, 255.0f)));
+}
+
+
+/// Map index \a i to index in `[0, n[`, according to border mode. Returns -1 for constant border.
+std::ptrdiff_t border_index_(std::ptrdiff_t i, std::ptrdiff_t n, border_mode border) {
+	if(i >= 0 && i < n) return i;
+	switch(border) {
+		case border_mode::constant:
+			return -1;
+		case border_mode::replicate:
+			return (i < 0 ? 0 : n - 1);
+		case border_mode::reflect: {
+			if(n == 1) return 0;
+			std::ptrdiff_t period = 2*n - 2;
+			i = ((i % period) + period) % period;
+			return (i < n ? i : period - i);
+		}
+		case border_mode::wrap:
+			return ((i % n) + n) % n;
+	}
+	return -1;
+}
+
+
+/// Row-by-row convolution of image with elements of type \a Elem.
+/** Keeps a ring buffer with the rows needed for the current output row, indexed by their (possibly outside)
+ ** row index. For non-separable kernels these are padded input rows, for separable kernels they are the input rows
+ ** already filtered with the row vector. Each of them gets computed once. */
+template<typename Elem>
+class convolver_ {
+private:
+	const ndarray_view<2, const Elem>& in_;
+	const ndarray_view<2, Elem>& out_;
+	const convolution_kernel& kernel_;
+	border_mode border_;
+	float border_value_;
+	
+	std::ptrdiff_t height_, width_;
+	std::ptrdiff_t kernel_height_, kernel_width_;
+	std::ptrdiff_t margin_y_, margin_x_;
+	std::ptrdiff_t padded_width_;
+	
+	std::vector<float> padded_row_;
+	std::vector<float> ring_rows_;
+	std::vector<std::ptrdiff_t> ring_row_indices_;
+	std::ptrdiff_t ring_row_length_;
+	std::vector<float> acc_row_;
+	
+	void pad_row_(std::ptrdiff_t y, float* padded) const {
+		std::ptrdiff_t in_y = border_index_(y, height_, border_);
+		if(in_y == -1) {
+			std::fill_n(padded, padded_width_, border_value_);
+			return;
+		}
+		const Elem* in_row = advance_raw_ptr(in_.start(), in_y * in_.strides()[0]);
+		float* row = padded + margin_x_;
+		load_row_(in_row, in_.strides()[1], row, width_);
+		for(std::ptrdiff_t i = 1; i <= margin_x_; ++i) {
+			std::ptrdiff_t left = border_index_(-i, width_, border_);
+			std::ptrdiff_t right = border_index_(width_ - 1 + i, width_, border_);
+			row[-i] = (left == -1 ? border_value_ : row[left]);
+			row[width_ - 1 + i] = (right == -1 ? border_value_ : row[right]);
+		}
+	}
+	
+	void filter_row_(const float* padded, float* out) const {
+		const std::vector<float>& row_weights = kernel_.row_weights();
+		std::fill_n(out, width_, 0.0f);
+		for(std::ptrdiff_t j = 0; j < kernel_width_; ++j)
+			if(row_weights[j] != 0.0f) multiply_add_(out, padded + j, row_weights[j], width_);
+	}
+	
+	const float* ring_row_(std::ptrdiff_t y) {
+		std::ptrdiff_t slot = ((y % kernel_height_) + kernel_height_) % kernel_height_;
+		float* row = ring_rows_.data() + slot * ring_row_length_;
+		if(ring_row_indices_[slot] != y) {
+			if(kernel_.is_separable()) {
+				pad_row_(y, padded_row_.data());
+				filter_row_(padded_row_.data(), row);
+			} else {
+				pad_row_(y, row);
+			}
+			ring_row_indices_[slot] = y;
+		}
+		return row;
+	}
+
+public:
+	convolver_(
+		const ndarray_view<2, const Elem>& in, const ndarray_view<2, Elem>& out,
+		const convolution_kernel& kernel, border_mode border, float border_value
+	) :
+		in_(in), out_(out), kernel_(kernel), border_(border), border_value_(border_value),
+		height_(in.shape()[0]), width_(in.shape()[1]),
+		kernel_height_(kernel.shape()[0]), kernel_width_(kernel.shape()[1]),
+		margin_y_(kernel_height_ / 2), margin_x_(kernel_width_ / 2),
+		padded_width_(width_ + 2*margin_x_)
+	{
+		if(kernel.is_separable()) {
+			padded_row_.resize(padded_width_);
+			ring_row_length_ = width_;
+		} else {
+			ring_row_length_ = padded_width_;
+		}
+		ring_rows_.resize(kernel_height_ * ring_row_length_);
+		ring_row_indices_.assign(kernel_height_, std::numeric_limits<std::ptrdiff_t>::min());
+		acc_row_.resize(width_);
+	}
+	
+	void run() {
+		float* acc = acc_row_.data();
+		for(std::ptrdiff_t y = 0; y < height_; ++y) {
+			std::fill(acc_row_.begin(), acc_row_.end(), 0.0f);
+			for(std::ptrdiff_t i = 0; i < kernel_height_; ++i) {
+				const float* row = ring_row_(y - margin_y_ + i);
+				if(kernel_.is_separable()) {
+					float weight = kernel_.column_weights()[i];
+					if(weight != 0.0f) multiply_add_(acc, row, weight, width_);
+				} else {
+					for(std::ptrdiff_t j = 0; j < kernel_width_; ++j) {
+						float weight = kernel_.weight(i, j);
+						if(weight != 0.0f) multiply_add_(acc, row + j, weight, width_);
+					}
+				}
+			}
+			Elem* out_row = advance_raw_ptr(out_.start(), y * out_.strides()[0]);
+			store_row_(acc, out_row, out_.strides()[1], width_);
+		}
+	}
+};
+
+
+template<typename Elem>
+void convolve_(
+	const ndarray_view<2, const Elem>& in,
+	const ndarray_view<2, Elem>& out,
+	const convolution_kernel& kernel,
+	border_mode border,
+	float border_value
+) {
+	Expects(in.shape() == out.shape());
+	if(in.shape().product() == 0) return;
+	convolver_<Elem> convolver(in, out, kernel, border, border_value);
+	convolver.run();
+}
+
+}
+
+
+convolution_kernel::convolution_kernel(const ndarray_view<2, const real>& weights, real tolerance) :
+	shape_(weights.shape())
+{
+	Expects(is_odd(shape_[0]) && is_odd(shape_[1]));
+	weights_.reserve(shape_.product());
+	for(real w : weights) weights_.push_back(static_cast<float>(w));
+	detect_separable_(tolerance);
+}
+
+
+convolution_kernel::convolution_kernel(const ndarray_view<2, const bool>& mask, bool normalize) :
+	shape_(mask.shape())
+{
+	Expects(is_odd(shape_[0]) && is_odd(shape_[1]));
+	std::size_t count = std::count(mask.begin(), mask.end(), true);
+	float weight = (normalize && count > 0) ? 1.0f / count : 1.0f;
+	weights_.reserve(shape_.product());
+	for(bool b : mask) weights_.push_back(b ? weight : 0.0f);
+	detect_separable_(0.0);
+}
+
+
+convolution_kernel::convolution_kernel(const std::vector<real>& column_weights, const std::vector<real>& row_weights) :
+	shape_(make_ndsize(column_weights.size(), row_weights.size())),
+	column_weights_(column_weights.begin(), column_weights.end()),
+	row_weights_(row_weights.begin(), row_weights.end()),
+	separable_(true)
+{
+	Expects(is_odd(shape_[0]) && is_odd(shape_[1]));
+	weights_.reserve(shape_.product());
+	for(float c : column_weights_) for(float r : row_weights_) weights_.push_back(c * r);
+}
+
+
+void convolution_kernel::detect_separable_(real tolerance) {
+	const std::ptrdiff_t height = shape_[0], width = shape_[1];
+	
+	// pivot = element with largest absolute value
+	auto pivot_it = std::max_element(weights_.begin(), weights_.end(),
+		[](float a, float b) { return std::abs(a) < std::abs(b); });
+	float pivot = *pivot_it;
+	std::ptrdiff_t pivot_index = pivot_it - weights_.begin();
+	std::ptrdiff_t pivot_y = pivot_index / width, pivot_x = pivot_index % width;
+	
+	if(pivot == 0.0f) {
+		column_weights_.assign(height, 0.0f);
+		row_weights_.assign(width, 0.0f);
+		separable_ = true;
+		return;
+	}
+
+	// candidate factors: pivot column, and pivot row normalized by pivot
+	column_weights_.resize(height);
+	row_weights_.resize(width);
+	for(std::ptrdiff_t y = 0; y < height; ++y) column_weights_[y] = weight(y, pivot_x);
+	for(std::ptrdiff_t x = 0; x < width; ++x) row_weights_[x] = weight(pivot_y, x) / pivot;
+	
+	real max_error = tolerance * std::abs(pivot);
+	separable_ = true;
+	for(std::ptrdiff_t y = 0; y < height && separable_; ++y)
+	for(std::ptrdiff_t x = 0; x < width; ++x) {
+		real reconstructed = real(column_weights_[y]) * real(row_weights_[x]);
+		if(std::abs(reconstructed - weight(y, x)) > max_error) { separable_ = false; break; }
+	}
+	
+	if(! separable_) {
+		column_weights_.clear();
+		row_weights_.clear();
+	}
+}
+
+
+void convolve(
+	const ndarray_view<2, const float>& in,
+	const ndarray_view<2, float>& out,
+	const convolution_kernel& kernel,
+	border_mode border,
+	float border_value
+) {
+	convolve_(in, out, kernel, border, border_value);
+}
+
+
+void convolve(
+	const ndarray_view<2, const std::uint8_t>& in,
+	const ndarray_view<2, std::uint8_t>& out,
+	const convolution_kernel& kernel,
+	border_mode border,
+	std::uint8_t border_value
+) {
+	convolve_(in, out, kernel, border, border_value);
+}
+
+
+}
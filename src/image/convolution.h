@@ -0,0 +1,107 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_IMAGE_CONVOLUTION_H_
+#define MF_IMAGE_CONVOLUTION_H_
+
+#include "../common.h"
+#include "../nd/ndarray_view.h"
+#include "kernel.h"
+#include <cstdint>
+#include <vector>
+
+namespace mf {
+
+/// Handling of the elements outside the image, which are covered by the kernel near the image border.
+enum class border_mode {
+	constant, ///< Constant value: `vvv|abcd|vvv`.
+	replicate, ///< Repeat edge element: `aaa|abcd|ddd`.
+	reflect, ///< Mirror without repeating edge element: `dcb|abcd|cba`.
+	wrap ///< Periodic continuation: `bcd|abcd|abc`.
+};
+
+
+/// Linear filter kernel for \ref convolve().
+/** Weights are stored in single precision. On construction, tests whether the kernel is separable, i.e. the outer
+ ** product of a column vector and a row vector. Separable kernels get applied in two 1D passes, with cost proportional
+ ** to `height + width` instead of `height * width` per element. Shape must be odd in both axis. */
+class convolution_kernel {
+private:
+	ndsize<2> shape_;
+	std::vector<float> weights_; // row-major
+	std::vector<float> column_weights_;
+	std::vector<float> row_weights_;
+	bool separable_ = false;
+
+	void detect_separable_(real tolerance);
+
+public:
+	/// Create kernel with weights \a weights.
+	/** The kernel is considered separable if the reconstructed weights differ by at most `tolerance * max_weight`. */
+	explicit convolution_kernel(const ndarray_view<2, const real>& weights, real tolerance = 1e-6);
+	
+	/// Create kernel from boolean mask \a mask.
+	/** Elements in the mask get weight 1, or `1 / count` if \a normalize is set, so that the filter computes the mean
+	 ** over the mask. */
+	explicit convolution_kernel(const ndarray_view<2, const bool>& mask, bool normalize = true);
+	
+	/// Create separable kernel from column and row vectors.
+	convolution_kernel(const std::vector<real>& column_weights, const std::vector<real>& row_weights);
+
+	const ndsize<2>& shape() const { return shape_; }
+	float weight(std::ptrdiff_t y, std::ptrdiff_t x) const { return weights_[y * shape_[1] + x]; }
+
+	bool is_separable() const { return separable_; }
+	const std::vector<float>& column_weights() const { Expects(separable_); return column_weights_; }
+	const std::vector<float>& row_weights() const { Expects(separable_); return row_weights_; }
+};
+
+
+/// Apply linear filter \a kernel on \a in, and write result into \a out.
+/** Computes `out(y, x) = sum(kernel(i, j) * in(y + i - ry, x + j - rx))`, where `(ry, rx)` is the kernel center. Like
+ ** with \ref apply_kernel(), the kernel is not mirrored, i.e. this is a correlation. Elements outside \a in are
+ ** determined by \a border and \a border_value.
+ ** The image is processed row by row: each input row is copied once into a buffer padded according to the border
+ ** mode, so that the inner loops contain no bounds logic. These use SSE2 or AVX2 instructions when available.
+ ** Views may have any strides, but \a in and \a out must not overlap. */
+void convolve(
+	const ndarray_view<2, const float>& in,
+	const ndarray_view<2, float>& out,
+	const convolution_kernel& kernel,
+	border_mode border = border_mode::replicate,
+	float border_value = 0.0
+);
+
+
+/// Apply linear filter \a kernel on 8 bit image \a in, and write result into \a out.
+/** Like for `float` images, but accumulates in single precision. Results are rounded to nearest and saturated to the
+ ** range `[0, 255]`. */
+void convolve(
+	const ndarray_view<2, const std::uint8_t>& in,
+	const ndarray_view<2, std::uint8_t>& out,
+	const convolution_kernel& kernel,
+	border_mode border = border_mode::replicate,
+	std::uint8_t border_value = 0
+);
+
+
+}
+
+#endif
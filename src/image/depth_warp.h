@@ -0,0 +1,82 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_IMAGE_DEPTH_WARP_H_
+#define MF_IMAGE_DEPTH_WARP_H_
+
+#include "../common.h"
+#include "../camera/projection_image_camera.h"
+#include "../nd/ndarray_view.h"
+
+namespace mf {
+
+template<typename Pixel, typename Mask> class masked_image_view;
+
+/// Number of target image rows in one z-buffer tile of \ref forward_warp().
+constexpr std::ptrdiff_t forward_warp_tile_rows = 32;
+
+
+/// Forward warp of image with depth from source camera into target camera.
+/** Each source pixel with depth other than \a null_depth gets back-projected using \a source_camera, and projected
+ ** into \a target_camera. Source pixels are splatted onto the nearest target pixel.
+ ** When several source pixels fall onto the same target pixel, the one nearest to the target camera is kept. This is
+ ** the one with the lowest depth in the target camera, or the highest depth if its depth range is disparity.
+ ** Target pixels which receive no source pixel are holes: they get value `0` in \a target_mask and are not written in
+ ** \a target_image, other pixels get `0xff`. If \a target_depth is not null, it receives the pixel depth in the
+ ** target camera, or \a null_depth for holes.
+ ** Array coordinates are the pixel coordinates of the cameras, so for row-major images the cameras need flipped pixel
+ ** coordinates.
+ ** Source rows are back-projected and projected in parallel bands, which sort their splats by target tile of
+ ** \ref forward_warp_tile_rows rows. The tiles are then resolved in parallel, each with its own z-buffer, so that no
+ ** synchronization is needed and the result is deterministic. */
+template<typename Pixel, typename Depth>
+void forward_warp(
+	const ndarray_view<2, const Depth>& source_depth,
+	const ndarray_view<2, const Pixel>& source_image,
+	const projection_image_camera<Depth>& source_camera,
+	const projection_image_camera<Depth>& target_camera,
+	const ndarray_view<2, Pixel>& target_image,
+	const ndarray_view<2, byte>& target_mask,
+	const ndarray_view<2, Depth>& target_depth = ndarray_view<2, Depth>(),
+	Depth null_depth = 0
+);
+
+
+/// Forward warp into masked image \a target, with holes marked in its mask.
+template<typename Pixel, typename Depth>
+void forward_warp(
+	const ndarray_view<2, const Depth>& source_depth,
+	const ndarray_view<2, const Pixel>& source_image,
+	const projection_image_camera<Depth>& source_camera,
+	const projection_image_camera<Depth>& target_camera,
+	const masked_image_view<Pixel, byte>& target,
+	Depth null_depth = 0
+) {
+	forward_warp(
+		source_depth, source_image, source_camera, target_camera,
+		target.array_view(), target.mask_array_view(), ndarray_view<2, Depth>(), null_depth
+	);
+}
+
+}
+
+#include "depth_warp.tcc"
+
+#endif
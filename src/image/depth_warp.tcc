@@ -0,0 +1,143 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "../point_cloud/depth_back_projection.h"
+#include "../os/worker_pool.h"
+#include "../nd/ndarray.h"
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace mf {
+
+namespace detail {
+	/// Source pixel projected onto target pixel, in \ref forward_warp().
+	struct forward_warp_splat {
+		std::ptrdiff_t target_offset; ///< Index of target pixel, relative to start of its tile.
+		std::ptrdiff_t source_row;
+		std::ptrdiff_t source_column;
+		real depth; ///< Depth in target camera.
+	};
+}
+
+
+template<typename Pixel, typename Depth>
+void forward_warp(
+	const ndarray_view<2, const Depth>& source_depth,
+	const ndarray_view<2, const Pixel>& source_image,
+	const projection_image_camera<Depth>& source_camera,
+	const projection_image_camera<Depth>& target_camera,
+	const ndarray_view<2, Pixel>& target_image,
+	const ndarray_view<2, byte>& target_mask,
+	const ndarray_view<2, Depth>& target_depth,
+	Depth null_depth
+) {
+	using splat = detail::forward_warp_splat;
+	Expects(source_depth.shape() == source_image.shape());
+	Expects(target_image.shape() == target_mask.shape());
+	Expects(target_depth.is_null() || target_depth.shape() == target_image.shape());
+	
+	const std::ptrdiff_t source_rows = source_depth.shape()[0], source_columns = source_depth.shape()[1];
+	const std::ptrdiff_t target_rows = target_image.shape()[0], target_columns = target_image.shape()[1];
+	const std::ptrdiff_t tiles_count = (target_rows + forward_warp_tile_rows - 1) / forward_warp_tile_rows;
+	const std::ptrdiff_t bands_count = (source_rows + forward_warp_tile_rows - 1) / forward_warp_tile_rows;
+	
+	// to_depth() is affine in pixel depth
+	const real depth_offset = source_camera.to_depth(0);
+	const real depth_scale = source_camera.to_depth(1) - depth_offset;
+	const depth_back_projection back_projection(
+		source_camera, source_depth.shape(), source_camera.pixel_coordinates_flipped(), depth_scale, depth_offset);
+	// Splat onto the nearest target pixel, i.e. the one whose area [p, p + 1[ contains the image coordinates.
+	// (to_pixel() truncates coordinates, which is unstable for points that project onto pixel centers.)
+	projection_camera::cull_bounds bounds = target_camera.image_cull_bounds();
+	bounds.image_min -= Eigen_vec2(0.5, 0.5);
+	bounds.image_max -= Eigen_vec2(0.5, 0.5);
+	const bool target_flipped = target_camera.pixel_coordinates_flipped();
+	// Image depth increases with distance to the camera, except for disparity where it decreases.
+	const bool disparity =
+		(target_camera.depth_parameters().range == depth_projection_parameters::unsigned_normalized_disparity);
+	const real distance_sign = (disparity ? -1.0 : 1.0);
+	
+	// Back-project and project source rows in bands, and sort the splats by target tile.
+	std::vector<std::vector<std::vector<splat>>> band_splats(bands_count, std::vector<std::vector<splat>>(tiles_count));
+	worker_pool::instance().parallel_for(bands_count, [&](std::ptrdiff_t band) {
+		const real nan = std::numeric_limits<real>::quiet_NaN();
+		std::vector<real> depth_row(source_columns);
+		ndarray<1, point_xyz> points(make_ndsize(source_columns));
+		ndarray<1, camera::image_coordinates_type> coords(make_ndsize(source_columns));
+		ndarray<1, real> depths(make_ndsize(source_columns));
+		ndarray<1, byte> retained(make_ndsize(source_columns));
+		std::vector<std::vector<splat>>& splats = band_splats[band];
+		
+		std::ptrdiff_t row_end = std::min((band + 1) * forward_warp_tile_rows, source_rows);
+		for(std::ptrdiff_t y = band * forward_warp_tile_rows; y < row_end; ++y) {
+			for(std::ptrdiff_t x = 0; x < source_columns; ++x) {
+				Depth d = source_depth[y][x];
+				depth_row[x] = (d == null_depth ? nan : static_cast<real>(d));
+			}
+			back_projection.row(y, depth_row.data(), points.view());
+			target_camera.project_batch(points.cview(), coords.view(), depths.view(), bounds, retained.view());
+
+			for(std::ptrdiff_t x = 0; x < source_columns; ++x) if(retained[x]) {
+				auto im_x = static_cast<std::ptrdiff_t>(std::floor(coords[x][0]));
+				auto im_y = static_cast<std::ptrdiff_t>(std::floor(coords[x][1]));
+				ndptrdiff<2> pix = target_flipped ? make_ndptrdiff(im_y, im_x) : make_ndptrdiff(im_x, im_y);
+				if(pix[0] < 0 || pix[0] >= target_rows || pix[1] < 0 || pix[1] >= target_columns) continue;
+				std::ptrdiff_t tile = pix[0] / forward_warp_tile_rows;
+				std::ptrdiff_t offset = (pix[0] - tile * forward_warp_tile_rows) * target_columns + pix[1];
+				splats[tile].push_back(splat { offset, y, x, depths[x] });
+			}
+		}
+	});
+	
+	// Resolve occlusions in each target tile using its own z-buffer. Bands are visited in order, and on equal depth
+	// the first splat is kept, so the result does not depend on scheduling.
+	worker_pool::instance().parallel_for(tiles_count, [&](std::ptrdiff_t tile) {
+		std::ptrdiff_t row_begin = tile * forward_warp_tile_rows;
+		std::ptrdiff_t rows = std::min(forward_warp_tile_rows, target_rows - row_begin);
+		std::vector<real> z_buffer(rows * target_columns, std::numeric_limits<real>::infinity());
+		std::vector<const splat*> nearest(rows * target_columns, nullptr);
+		
+		for(const std::vector<std::vector<splat>>& splats : band_splats)
+			for(const splat& s : splats[tile]) {
+				real z = distance_sign * s.depth;
+				if(z < z_buffer[s.target_offset]) {
+					z_buffer[s.target_offset] = z;
+					nearest[s.target_offset] = &s;
+				}
+			}
+		
+		for(std::ptrdiff_t y = 0; y < rows; ++y) for(std::ptrdiff_t x = 0; x < target_columns; ++x) {
+			const splat* s = nearest[y * target_columns + x];
+			std::ptrdiff_t target_y = row_begin + y;
+			if(s != nullptr) {
+				target_image[target_y][x] = source_image[s->source_row][s->source_column];
+				target_mask[target_y][x] = 0xff;
+				if(! target_depth.is_null()) target_depth[target_y][x] = target_camera.to_pixel_depth_clamp(s->depth);
+			} else {
+				target_mask[target_y][x] = 0;
+				if(! target_depth.is_null()) target_depth[target_y][x] = null_depth;
+			}
+		}
+	});
+}
+
+}
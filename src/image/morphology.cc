@@ -0,0 +1,319 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "morphology.h"
+#include "../utility/misc.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace mf {
+
+namespace {
+
+/// Erosion operation on normalized mask values `0` and `0xff`.
+struct erode_operation_ {
+	static constexpr byte neutral = 0xff;
+	template<typename T> static T apply(T a, T b) { return a & b; }
+};
+
+/// Dilation operation on normalized mask values `0` and `0xff`.
+struct dilate_operation_ {
+	static constexpr byte neutral = 0x00;
+	template<typename T> static T apply(T a, T b) { return a | b; }
+};
+
+constexpr byte erode_operation_::neutral;
+constexpr byte dilate_operation_::neutral;
+
+
+/// Compute `acc[i] = op(acc[i], src[i])` for \a count elements, 8 elements at a time.
+template<typename Operation>
+void combine_row_(byte* acc, const byte* src, std::ptrdiff_t count) {
+	std::ptrdiff_t i = 0;
+	for(; i + 8 <= count; i += 8) {
+		std::uint64_t a, b;
+		std::memcpy(&a, acc + i, 8);
+		std::memcpy(&b, src + i, 8);
+		a = Operation::apply(a, b);
+		std::memcpy(acc + i, &a, 8);
+	}
+	for(; i < count; ++i) acc[i] = Operation::apply(acc[i], src[i]);
+}
+
+
+/// Compute running operation over windows of \a length elements, using van Herk/Gil-Werman algorithm.
+/** `out[i]` becomes result over `src[i]` to `src[i + length - 1]`, for \a count output elements. Elements of \a src are
+ ** `stride` bytes apart. The input is divided into blocks of \a length, and for each element the prefix from its block
+ ** start and the suffix to its block end are computed. Each window covers the suffix of one block and the prefix of the
+ ** next one. \a prefix and \a suffix are buffers for `count + length - 1` elements, each of \a width bytes.
+ ** With \a width larger than 1, each element is a row which gets combined using word-level operations. */
+template<typename Operation>
+void running_operation_(
+	const byte* src, byte* out, std::ptrdiff_t count, std::ptrdiff_t length, std::ptrdiff_t width,
+	byte* prefix, byte* suffix
+) {
+	const std::ptrdiff_t n = count + length - 1;
+	auto elem = [width](auto* base, std::ptrdiff_t i) { return base + i * width; };
+	
+	for(std::ptrdiff_t block_start = 0; block_start < n; block_start += length) {
+		std::ptrdiff_t block_end = std::min(block_start + length, n);
+		std::memcpy(elem(prefix, block_start), elem(src, block_start), width);
+		for(std::ptrdiff_t i = block_start + 1; i < block_end; ++i) {
+			std::memcpy(elem(prefix, i), elem(src, i), width);
+			combine_row_<Operation>(elem(prefix, i), elem(prefix, i - 1), width);
+		}
+		std::memcpy(elem(suffix, block_end - 1), elem(src, block_end - 1), width);
+		for(std::ptrdiff_t i = block_end - 2; i >= block_start; --i) {
+			std::memcpy(elem(suffix, i), elem(src, i), width);
+			combine_row_<Operation>(elem(suffix, i), elem(suffix, i + 1), width);
+		}
+	}
+	
+	for(std::ptrdiff_t i = 0; i < count; ++i) {
+		std::memcpy(elem(out, i), elem(suffix, i), width);
+		combine_row_<Operation>(elem(out, i), elem(prefix, i + length - 1), width);
+	}
+}
+
+
+/// Running operation over single-byte elements.
+/** Specialized version of running_operation_() with `width = 1`. */
+template<typename Operation>
+void running_operation_(const byte* src, byte* out, std::ptrdiff_t count, std::ptrdiff_t length, byte* prefix, byte* suffix) {
+	const std::ptrdiff_t n = count + length - 1;
+	for(std::ptrdiff_t block_start = 0; block_start < n; block_start += length) {
+		std::ptrdiff_t block_end = std::min(block_start + length, n);
+		prefix[block_start] = src[block_start];
+		for(std::ptrdiff_t i = block_start + 1; i < block_end; ++i)
+			prefix[i] = Operation::apply(prefix[i - 1], src[i]);
+		suffix[block_end - 1] = src[block_end - 1];
+		for(std::ptrdiff_t i = block_end - 2; i >= block_start; --i)
+			suffix[i] = Operation::apply(suffix[i + 1], src[i]);
+	}
+	for(std::ptrdiff_t i = 0; i < count; ++i) out[i] = Operation::apply(suffix[i], prefix[i + length - 1]);
+}
+
+
+/// Row-by-row morphology operation on mask.
+/** Input rows are normalized and padded with the neutral value. For each distinct segment length, the padded rows
+ ** get processed with the running operation, and the results are kept in a ring buffer indexed by (possibly outside)
+ ** row index. Each output row is then the combination of the kernel rows, each shifted by its segment start. */
+template<typename Operation>
+class morphology_operator_ {
+private:
+	const ndarray_view<2, const byte>& in_;
+	const ndarray_view<2, byte>& out_;
+	const morphology_kernel& kernel_;
+
+	std::ptrdiff_t height_, width_;
+	std::ptrdiff_t kernel_height_, kernel_width_;
+	std::ptrdiff_t margin_y_, margin_x_;
+	std::ptrdiff_t padded_width_;
+	
+	std::vector<byte> padded_rows_;
+	std::vector<std::ptrdiff_t> padded_row_indices_;
+	std::vector<byte> prefix_, suffix_;
+	std::vector<byte> acc_row_;
+	
+	struct ring_ {
+		std::ptrdiff_t length;
+		std::vector<byte> rows;
+		std::vector<std::ptrdiff_t> row_indices;
+	};
+	std::vector<ring_> rings_;
+	std::vector<std::ptrdiff_t> segment_rings_;
+
+	/// Normalized and padded input row \a y.
+	/** Rows are kept in a ring buffer, so that each input row gets read only once. */
+	const byte* padded_row_at_(std::ptrdiff_t y) {
+		std::ptrdiff_t slot = ((y % kernel_height_) + kernel_height_) % kernel_height_;
+		byte* row = padded_rows_.data() + slot * padded_width_;
+		if(padded_row_indices_[slot] == y) return row;
+		padded_row_indices_[slot] = y;
+		if(y < 0 || y >= height_) {
+			std::fill_n(row, padded_width_, Operation::neutral);
+			return row;
+		}
+		const byte* in_row = advance_raw_ptr(in_.start(), y * in_.strides()[0]);
+		const std::ptrdiff_t in_stride = in_.strides()[1];
+		std::fill_n(row, margin_x_, Operation::neutral);
+		for(std::ptrdiff_t x = 0; x < width_; ++x, in_row = advance_raw_ptr(in_row, in_stride))
+			row[margin_x_ + x] = (*in_row != 0 ? 0xff : 0x00);
+		std::fill_n(row + margin_x_ + width_, margin_x_, Operation::neutral);
+		return row;
+	}
+	
+	/// Padded row \a y processed with running operation of segment length of \a ring.
+	/** Element `x` of the returned row is the result over padded elements `x` to `x + length - 1`. */
+	const byte* ring_row_(ring_& ring, std::ptrdiff_t y) {
+		std::ptrdiff_t slot = ((y % kernel_height_) + kernel_height_) % kernel_height_;
+		byte* row = ring.rows.data() + slot * padded_width_;
+		if(ring.row_indices[slot] != y) {
+			running_operation_<Operation>(
+				padded_row_at_(y), row, padded_width_ - ring.length + 1, ring.length, prefix_.data(), suffix_.data()
+			);
+			ring.row_indices[slot] = y;
+		}
+		return row;
+	}
+	
+	void store_row_(const byte* row, std::ptrdiff_t y) {
+		byte* out_row = advance_raw_ptr(out_.start(), y * out_.strides()[0]);
+		const std::ptrdiff_t out_stride = out_.strides()[1];
+		if(out_stride == 1) std::memcpy(out_row, row, width_);
+		else for(std::ptrdiff_t x = 0; x < width_; ++x, out_row = advance_raw_ptr(out_row, out_stride)) *out_row = row[x];
+	}
+	
+	void run_segments_() {
+		for(const morphology_kernel::segment& seg : kernel_.segments()) {
+			auto ring_it = std::find_if(rings_.begin(), rings_.end(),
+				[&seg](const ring_& ring) { return ring.length == seg.length; });
+			if(ring_it == rings_.end()) {
+				ring_ ring;
+				ring.length = seg.length;
+				ring.rows.resize(kernel_height_ * padded_width_);
+				ring.row_indices.assign(kernel_height_, std::numeric_limits<std::ptrdiff_t>::min());
+				rings_.push_back(std::move(ring));
+				ring_it = rings_.end() - 1;
+			}
+			segment_rings_.push_back(ring_it - rings_.begin());
+		}
+		
+		const auto& segments = kernel_.segments();
+		for(std::ptrdiff_t y = 0; y < height_; ++y) {
+			// read last input row now: when operating in-place, output row y may overwrite input row y
+			padded_row_at_(y + margin_y_);
+			std::fill(acc_row_.begin(), acc_row_.end(), Operation::neutral);
+			for(std::size_t i = 0; i < segments.size(); ++i) {
+				const byte* row = ring_row_(rings_[segment_rings_[i]], y - margin_y_ + segments[i].row);
+				combine_row_<Operation>(acc_row_.data(), row + segments[i].start, width_);
+			}
+			store_row_(acc_row_.data(), y);
+		}
+	}
+	
+	void run_box_() {
+		// horizontal pass over all (padded) rows, then vertical pass with rows as elements
+		const std::ptrdiff_t rows_count = height_ + kernel_height_ - 1;
+		std::vector<byte> rows(rows_count * width_);
+		for(std::ptrdiff_t i = 0; i < rows_count; ++i)
+			running_operation_<Operation>(
+				padded_row_at_(i - margin_y_), rows.data() + i * width_, width_, kernel_width_,
+				prefix_.data(), suffix_.data()
+			);
+		
+		std::vector<byte> result(height_ * width_), row_prefix(rows.size()), row_suffix(rows.size());
+		running_operation_<Operation>(
+			rows.data(), result.data(), height_, kernel_height_, width_, row_prefix.data(), row_suffix.data()
+		);
+		for(std::ptrdiff_t y = 0; y < height_; ++y) store_row_(result.data() + y * width_, y);
+	}
+
+public:
+	morphology_operator_(
+		const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel
+	) :
+		in_(in), out_(out), kernel_(kernel),
+		height_(in.shape()[0]), width_(in.shape()[1]),
+		kernel_height_(kernel.shape()[0]), kernel_width_(kernel.shape()[1]),
+		margin_y_(kernel_height_ / 2), margin_x_(kernel_width_ / 2),
+		padded_width_(width_ + 2*margin_x_),
+		padded_rows_(kernel_height_ * padded_width_),
+		padded_row_indices_(kernel_height_, std::numeric_limits<std::ptrdiff_t>::min()),
+		prefix_(padded_width_),
+		suffix_(padded_width_),
+		acc_row_(width_) { }
+	
+	void run() {
+		if(kernel_.is_box()) run_box_();
+		else run_segments_();
+	}
+};
+
+
+template<typename Operation>
+void apply_morphology_(
+	const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel
+) {
+	Expects(in.shape() == out.shape());
+	if(in.shape().product() == 0) return;
+	morphology_operator_<Operation> op(in, out, kernel);
+	op.run();
+}
+
+}
+
+
+morphology_kernel::morphology_kernel(const ndarray_view<2, const bool>& kernel) :
+	shape_(kernel.shape())
+{
+	Expects(is_odd(shape_[0]) && is_odd(shape_[1]));
+	box_ = std::all_of(kernel.begin(), kernel.end(), [](bool b) { return b; });
+	const std::ptrdiff_t height = shape_[0], width = shape_[1];
+	for(std::ptrdiff_t y = 0; y < height; ++y) {
+		std::ptrdiff_t x = 0;
+		while(x < width) {
+			if(! kernel[y][x]) { ++x; continue; }
+			segment seg;
+			seg.row = y;
+			seg.start = x;
+			while(x < width && kernel[y][x]) ++x;
+			seg.length = x - seg.start;
+			segments_.push_back(seg);
+		}
+	}
+}
+
+
+morphology_kernel morphology_kernel::reflected() const {
+	morphology_kernel kernel = *this;
+	for(segment& seg : kernel.segments_) {
+		seg.row = shape_[0] - 1 - seg.row;
+		seg.start = shape_[1] - seg.start - seg.length;
+	}
+	return kernel;
+}
+
+
+void erode(const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel) {
+	apply_morphology_<erode_operation_>(in, out, kernel);
+}
+
+
+void dilate(const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel) {
+	apply_morphology_<dilate_operation_>(in, out, kernel.reflected());
+}
+
+
+void opening(const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel) {
+	erode(in, out, kernel);
+	dilate(out, out, kernel);
+}
+
+
+void closing(const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel) {
+	dilate(in, out, kernel);
+	erode(out, out, kernel);
+}
+
+
+}
@@ -0,0 +1,87 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_IMAGE_MORPHOLOGY_H_
+#define MF_IMAGE_MORPHOLOGY_H_
+
+#include "../common.h"
+#include "../nd/ndarray_view.h"
+#include "kernel.h"
+#include <vector>
+
+namespace mf {
+
+/// Structuring element for morphology operations on masks.
+/** Created from a \ref bool_image_kernel, such as \ref disk_image_kernel() or \ref box_image_kernel(). The kernel
+ ** gets decomposed into horizontal line segments, one for each run of set elements in a kernel row. Shape must be odd
+ ** in both axis. */
+class morphology_kernel {
+public:
+	/// Horizontal run of set elements in the kernel.
+	struct segment {
+		std::ptrdiff_t row; ///< Kernel row.
+		std::ptrdiff_t start; ///< Kernel column of first element.
+		std::ptrdiff_t length; ///< Number of elements.
+	};
+
+private:
+	ndsize<2> shape_;
+	std::vector<segment> segments_;
+	bool box_ = false;
+
+public:
+	explicit morphology_kernel(const ndarray_view<2, const bool>& kernel);
+
+	const ndsize<2>& shape() const { return shape_; }
+	const std::vector<segment>& segments() const { return segments_; }
+	
+	/// Return kernel mirrored on both axis.
+	morphology_kernel reflected() const;
+	
+	/// Check whether all elements are set.
+	/** Box kernels are processed with an algorithm whose cost does not depend on kernel size. */
+	bool is_box() const { return box_; }
+};
+
+
+/// Erode mask \a in with structuring element \a kernel, and write result into \a out.
+/** Masks elements are considered set when non-zero. Output elements are set to `0xff` or `0`. Elements outside the
+ ** mask are considered set, so that the mask does not get eroded from its border.
+ ** For box kernels, uses the van Herk/Gil-Werman algorithm for rows and columns, which needs 3 comparisons per element
+ ** and pass. Other kernels cost one pass per row of the kernel, with the segments being eroded using the same
+ ** algorithm. Rows are combined 8 elements at a time with word-level operations.
+ ** \a in and \a out may be the same view, but must otherwise not overlap. */
+void erode(const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel);
+
+/// Dilate mask \a in with structuring element \a kernel, and write result into \a out.
+/** Elements outside the mask are considered unset. Like \ref erode() otherwise. */
+void dilate(const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel);
+
+/// Morphological opening of mask \a in, i.e. erosion followed by dilation.
+/** Removes set regions smaller than the kernel. \a in and \a out may be the same view. */
+void opening(const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel);
+
+/// Morphological closing of mask \a in, i.e. dilation followed by erosion.
+/** Fills holes smaller than the kernel. \a in and \a out may be the same view. */
+void closing(const ndarray_view<2, const byte>& in, const ndarray_view<2, byte>& out, const morphology_kernel& kernel);
+
+}
+
+#endif
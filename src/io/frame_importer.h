@@ -47,7 +47,7 @@ public:
 
 	virtual ~frame_importer() { }
 	
-	const ndsize<Dim>& frame_shape() { return frame_shape_; }
+	const ndsize<Dim>& frame_shape() const { return frame_shape_; }
 	
 	virtual void read_frame(const frame_view_type&) = 0;
 	virtual bool reached_end() const = 0;
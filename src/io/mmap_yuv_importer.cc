@@ -0,0 +1,134 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "mmap_yuv_importer.h"
+#include "../os/memory.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace mf {
+
+mmap_yuv_importer::mmap_yuv_importer(const std::string& filename, const ndsize<2>& frame_shape, int sampling) :
+	base(frame_shape),
+	file_(filename)
+{
+	switch(sampling) {
+		case 444: chroma_scale_x_ = 1; chroma_scale_y_ = 1; break;
+		case 420: chroma_scale_x_ = 2; chroma_scale_y_ = 2; break;
+		default: throw std::invalid_argument("unknown YUV file chroma sampling format");
+	}
+	
+	luma_size_ = frame_shape[1] * frame_shape[0];
+	chroma_size_ = (frame_shape[1] / chroma_scale_x_) * (frame_shape[0] / chroma_scale_y_);
+	frame_size_ = luma_size_ + 2*chroma_size_;
+	
+	if(file_.size() > 0) set_memory_usage_advice(const_cast<byte*>(file_.data()), file_.size(), memory_usage_advice::sequential);
+}
+
+
+const byte* mmap_yuv_importer::frame_data_(time_unit t) const {
+	Expects(t >= 0 && t < total_duration());
+	return file_.data() + t * frame_size_;
+}
+
+
+ycbcr_plane_view_type mmap_yuv_importer::plane_
+(time_unit t, std::size_t offset, std::size_t scale_y, std::size_t scale_x) const {
+	const ndsize<2>& shape = base::frame_shape();
+	return ycbcr_plane_view_type(
+		reinterpret_cast<const std::uint8_t*>(frame_data_(t) + offset),
+		make_ndsize(shape[0] / scale_y, shape[1] / scale_x)
+	);
+}
+
+
+void mmap_yuv_importer::prefetch_(time_unit start_time) {
+	// only advise the frames which newly entered the prefetch window
+	time_unit end_time = std::min(start_time + prefetch_duration_, total_duration());
+	start_time = std::max(start_time, prefetched_end_time_);
+	if(start_time >= end_time) return;
+	prefetched_end_time_ = end_time;
+	
+	// madvise requires page aligned address
+	std::uintptr_t page_size = system_page_size();
+	std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(frame_data_(start_time));
+	std::uintptr_t end = reinterpret_cast<std::uintptr_t>(frame_data_(end_time - 1)) + frame_size_;
+	begin -= begin % page_size;
+	set_memory_usage_advice(reinterpret_cast<void*>(begin), end - begin, memory_usage_advice::will_need);
+}
+
+
+void mmap_yuv_importer::set_prefetch_duration(time_unit dur) {
+	Expects(dur >= 0);
+	prefetch_duration_ = dur;
+	prefetch_(current_time_);
+}
+
+
+ycbcr_plane_view_type mmap_yuv_importer::y_plane(time_unit t) const {
+	return plane_(t, 0, 1, 1);
+}
+
+
+ycbcr_plane_view_type mmap_yuv_importer::cb_plane(time_unit t) const {
+	return plane_(t, luma_size_, chroma_scale_y_, chroma_scale_x_);
+}
+
+
+ycbcr_plane_view_type mmap_yuv_importer::cr_plane(time_unit t) const {
+	return plane_(t, luma_size_ + chroma_size_, chroma_scale_y_, chroma_scale_x_);
+}
+
+
+void mmap_yuv_importer::read_frame(const ndarray_view<2, ycbcr_color>& out) {
+	if(out.shape() != base::frame_shape()) throw std::invalid_argument("output view has wrong shape");
+	
+	time_unit t = current_time_;
+	interleave_ycbcr_planes(y_plane(t), cb_plane(t), cr_plane(t), chroma_scale_y_, chroma_scale_x_, out);
+	
+	current_time_++;
+	prefetch_(current_time_);
+}
+
+
+bool mmap_yuv_importer::reached_end() const {
+	return (current_time_ >= total_duration() - 1);
+}
+
+
+time_unit mmap_yuv_importer::current_time() const {
+	return current_time_;
+}
+
+
+time_unit mmap_yuv_importer::total_duration() const {
+	return file_.size() / frame_size_;
+}
+	
+
+void mmap_yuv_importer::seek(time_unit t) {
+	Expects(t >= 0 && t <= total_duration());
+	current_time_ = t;
+	prefetched_end_time_ = t;
+	prefetch_(t);
+}
+
+
+}
@@ -0,0 +1,92 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_MMAP_YUV_IMPORTER_H_
+#define MF_MMAP_YUV_IMPORTER_H_
+
+#include "yuv_importer.h"
+#include "../color.h"
+#include "../io/seekable_frame_importer.h"
+#include "../nd/ndarray_view.h"
+#include "../os/mapped_file.h"
+
+namespace mf {
+
+/// Seekable frame importer which reads YUV file through memory mapping.
+/** The whole file is mapped into memory. The Y, Cb, Cr planes of each frame are available as views into the mapping
+ ** using y_plane(), cb_plane(), cr_plane(), for consumers that process planar data with no copy. read_frame()
+ ** interleaves the planes into a `ycbcr_color` view, reading directly from the mapping.
+ ** The mapping is marked for sequential access, and the OS is asked to read ahead the frames in the prefetch window,
+ ** which follows the last read frame.
+ ** The plane views are the zero-copy path. In a flow graph, \ref flow::importer_filter uses read_frame(), so each
+ ** frame still gets interleaved once into the output ring buffer of the node: flow nodes always output into their
+ ** own ring buffers. */
+class mmap_yuv_importer : public seekable_frame_importer<2, ycbcr_color> {
+	using base = seekable_frame_importer<2, ycbcr_color>;
+	
+private:
+	mapped_file file_;
+	std::size_t luma_size_;
+	std::size_t chroma_size_;
+	std::size_t frame_size_;
+	std::size_t chroma_scale_y_;
+	std::size_t chroma_scale_x_;
+	
+	time_unit current_time_ = 0;
+	time_unit prefetch_duration_ = 0;
+	time_unit prefetched_end_time_ = 0;
+	
+	const byte* frame_data_(time_unit t) const;
+	ycbcr_plane_view_type plane_(time_unit t, std::size_t offset, std::size_t scale_y, std::size_t scale_x) const;
+	void prefetch_(time_unit start_time);
+
+public:
+	mmap_yuv_importer(const std::string& filename, const ndsize<2>& frame_shape, int sampling);
+
+	/// Y plane of frame at time \a t, viewing into the file mapping.
+	ycbcr_plane_view_type y_plane(time_unit t) const;
+	
+	/// Cb plane of frame at time \a t, viewing into the file mapping.
+	ycbcr_plane_view_type cb_plane(time_unit t) const;
+	
+	/// Cr plane of frame at time \a t, viewing into the file mapping.
+	ycbcr_plane_view_type cr_plane(time_unit t) const;
+	
+	/// File mapping, which contains the frames one after the other.
+	const mapped_file& mapping() const { return file_; }
+	
+	/// Number of frames after the current frame which the OS is asked to read ahead.
+	time_unit prefetch_duration() const { return prefetch_duration_; }
+	
+	/// Set prefetch duration, and ask the OS to read ahead the frames of the new prefetch window.
+	void set_prefetch_duration(time_unit dur);
+	
+	void read_frame(const ndarray_view<2, ycbcr_color>&) override;
+	bool reached_end() const override;
+
+	time_unit current_time() const override;
+	time_unit total_duration() const override;
+	
+	void seek(time_unit) override;
+};
+	
+}
+
+#endif
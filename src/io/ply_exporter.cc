@@ -22,12 +22,59 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include <iomanip>
 #include <stdexcept>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 
 
 namespace mf {
 	
 namespace {
 	constexpr std::size_t vertex_count_string_length_ = 15;
+	constexpr std::size_t scalar_size_ = sizeof(Eigen_scalar);
+	
+	const point_xyz& xyz_(const point_xyz& pt) { return pt; }
+	const point_xyz& xyz_(const point_xyzrgb& pt) { return get<point_xyz>(pt); }
+	const point_xyz& xyz_(const point_full& pt) { return get<point_xyz>(pt); }
+	
+	/// Write binary vertex record with fields `x, y, z, nx, ny, nz, red, green, blue, weight` at \a out.
+	void pack_full_(char* out, const point_xyz& xyz, const Eigen_vec3& normal, const rgb_color& col, Eigen_scalar weight) {
+		std::memcpy(out, xyz.homogeneous_coordinates.data(), 3 * scalar_size_);
+		std::memcpy(out + 3*scalar_size_, normal.data(), 3 * scalar_size_);
+		std::memcpy(out + 6*scalar_size_, &col, 3);
+		std::memcpy(out + 6*scalar_size_ + 3, &weight, scalar_size_);
+	}
+	
+	void pack_(char* out, const point_xyz& pt, std::true_type) {
+		pack_full_(out, pt, Eigen_vec3::Zero(), rgb_color{255, 255, 255}, 1.0);
+	}
+	
+	void pack_(char* out, const point_xyzrgb& pt, std::true_type) {
+		pack_full_(out, xyz_(pt), Eigen_vec3::Zero(), pt.color(), 1.0);
+	}
+
+	void pack_(char* out, const point_full& pt, std::true_type) {
+		pack_full_(out, xyz_(pt), pt.normal(), pt.color(), pt.weight());
+	}
+	
+	/// Write binary vertex record with fields `x, y, z` at \a out.
+	template<typename Point>
+	void pack_(char* out, const Point& pt, std::false_type) {
+		std::memcpy(out, xyz_(pt).homogeneous_coordinates.data(), 3 * scalar_size_);
+	}
+	
+	/// Pack records of the non-null points of \a arr at \a out, and return number of records.
+	/** Every record gets written, but the output position only advances for non-null points. This avoids
+	 ** unpredictable branches when null and non-null points are interleaved. \a out must have space for
+	 ** `arr.size() + 1` records. */
+	template<typename Point, typename Full>
+	std::size_t pack_records_(char* out, const ndarray_view<1, const Point>& arr, std::size_t record_size, Full full) {
+		char* position = out;
+		for(const Point& pt : arr) {
+			pack_(position, pt, full);
+			position += record_size * std::size_t(! xyz_(pt).is_null());
+		}
+		return (position - out) / record_size;
+	}
 }
 
 ply_exporter::ply_exporter(const std::string& filename, bool full, bool ascii, line_delimitor ld) :
@@ -68,6 +115,8 @@ ply_exporter::ply_exporter(const std::string& filename, bool full, bool ascii, l
 	}
 	
 	write_line_("end_header");
+	
+	if(! ascii_) staging_buffer_.reset(new char[staging_buffer_capacity]);
 }
 
 
@@ -77,6 +126,10 @@ ply_exporter::~ply_exporter() {
 
 
 void ply_exporter::close() {
+	if(! file_.is_open()) return;
+	
+	flush_staging_buffer_();
+	
 	// write vertex count to file
 	file_.seekp(vertex_count_string_position_);
 	file_ << std::setfill(' ') << std::left << std::setw(vertex_count_string_length_) << count_;
@@ -87,49 +140,35 @@ void ply_exporter::close() {
 
 
 void ply_exporter::write(const ndarray_view<1, const point_xyz>& arr) {
-	count_ += arr.size();
-	if(full_)
-		for(const point_xyz& pt : arr) {
-			point_full full_pt(pt);
-			if(ascii_) write_ascii_(full_pt);
-			else write_binary_(full_pt);
-		}
-	else
-		for(const point_xyz& pt : arr) {
-			if(ascii_) write_ascii_(pt);
-			else write_binary_(pt);
-		}
+	if(! ascii_) {
+		write_binary_(arr);
+	} else if(full_) {
+		for(const point_xyz& pt : arr) if(! pt.is_null()) write_ascii_(point_full(pt));
+	} else {
+		for(const point_xyz& pt : arr) if(! pt.is_null()) write_ascii_(pt);
+	}
 }
 
 
 void ply_exporter::write(const ndarray_view<1, const point_xyzrgb>& arr) {
-	count_ += arr.size();
-	if(full_)
-		for(const point_xyzrgb& pt : arr) {
-			point_full full_pt(pt);
-			if(ascii_) write_ascii_(full_pt);
-			else write_binary_(full_pt);
-		}
-	else
-		for(const point_xyzrgb& pt : arr) {
-			if(ascii_) write_ascii_(get<point_xyz>(pt));
-			else write_binary_(get<point_xyz>(pt));
-		}
+	if(! ascii_) {
+		write_binary_(arr);
+	} else if(full_) {
+		for(const point_xyzrgb& pt : arr) if(! xyz_(pt).is_null()) write_ascii_(point_full(pt));
+	} else {
+		for(const point_xyzrgb& pt : arr) if(! xyz_(pt).is_null()) write_ascii_(xyz_(pt));
+	}
 }
 
 
 void ply_exporter::write(const ndarray_view<1, const point_full>& arr) {
-	count_ += arr.size();
-	if(full_)
-		for(const point_full& pt : arr) {
-			if(ascii_) write_ascii_(pt);
-			else write_binary_(pt);
-		}
-	else
-		for(const point_full& pt : arr) {
-			if(ascii_) write_ascii_(get<point_xyz>(pt));
-			else write_binary_(get<point_xyz>(pt));
-		}
+	if(! ascii_) {
+		write_binary_(arr);
+	} else if(full_) {
+		for(const point_full& pt : arr) if(! xyz_(pt).is_null()) write_ascii_(pt);
+	} else {
+		for(const point_full& pt : arr) if(! xyz_(pt).is_null()) write_ascii_(xyz_(pt));
+	}
 }
 
 
@@ -138,8 +177,44 @@ void ply_exporter::write_line_(const std::string& ln) {
 }
 
 
-void ply_exporter::write_binary_(const point_xyz& p) {
-	file_.write(reinterpret_cast<const char*>( p.position().data() ), 3 * sizeof(Eigen_scalar));
+std::size_t ply_exporter::binary_record_size_() const {
+	if(full_) return 7*scalar_size_ + 3;
+	else return 3*scalar_size_;
+}
+
+
+template<typename Point>
+void ply_exporter::write_binary_(const ndarray_view<1, const Point>& arr) {
+	const std::size_t record_size = binary_record_size_();
+	// one spare record for the compaction in pack_records_()
+	const std::size_t chunk_capacity = staging_buffer_capacity / record_size - 1;
+	
+	const std::ptrdiff_t count = arr.size();
+	std::ptrdiff_t start = 0;
+	while(start < count) {
+		std::size_t free_count = chunk_capacity - staging_buffer_size_ / record_size;
+		if(free_count == 0) {
+			flush_staging_buffer_();
+			continue;
+		}
+		std::ptrdiff_t end = std::min<std::ptrdiff_t>(start + free_count, count);
+		
+		char* out = staging_buffer_.get() + staging_buffer_size_;
+		std::size_t written_count;
+		if(full_) written_count = pack_records_(out, arr(start, end), record_size, std::true_type());
+		else written_count = pack_records_(out, arr(start, end), record_size, std::false_type());
+		
+		staging_buffer_size_ += written_count * record_size;
+		count_ += written_count;
+		start = end;
+	}
+}
+
+
+void ply_exporter::flush_staging_buffer_() {
+	if(staging_buffer_size_ == 0) return;
+	file_.write(staging_buffer_.get(), staging_buffer_size_);
+	staging_buffer_size_ = 0;
 }
 
 
@@ -147,19 +222,7 @@ void ply_exporter::write_ascii_(const point_xyz& p) {
 	Eigen_vec3 position = p.position();	
 	file_ << position[0] << ' ' << position[1] << ' ' << position[2];
 	end_line(file_, line_delimitor_);
-}
-
-
-void ply_exporter::write_binary_(const point_full& p) {
-	Eigen_vec3 position = p.position();
-	Eigen_vec3 normal = p.normal();
-	Eigen_scalar weight = p.weight();
-	rgb_color col = p.color();
-	
-	file_.write(reinterpret_cast<const char*>( position.data() ), 3 * sizeof(Eigen_scalar));
-	file_.write(reinterpret_cast<const char*>( normal.data() ), 3 * sizeof(Eigen_scalar));
-	file_.write(reinterpret_cast<const char*>( &col ), 3);
-	file_.write(reinterpret_cast<const char*>( &weight ), sizeof(Eigen_scalar));
+	++count_;
 }
 
 
@@ -174,6 +237,7 @@ void ply_exporter::write_ascii_(const point_full& p) {
 		<< ' ' << (unsigned)col.r << ' ' << (unsigned)col.g << ' ' << (unsigned)col.b
 		<< ' ' << weight;
 	end_line(file_, line_delimitor_);
+	++count_;
 }
 
 
@@ -20,6 +20,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 
 #include <fstream>
 #include <string>
+#include <memory>
 #include "../point_cloud/point.h"
 #include "../utility/io.h"
 #include "../nd/ndarray_view.h"
@@ -27,7 +28,9 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 namespace mf {
 
 /// Exports point cloud into PLY file.
-/** Can generate binary or ASCII format, and either only XYZ coordinates or with color, weight and normals. */
+/** Can generate binary or ASCII format, and either only XYZ coordinates or with color, weight and normals.
+ ** Null points are skipped. In binary format, the vertex records are packed into a staging buffer, which gets written
+ ** to the file with one call when full. */
 class ply_exporter {
 private:
 	std::ofstream file_;
@@ -37,12 +40,17 @@ private:
 	const line_delimitor line_delimitor_;
 	bool full_;
 	bool ascii_;
+	
+	std::unique_ptr<char[]> staging_buffer_;
+	std::size_t staging_buffer_size_ = 0;
 		
 	void write_line_(const std::string& ln);
 	
-	void write_binary_(const point_xyz&);
+	std::size_t binary_record_size_() const;
+	template<typename Point> void write_binary_(const ndarray_view<1, const Point>&);
+	void flush_staging_buffer_();
+
 	void write_ascii_(const point_xyz&);
-	void write_binary_(const point_full&);
 	void write_ascii_(const point_full&);
 
 
@@ -55,9 +63,14 @@ public:
 	);
 	~ply_exporter();
 	
+	/// Size of staging buffer for binary format, in bytes.
+	static constexpr std::size_t staging_buffer_capacity = 4 * 1024 * 1024;
+	
 	void write(const ndarray_view<1, const point_xyz>&);
 	void write(const ndarray_view<1, const point_xyzrgb>&);
 	void write(const ndarray_view<1, const point_full>&);
+	
+	/// Write buffered data, and write vertex count into header. Called by destructor.
 	void close();
 };
 
@@ -18,71 +18,130 @@ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER I
 OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-/*
 #include "ply_importer.h"
+#include "../os/memory.h"
+#include "../os/worker_pool.h"
+#include "../utility/string.h"
+#include "../exceptions.h"
 #include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
 
 namespace mf {
 
-template<typename Point>
-void ply_importer::read_ascii_(Point* buffer, std::size_t n) {
-	std::string line;
-	std::vector<const char*> properties(number_of_properties_, nullptr);
+namespace {
+	/// Read binary property of type \a T at \a data, possibly with flipped endianness.
+	/** Vertex records in the file are packed, so \a data need not be aligned. */
+	template<typename T, bool Flip>
+	Eigen_scalar read_property_(const byte* data) {
+		T value;
+		std::memcpy(&value, data, sizeof(T));
+		if(Flip) flip_endianness(value);
+		return static_cast<Eigen_scalar>(value);
+	}
 	
-	while(n--) {
-		read_line_(line);
-				
-		auto property = properties.begin();
+	template<typename T>
+	Eigen_scalar(*select_read_property_(bool flip))(const byte*) {
+		if(flip) return &read_property_<T, true>;
+		else return &read_property_<T, false>;
+	}
+	
+	bool is_space_(char c) {
+		return (c == ' ' || c == '\t');
+	}
+	
+	bool is_digit_(char c) {
+		return (c >= '0' && c <= '9');
+	}
+	
+	/// Parse decimal number in `[begin, end[`, which must be one whole token.
+	/** Mantissas of up to 19 digits with a resulting value exactly representable as `double`, and a decimal exponent
+	 ** of magnitude at most 22, are converted using one exact multiplication or division, which is correctly rounded.
+	 ** Other tokens (long mantissas, large exponents, `inf`, `nan`) fall back to `std::strtod`. */
+	double parse_scalar_(const char* begin, const char* end) {
+		static const double powers_of_ten[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		constexpr std::uint64_t max_exact_mantissa = std::uint64_t(1) << 53;
+		
+		const char* pos = begin;
+		bool negative = false;
+		if(pos != end && (*pos == '-' || *pos == '+')) negative = (*(pos++) == '-');
 		
-		bool last_space = true;
-		for(const char& c : line) {
-			bool space = std::isspace(c);
-			if(last_space == space) continue;
-			else if(last_space) *(property++) = &c;
-			last_space = space;
+		std::uint64_t mantissa = 0;
+		int digits = 0, exponent = 0;
+		bool any_digit = false;
+		for(; pos != end && is_digit_(*pos); ++pos, any_digit = true) {
+			if(mantissa == 0 && *pos == '0') continue;
+			mantissa = 10*mantissa + (*pos - '0');
+			++digits;
+		}
+		if(pos != end && *pos == '.') {
+			for(++pos; pos != end && is_digit_(*pos); ++pos, any_digit = true) {
+				if(mantissa == 0 && *pos == '0') { --exponent; continue; }
+				mantissa = 10*mantissa + (*pos - '0');
+				++digits;
+				--exponent;
+			}
+		}
+		if(any_digit && pos != end && (*pos == 'e' || *pos == 'E')) {
+			++pos;
+			bool negative_exponent = false;
+			if(pos != end && (*pos == '-' || *pos == '+')) negative_exponent = (*(pos++) == '-');
+			int exp = 0;
+			for(; pos != end && is_digit_(*pos) && exp < 10000; ++pos) exp = 10*exp + (*pos - '0');
+			exponent += (negative_exponent ? -exp : exp);
 		}
 		
-		read_ascii_point_(*buffer, properties.data());
-		++buffer;
+		if(any_digit && pos == end && digits <= 19 && mantissa <= max_exact_mantissa && exponent >= -22 && exponent <= 22) {
+			double value = static_cast<double>(mantissa);
+			if(exponent < 0) value /= powers_of_ten[-exponent];
+			else value *= powers_of_ten[exponent];
+			return (negative ? -value : value);
+		}
+		
+		// Fall back for other cases. File data is not null-terminated, so copy the token.
+		char token[64];
+		std::size_t length = std::min<std::size_t>(end - begin, sizeof(token) - 1);
+		std::memcpy(token, begin, length);
+		token[length] = '\0';
+		return std::strtod(token, nullptr);
 	}
 }
 
 
-template<typename Point>
-void ply_importer::read_binary_(Point* out, std::size_t n) {
-	std::streamsize length = n * vertex_length_;
-	std::unique_ptr<char[]> buffer(new char[length]);
-	file_.read(buffer.get(), length);
-	
-	char* buffer_end = buffer.get() + length;
-	for(char* in = buffer.get(); in != buffer_end; in += vertex_length_, ++out)
-		read_binary_point_(*out, in);
+constexpr std::size_t ply_importer::ascii_chunk_lines_;
+
+
+std::size_t ply_importer::line_end_(std::size_t offset) const {
+	const char* begin = chars_(offset);
+	const char* end = chars_(file_.size());
+	char delim = (line_delimitor_ == line_delimitor::CR ? '\r' : '\n');
+	const char* pos = static_cast<const char*>(std::memchr(begin, delim, end - begin));
+	if(pos == nullptr) return file_.size();
+	if(line_delimitor_ == line_delimitor::CRLF && pos != begin && *(pos - 1) == '\r') --pos;
+	return pos - chars_();
 }
 
 
-template<typename T>
-T ply_importer::read_binary_property_(const property& prop, char* data) const {
-	std::size_t sz = property_type_size_(prop.type);
-	data += prop.offset;
-	if(! is_host_endian_binary_()) flip_endianness(data, sz);
-	switch(prop.type) {
-		case int8:   return static_cast<T>( *reinterpret_cast<const std::int8_t*>(data) );
-		case uint8:  return static_cast<T>( *reinterpret_cast<const std::uint8_t*>(data) );
-		case int16:  return static_cast<T>( *reinterpret_cast<const std::int16_t*>(data) );
-		case uint16: return static_cast<T>( *reinterpret_cast<const std::uint16_t*>(data) );
-		case int32:  return static_cast<T>( *reinterpret_cast<const std::int32_t*>(data) );
-		case uint32: return static_cast<T>( *reinterpret_cast<const std::uint32_t*>(data) );
-		default: break;
-	}
-	if(host_has_iec559_float) switch(prop.type) {
-		case float32: return static_cast<T>( *reinterpret_cast<const float*>(data) );
-		case float64: return static_cast<T>( *reinterpret_cast<const double*>(data) );
-		default: break;
-	}
-	return T();
+std::size_t ply_importer::next_line_(std::size_t offset) const {
+	char delim = (line_delimitor_ == line_delimitor::CR ? '\r' : '\n');
+	const char* pos = static_cast<const char*>(std::memchr(chars_(offset), delim, file_.size() - offset));
+	if(pos == nullptr) return file_.size();
+	else return pos - chars_() + 1;
 }
 
 
+std::string ply_importer::read_line_(std::size_t& offset) const {
+	if(offset >= file_.size()) throw ply_importer_error("Unexpected end of PLY file");
+	std::size_t end = line_end_(offset);
+	std::string line(chars_(offset), end - offset);
+	offset = next_line_(offset);
+	return line;
+}
+
 
 ply_importer::property_type ply_importer::identify_property_type_(const std::string& nm) {
 	if(nm == "char" || nm == "int8") return int8;
@@ -98,39 +157,69 @@ ply_importer::property_type ply_importer::identify_property_type_(const std::str
 }
 
 
-ply_importer::property* ply_importer::identify_property_(const std::string& nm_orig) {
+ply_importer::property_field ply_importer::identify_field_(const std::string& nm_orig) {
 	std::string nm = to_lower(nm_orig);
-	if(nm == "x") return &x_;
-	else if(nm == "y") return &y_;
-	else if(nm == "z") return &z_;
-	else if(nm == "nx") return &nx_;
-	else if(nm == "ny") return &ny_;
-	else if(nm == "nz") return &nz_;
-	else if(nm == "r" || nm == "red") return &r_;
-	else if(nm == "g" || nm == "green") return &g_;
-	else if(nm == "b" || nm == "blue") return &b_;
-	else if(nm == "weight") return &w_;
-	else return nullptr;
+	if(nm == "x") return x;
+	else if(nm == "y") return y;
+	else if(nm == "z") return z;
+	else if(nm == "nx") return nx;
+	else if(nm == "ny") return ny;
+	else if(nm == "nz") return nz;
+	else if(nm == "r" || nm == "red") return red;
+	else if(nm == "g" || nm == "green") return green;
+	else if(nm == "b" || nm == "blue") return blue;
+	else if(nm == "weight") return weight;
+	else return fields_count;
+}
+
+
+std::size_t ply_importer::property_type_size_(property_type t) {
+	switch(t) {
+		case int8:  case uint8:  return 1;
+		case int16: case uint16: return 2;
+		case int32: case uint32: return 4;
+		case float32: return 4;
+		case float64: return 8;
+		default: return 0;
+	}
+}
+
+
+auto ply_importer::read_property_function_(property_type t) const -> read_property_function* {
+	bool flip = ! is_host_endian_binary_();
+	switch(t) {
+		case int8:   return select_read_property_<std::int8_t>(flip);
+		case uint8:  return select_read_property_<std::uint8_t>(flip);
+		case int16:  return select_read_property_<std::int16_t>(flip);
+		case uint16: return select_read_property_<std::uint16_t>(flip);
+		case int32:  return select_read_property_<std::int32_t>(flip);
+		case uint32: return select_read_property_<std::uint32_t>(flip);
+		default: break;
+	}
+	if(! host_has_iec559_float) throw ply_importer_error("Host floating point format not supported.");
+	switch(t) {
+		case float32: return select_read_property_<float>(flip);
+		case float64: return select_read_property_<double>(flip);
+		default: throw ply_importer_error("Unsupported property type.");
+	}
 }
 
 
 void ply_importer::read_header_() {
-	std::string line;
-		
-	std::ifstream::pos_type data_start = 0; // File offset where data starts (aka after 'end_header').
+	std::size_t offset = 0; // Current file offset.
+	std::size_t data_start = 0; // File offset where data starts (aka after 'end_header').
 	std::size_t number_of_elements_before_vertex_data = 0; // Number of data entries before start of vertex data. (for ascii, number of lines)
-	std::ifstream::off_type vertex_data_start_offset = 0; // Number of bytes before start of vertex data. (for ascii, determined in postprocessing)
+	std::size_t vertex_data_start_offset = 0; // Number of bytes before start of vertex data. (for binary)
 		
 	std::ptrdiff_t vertex_property_index = 0; // Index of current vertex property.
 	std::ptrdiff_t vertex_property_data_offset = 0; // Data offset of current vertex property for binary.
-
+	std::vector<property_field> vertex_property_fields; // Field of each vertex property, or fields_count.
 
 	// First line must be 'ply'.
-	read_line_(line);
-	if(line != "ply") throw ply_importer_error("Not PLY file (First line not 'ply')");
+	if(read_line_(offset) != "ply") throw ply_importer_error("Not PLY file (First line not 'ply')");
 	
 	// Second line must indicate format.
-	read_line_(line);
+	std::string line = read_line_(offset);
 	if(line == "format binary_little_endian 1.0") format_ = binary_little_endian;
 	else if(line == "format binary_big_endian 1.0") format_ = binary_big_endian;
 	else if(line == "format ascii 1.0") format_ = ascii;
@@ -142,16 +231,17 @@ void ply_importer::read_header_() {
 	//       after_vertex: Skip other defitions after it, until end of header.
 	enum { before_vertex_definition, within_vertex_definition, after_vertex_definition } state = before_vertex_definition;
 	std::size_t number_of_elements = 0; // Number of elements of current type.
-	do {
-		read_line_(line);
+	while(data_start == 0) {
+		line = read_line_(offset);
 		
 		if(line.substr(0, 8) == "comment ") continue; // Skip comments.
 		if(line.substr(0, 9) == "obj_info ") continue;
 		
 		if(line.substr(0, 8) == "element ") { // Read element definition start.
 			auto pos = line.find(' ', 8);
+			if(pos == std::string::npos) throw ply_importer_error("Invalid element definition: " + line);
 			std::string element = line.substr(8, pos-8);
-			number_of_elements = stoul(line.substr(pos + 1)); // Number of elements.
+			number_of_elements = std::stoul(line.substr(pos + 1)); // Number of elements.
 			if(element == "vertex") {
 				// Vertex definitions start.
 				if(state != before_vertex_definition) throw ply_importer_error("More than one vertex element definitions.");
@@ -171,9 +261,10 @@ void ply_importer::read_header_() {
 			
 			// Data type and property name
 			auto pos = line.find(' ', 9);
+			if(pos == std::string::npos) throw ply_importer_error("Invalid property definition: " + line);
 			std::string name = line.substr(pos + 1);
 			property_type type = identify_property_type_(line.substr(9, pos-9));
-			if(type == list) throw ply_importer_error("List property type not supported.");			
+			if(type == list) throw ply_importer_error("List property type not supported.");
 			std::size_t type_size = property_type_size_(type);
 			
 			if(is_binary() && state == before_vertex_definition) {
@@ -181,15 +272,16 @@ void ply_importer::read_header_() {
 				vertex_data_start_offset += number_of_elements * type_size;
 				
 			} else if(state == within_vertex_definition) {
-				// When withnin vertex definition, capture XYZRGB data offsets.
-				property* prop = identify_property_(name);
-				if(prop) {
-					// Store data offset (for binary) and index (for ascii) of property
-					// If prop==null, unknown property
-					prop->type = type;
-					prop->offset = vertex_property_data_offset;
-					prop->index = vertex_property_index;
+				// When withnin vertex definition, capture data offsets of known fields.
+				property_field field = identify_field_(name);
+				if(field != fields_count) {
+					property& prop = properties_[field];
+					prop.type = type;
+					prop.offset = vertex_property_data_offset;
+					prop.index = vertex_property_index;
 				}
+				vertex_property_fields.push_back(field);
+				
 				// Increment data offset and index
 				vertex_property_data_offset += type_size;
 				++vertex_property_index;
@@ -197,164 +289,218 @@ void ply_importer::read_header_() {
 			
 		} else if(line.substr(0, 10) == "end_header") { // End of header; data follows.
 			if(state == before_vertex_definition) throw ply_importer_error("No vertex element definition.");
-			data_start = file_.tellg(); // Start of data.
+			data_start = offset; // Start of data.
 
-		} else if(! std::all_of(line.begin(), line.end(), isspace)) {
+		} else if(! std::all_of(line.begin(), line.end(), [](char c) { return std::isspace(c); })) {
 			// Invalid line, not all whitespace.
 			throw ply_importer_error("Invalid line encountered: " + line);
 		}
-	} while(! data_start);
+	}
 	
-	if(!x_ || !y_ || !z_) throw ply_importer_error("X, Y, Z coordinate properties not defined.");
-	has_rgb_ = (r_ && g_ && b_);
-	has_normal_ = (nx_ && ny_ && nz_);
-	has_weight_ = (bool)w_;
+	if(!properties_[x] || !properties_[y] || !properties_[z])
+		throw ply_importer_error("X, Y, Z coordinate properties not defined.");
+	has_rgb_ = (properties_[red] && properties_[green] && properties_[blue]);
+	has_normal_ = (properties_[nx] && properties_[ny] && properties_[nz]);
+	has_weight_ = (bool)properties_[weight];
 		
 	vertex_length_ = vertex_property_data_offset;
 	number_of_properties_ = vertex_property_index;
 	
 	if(is_binary()) {
-		// Directly calculate vertex data start
+		// Directly calculate vertex data start, and verify that file contains all vertex records.
 		vertex_data_start_ = data_start + vertex_data_start_offset;
+		if(vertex_data_start_ + number_of_vertices_ * vertex_length_ > file_.size())
+			throw ply_importer_error("PLY file truncated.");
 	} else {
 		// Byte offset unknown, need to skip lines (of variable lengths) to it.
-		skip_lines_(number_of_elements_before_vertex_data);
-		vertex_data_start_ = file_.tellg();
+		offset = data_start;
+		for(std::size_t i = 0; i < number_of_elements_before_vertex_data; ++i) offset = next_line_(offset);
+		vertex_data_start_ = offset;
+		
+		// Field of each property on ASCII line.
+		// Incomplete fields (e.g. only nx, ny) are not read.
+		for(property_field field : vertex_property_fields) {
+			bool read = (field != fields_count);
+			if(field >= nx && field <= nz) read = has_normal_;
+			else if(field >= red && field <= blue) read = has_rgb_;
+			ascii_fields_.push_back(read ? field : -1);
+		}
 	}
 }
 
 
-void ply_importer::rewind() {
-	file_.seekg(vertex_data_start_);
-	current_element_ = 0;
+void ply_importer::compile_plan_() {
+	if(! is_binary()) return;
+	
+	auto add_step = [&](std::vector<plan_step>& plan, property_field field) {
+		const property& prop = properties_[field];
+		plan.push_back(plan_step { field, prop.offset, read_property_function_(prop.type) });
+	};
+
+	// Position is read as one block if the X, Y, Z properties are consecutive and have the layout of Eigen_scalar.
+	property_type scalar_type = (sizeof(Eigen_scalar) == 8 ? float64 : float32);
+	bool position_block =
+		is_host_endian_binary_() && host_has_iec559_float &&
+		properties_[x].type == scalar_type && properties_[y].type == scalar_type && properties_[z].type == scalar_type &&
+		properties_[y].offset == properties_[x].offset + std::ptrdiff_t(sizeof(Eigen_scalar)) &&
+		properties_[z].offset == properties_[y].offset + std::ptrdiff_t(sizeof(Eigen_scalar));
+	if(! position_block) for(property_field field : { x, y, z }) add_step(position_plan_, field);
+	
+	if(has_normal_) for(property_field field : { nx, ny, nz }) add_step(attributes_plan_, field);
+	if(has_rgb_) for(property_field field : { red, green, blue }) add_step(attributes_plan_, field);
+	if(has_weight_) add_step(attributes_plan_, weight);
 }
 
 
-ply_importer::ply_importer(const char* filename, line_delimitor ld) :
-file_(filename, std::ios_base::in | std::ios_base::binary),
-line_delimitor_(ld != line_delimitor::unknown ? ld : detect_line_delimitor(file_)) {
-	read_header_();	
-	rewind();
+auto ply_importer::default_field_values_() const -> field_values {
+	field_values values;
+	values.fill(0.0);
+	values[red] = values[green] = values[blue] = 255.0;
+	values[weight] = 1.0;
+	return values;
 }
 
 
-std::size_t ply_importer::property_type_size_(property_type t) {
-	switch(t) {
-		case int8:  case uint8:  return 1;
-		case int16: case uint16: return 2;
-		case int32: case uint32: return 4;
-		case float32: return 4;
-		case float64: return 8;
-		default: return 0;
-	}
+void ply_importer::set_point_(point_xyz& pt, const field_values& values) {
+	pt.homogeneous_coordinates = Eigen_vec4(values[x], values[y], values[z], 1.0);
 }
 
 
-void ply_importer::read_ascii_point_(point_xyz& pt, const char* props[]) const {	
-	pt = point_xyz(
-		strtof(props[x_.index], nullptr),
-		strtof(props[y_.index], nullptr),
-		strtof(props[z_.index], nullptr)	
-	);
+void ply_importer::set_point_(point_full& pt, const field_values& values) {
+	set_point_(get<point_xyz>(pt), values);
+	set_attributes_(pt, values);
 }
 
 
+void ply_importer::set_attributes_(point_full& pt, const field_values& values) {
+	pt.normal() = Eigen_vec3(values[nx], values[ny], values[nz]);
+	pt.color() = rgb_color(values[red], values[green], values[blue]);
+	pt.weight() = values[weight];
+}
+
 
-void ply_importer::read_ascii_point_(point_full& pt, const char* props[]) const {
-	if(has_rgb_) pt = point_full(
-		strtof(props[x_.index], nullptr),
-		strtof(props[y_.index], nullptr),
-		strtof(props[z_.index], nullptr),
-		rgb_color(
-			strtol(props[r_.index], nullptr, 10),
-			strtol(props[g_.index], nullptr, 10),
-			strtol(props[b_.index], nullptr, 10)
-		)
-	);
-	else pt = point_xyz(
-		strtof(props[x_.index], nullptr),
-		strtof(props[y_.index], nullptr),
-		strtof(props[z_.index], nullptr)	
-	);
-	if(has_normal_) pt.set_normal(Eigen::Vector3f(
-		strtof(props[nx_.index], nullptr),
-		strtof(props[ny_.index], nullptr),
-		strtof(props[nz_.index], nullptr)
-	));
-	if(has_weight_) strtof(props[w_.index], nullptr);
+void ply_importer::read_binary_position_(Eigen_vec4& hc, const byte* record) const {
+	if(position_plan_.empty())
+		std::memcpy(hc.data(), record + properties_[x].offset, 3 * sizeof(Eigen_scalar));
+	else for(const plan_step& step : position_plan_)
+		hc[step.field] = step.read(record + step.offset);
+	hc[3] = 1.0;
 }
 
 
-void ply_importer::read_binary_point_(point_xyz& pt, char* data) const {
-	pt = point_xyz(
-		read_binary_property_<float>(x_, data),
-		read_binary_property_<float>(y_, data),
-		read_binary_property_<float>(z_, data)
-	);
+void ply_importer::read_binary_(point_xyz* out, std::size_t n) {
+	const byte* record = file_.data() + vertex_data_start_ + current_element_ * vertex_length_;
+	for(std::size_t i = 0; i < n; ++i, ++out, record += vertex_length_)
+		read_binary_position_(out->homogeneous_coordinates, record);
 }
 
 
-void ply_importer::read_binary_point_(point_full& pt, char* data) const {
-	if(has_rgb_) pt = point_full(
-		read_binary_property_<float>(x_, data),
-		read_binary_property_<float>(y_, data),
-		read_binary_property_<float>(z_, data),
-		rgb_color(
-			read_binary_property_<std::uint8_t>(r_, data),
-			read_binary_property_<std::uint8_t>(g_, data),
-			read_binary_property_<std::uint8_t>(b_, data)
-		)
-	);
-	else pt = point_xyz(
-		read_binary_property_<float>(x_, data),
-		read_binary_property_<float>(y_, data),
-		read_binary_property_<float>(z_, data)
-	);
-	if(has_normal_) pt.set_normal(Eigen::Vector3f(
-		read_binary_property_<float>(nx_, data),
-		read_binary_property_<float>(ny_, data),
-		read_binary_property_<float>(nz_, data)
-	));
-	if(has_weight_) pt.set_weight(read_binary_property_<float>(w_, data));
+void ply_importer::read_binary_(point_full* out, std::size_t n) {
+	const byte* record = file_.data() + vertex_data_start_ + current_element_ * vertex_length_;
+	const field_values defaults = default_field_values_();
+	for(std::size_t i = 0; i < n; ++i, ++out, record += vertex_length_) {
+		read_binary_position_(get<point_xyz>(*out).homogeneous_coordinates, record);
+		field_values values = defaults;
+		for(const plan_step& step : attributes_plan_)
+			values[step.field] = step.read(record + step.offset);
+		set_attributes_(*out, values);
+	}
 }
 
 
-void ply_importer::read(point_xyz* buffer, std::size_t n) {
-	if(current_element_ + n > number_of_vertices_)
-		throw ply_importer_error("Attempted to read beyond bounds.");
-	
-	if(is_ascii()) read_ascii_(buffer, n);
-	else read_binary_(buffer, n);
-	
-	current_element_ += n;
+void ply_importer::parse_ascii_line_(const char* begin, const char* end, field_values& values) const {
+	const char* pos = begin;
+	for(std::ptrdiff_t field : ascii_fields_) {
+		while(pos != end && is_space_(*pos)) ++pos;
+		if(pos == end) throw ply_importer_error("Missing property on ASCII vertex line.");
+		const char* token_end = pos;
+		while(token_end != end && ! is_space_(*token_end)) ++token_end;
+		
+		if(field != -1) values[field] = parse_scalar_(pos, token_end);
+		pos = token_end;
+	}
+}
+
+
+template<typename Point>
+void ply_importer::read_ascii_chunk_(Point* out, std::size_t n, std::size_t offset) const {
+	const field_values defaults = default_field_values_();
+	for(std::size_t i = 0; i < n; ++i, ++out) {
+		std::size_t end = line_end_(offset);
+		field_values values = defaults;
+		parse_ascii_line_(chars_(offset), chars_(end), values);
+		set_point_(*out, values);
+		offset = next_line_(offset);
+	}
 }
 
 
-void ply_importer::read(point_full* buffer, std::size_t n) {
-	if(current_element_ + n > number_of_vertices_)
-		throw ply_importer_error("Attempted to read beyond bounds.");
+template<typename Point>
+void ply_importer::read_ascii_(Point* out, std::size_t n) {
+	// Find file offsets of chunk starts. Only searches for line delimitors, which is fast compared to parsing.
+	std::vector<std::size_t> chunk_offsets;
+	std::size_t offset = current_offset_;
+	for(std::size_t i = 0; i < n; ++i) {
+		if(offset >= file_.size()) throw ply_importer_error("PLY file truncated.");
+		if(i % ascii_chunk_lines_ == 0) chunk_offsets.push_back(offset);
+		offset = next_line_(offset);
+	}
 	
-	if(is_ascii()) read_ascii_(buffer, n);
-	else read_binary_(buffer, n);
+	// Parse chunks in parallel, each chunk into its part of the output buffer.
+	worker_pool::instance().parallel_for(chunk_offsets.size(), [&](std::ptrdiff_t chunk) {
+		std::size_t first = chunk * ascii_chunk_lines_;
+		std::size_t count = std::min(ascii_chunk_lines_, n - first);
+		read_ascii_chunk_(out + first, count, chunk_offsets[chunk]);
+	});
 	
-	current_element_ += n;
+	current_offset_ = offset;
 }
 
 
-std::ptrdiff_t ply_importer::tell() const {
-	return current_element_;
+ply_importer::ply_importer(const std::string& filename, line_delimitor ld) :
+	file_(filename),
+	line_delimitor_(ld),
+	number_of_vertices_(0)
+{
+	if(file_.size() > 0)
+		set_memory_usage_advice(const_cast<byte*>(file_.data()), file_.size(), memory_usage_advice::sequential);
+
+	if(line_delimitor_ == line_delimitor::unknown) {
+		// Detect line ending type from first line ('ply').
+		std::size_t max_offset = std::min<std::size_t>(file_.size(), 512);
+		const char* begin = chars_();
+		const char* pos = std::find_if(begin, begin + max_offset, [](char c) { return (c == '\n' || c == '\r'); });
+		if(pos == begin + max_offset) throw ply_importer_error("Could not detect line delimitor of PLY file.");
+		else if(*pos == '\n') line_delimitor_ = line_delimitor::LF;
+		else if(pos + 1 != begin + file_.size() && *(pos + 1) == '\n') line_delimitor_ = line_delimitor::CRLF;
+		else line_delimitor_ = line_delimitor::CR;
+	}
+
+	read_header_();
+	compile_plan_();
+	rewind();
 }
 
 
-std::size_t ply_importer::size() const {
-	return number_of_vertices_;
+void ply_importer::rewind() {
+	current_element_ = 0;
+	current_offset_ = vertex_data_start_;
 }
 
 
-bool ply_importer::all_valid() const {
-	return true;
+void ply_importer::read(point_xyz* buffer, std::size_t sz) {
+	Expects(current_element_ + sz <= number_of_vertices_);
+	if(is_ascii()) read_ascii_(buffer, sz);
+	else read_binary_(buffer, sz);
+	current_element_ += sz;
 }
 
 
+void ply_importer::read(point_full* buffer, std::size_t sz) {
+	Expects(current_element_ + sz <= number_of_vertices_);
+	if(is_ascii()) read_ascii_(buffer, sz);
+	else read_binary_(buffer, sz);
+	current_element_ += sz;
+}
+
 }
-*/
@@ -21,99 +21,123 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #ifndef MF_PLY_IMPORTER_H_
 #define MF_PLY_IMPORTER_H_
 
-#include <fstream>
 #include <string>
-#include <cassert>
 #include <vector>
 #include <array>
-#include <cstdlib>
 #include <cstdint>
-#include <limits>
-#include <utility>
-#include <memory>
-#include <cctype>
 
+#include "../point_cloud/point.h"
+#include "../os/mapped_file.h"
 #include "../utility/io.h"
 
 namespace mf {
 
 /// Imports point cloud from PLY file.
-/** Reads only points (vertices), possibly with RGB color and normal vector data. Supports ASCII and binary formats.
- ** Detects line ending type from file. File may contains other elements except vertex, but those are not read.
- ** List-type properties are not supported, and are only tolerated in elements behinds vertex. */
+/** Reads only points (vertices), possibly with RGB color, normal vector and weight data. Supports ASCII and binary
+ ** formats. File may contain other elements except vertex, but those are not read. List-type properties are not
+ ** supported, and are only tolerated in elements behind vertex.
+ ** The file is memory-mapped. For binary formats, a _property plan_ is compiled from the header once: for each
+ ** property that gets read, its offset in the vertex record and a conversion function for its type and endianness.
+ ** When the X, Y, Z properties are consecutive and have type and endianness of \ref Eigen_scalar (as written by
+ ** \ref ply_exporter), the position is copied as one block instead.
+ ** ASCII vertex data is split into chunks of lines, which get parsed in parallel on the \ref worker_pool, each
+ ** writing directly into its part of the output buffer. */
 class ply_importer {
 private:
-	const static std::size_t maximal_ascii_element_line_length_ = 256;
-
 	enum property_type {
 		none, int8, uint8, int16, uint16, int32, uint32, float32, float64, list
 	};
+	
+	enum property_field {
+		x, y, z, nx, ny, nz, red, green, blue, weight, fields_count
+	};
 
 	struct property {
 		property_type type = none;
-		std::ptrdiff_t offset;
-		std::ptrdiff_t index;
+		std::ptrdiff_t offset; ///< Byte offset in binary vertex record.
+		std::ptrdiff_t index; ///< Index in ASCII vertex line.
 		
 		explicit operator bool() const { return (type != none); }
 	};
-		
-	std::ifstream file_;
+	
+	using read_property_function = Eigen_scalar(const byte*);
+	
+	/// Step of property plan, reads one field of the point from binary vertex record.
+	struct plan_step {
+		property_field field;
+		std::ptrdiff_t offset;
+		read_property_function* read;
+	};
+	
+	using field_values = std::array<Eigen_scalar, fields_count>;
+	
+	/// Number of ASCII vertex lines per chunk that gets parsed as one task.
+	static constexpr std::size_t ascii_chunk_lines_ = 4096;
+	
+	mapped_file file_;
 	line_delimitor line_delimitor_;
-	std::ifstream::pos_type vertex_data_start_; ///< File offset where vertex data starts.
+	std::size_t vertex_data_start_; ///< File offset where vertex data starts.
 	std::size_t number_of_vertices_; ///< Number of vertex elements in file.
 	enum { binary_big_endian, binary_little_endian, ascii } format_; ///< Format of file.
 	std::size_t vertex_length_; ///< For binary formats, length of one vertex element.
 	std::size_t number_of_properties_; ///< Number of properties for vertex element.
-	bool has_rgb_; ///< Whether r_, g_, b_ are defined.
-	bool has_normal_; ///< Whether nx_, ny_, nz_ are defined.
-	bool has_weight_; ///< Whether w_ is defined.
-	property x_, y_, z_, r_, g_, b_, nx_, ny_, nz_, w_; ///< Offsets, Indices and types of vertex properties.
+	bool has_rgb_; ///< Whether red, green, blue are defined.
+	bool has_normal_; ///< Whether nx, ny, nz are defined.
+	bool has_weight_; ///< Whether weight is defined.
+	std::array<property, fields_count> properties_; ///< Offsets, indices and types of vertex properties.
+	
+	std::vector<plan_step> position_plan_; ///< Plan for X, Y, Z, empty if position is read as block.
+	std::vector<plan_step> attributes_plan_; ///< Plan for the other fields.
+	std::vector<std::ptrdiff_t> ascii_fields_; ///< For ASCII, field of each property of line, or -1.
 	
 	std::ptrdiff_t current_element_; ///< Index of current element.
-
-
-	void skip_lines_(std::size_t n) {
-		while(n--) skip_line(file_, line_delimitor_);
-	}
+	std::size_t current_offset_; ///< For ASCII, file offset of line of current element.
 	
-	void read_line_(std::string& ln) {
-		read_line(file_, ln, line_delimitor_);
-	}
+	const char* chars_(std::size_t offset = 0) const { return reinterpret_cast<const char*>(file_.data()) + offset; }
+	std::size_t line_end_(std::size_t offset) const;
+	std::size_t next_line_(std::size_t offset) const;
+	std::string read_line_(std::size_t& offset) const;
 	
 	bool is_host_endian_binary_() const {
 		if(host_is_little_endian) return (format_ == binary_little_endian);
 		else return (format_ == binary_big_endian);
 	}
 	
-	property* identify_property_(const std::string& nm);
+	static property_field identify_field_(const std::string& nm);
 	static property_type identify_property_type_(const std::string& nm);
 	static std::size_t property_type_size_(property_type t);
+	read_property_function* read_property_function_(property_type t) const;
 	void read_header_();
+	void compile_plan_();
 	
+	void read_binary_position_(Eigen_vec4&, const byte* record) const;
+	void read_binary_(point_xyz* buffer, std::size_t n);
+	void read_binary_(point_full* buffer, std::size_t n);
 	template<typename Point> void read_ascii_(Point* buffer, std::size_t n);
-	template<typename Point> void read_binary_(Point* buffer, std::size_t n);
+	template<typename Point> void read_ascii_chunk_(Point* buffer, std::size_t n, std::size_t offset) const;
+	void parse_ascii_line_(const char* begin, const char* end, field_values&) const;
+	field_values default_field_values_() const;
 	
-	void read_ascii_point_(point_xyz& out_point, const char* props[]) const;
-	void read_ascii_point_(point_full& out_point, const char* props[]) const;
-	void read_binary_point_(point_xyz& out_point, char* data) const;
-	void read_binary_point_(point_full& out_point, char* data) const;
-	template<typename T> T read_binary_property_(const property& prop, char* data) const;
+	static void set_point_(point_xyz&, const field_values&);
+	static void set_point_(point_full&, const field_values&);
+	static void set_attributes_(point_full&, const field_values&);
 
 public:
-	explicit ply_importer(const char* filename, line_delimitor ld = line_delimitor::unknown);
-	explicit ply_importer(const std::string& filename, line_delimitor ld = line_delimitor::unknown) :
-		ply_importer(filename.c_str(), ld) { }
+	explicit ply_importer(const std::string& filename, line_delimitor ld = line_delimitor::unknown);
 
-	std::size_t size() const override;
-	bool all_valid() const override;
+	std::size_t size() const { return number_of_vertices_; }
+	bool all_valid() const { return true; } ///< Imported points are never null.
 	
-	void rewind() override;
-	std::ptrdiff_t tell() const override;
-	void read(point_xyz*, std::size_t sz) override;
-	void read(point_full*, std::size_t sz) override;
+	void rewind();
+	std::ptrdiff_t tell() const { return current_element_; }
+	void read(point_xyz*, std::size_t sz);
+	void read(point_full*, std::size_t sz);
 
 	bool is_binary() const { return format_ != ascii; }
 	bool is_ascii() const { return format_ == ascii; }
+	
+	/// Whether binary X, Y, Z properties are read as one block, without conversion.
+	bool has_host_layout_position() const { return is_binary() && position_plan_.empty(); }
 };
 
 }
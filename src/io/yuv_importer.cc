@@ -20,9 +20,189 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 
 #include "yuv_importer.h"
 #include "../utility/io.h"
+#include "../utility/misc.h"
+#include "../os/cpu.h"
+#include <algorithm>
+#include <cstdint>
+
+#ifdef MF_X86_SIMD
+#include <immintrin.h>
+#endif
 
 namespace mf {
 
+namespace {
+
+using interleave_rows_function = std::ptrdiff_t(
+	const std::uint8_t* const* y_rows,
+	ycbcr_color* const* out_rows,
+	std::ptrdiff_t rows_count,
+	const std::uint8_t* cb_row,
+	const std::uint8_t* cr_row,
+	std::ptrdiff_t width,
+	bool subsampled_x
+);
+
+
+#ifdef MF_X86_SIMD
+
+/// Interleave Y, Cb, Cr rows into `ycbcr_color` rows, 16 pixels at a time.
+/** The \a rows_count output rows share the same chroma row, whose samples are upsampled once for all of them.
+ ** Returns number of pixels processed in each row, the remaining pixels need to be processed by scalar code. */
+std::ptrdiff_t interleave_rows_sse2_(
+	const std::uint8_t* const* y_rows, ycbcr_color* const* out_rows, std::ptrdiff_t rows_count,
+	const std::uint8_t* cb_row, const std::uint8_t* cr_row, std::ptrdiff_t width, bool subsampled_x
+) {
+	const __m128i zero = _mm_setzero_si128();
+	std::ptrdiff_t x = 0;
+	for(; x + 16 <= width; x += 16) {
+		__m128i cb, cr;
+		if(subsampled_x) {
+			__m128i cb_half = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb_row + x/2));
+			__m128i cr_half = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr_row + x/2));
+			cb = _mm_unpacklo_epi8(cb_half, cb_half);
+			cr = _mm_unpacklo_epi8(cr_half, cr_half);
+		} else {
+			cb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cb_row + x));
+			cr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cr_row + x));
+		}
+		// 16 bit words (cb, 0)
+		__m128i cb_lo = _mm_unpacklo_epi8(cb, zero);
+		__m128i cb_hi = _mm_unpackhi_epi8(cb, zero);
+	
+		for(std::ptrdiff_t i = 0; i < rows_count; ++i) {
+			__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_rows[i] + x));
+			// 16 bit words (y, cr)
+			__m128i ycr_lo = _mm_unpacklo_epi8(y, cr);
+			__m128i ycr_hi = _mm_unpackhi_epi8(y, cr);
+			// 32 bit pixels (y, cr, cb, 0)
+			__m128i* out = reinterpret_cast<__m128i*>(out_rows[i] + x);
+			_mm_storeu_si128(out, _mm_unpacklo_epi16(ycr_lo, cb_lo));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(ycr_lo, cb_lo));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(ycr_hi, cb_hi));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(ycr_hi, cb_hi));
+		}
+	}
+	return x;
+}
+
+
+/// Interleave Y, Cb, Cr rows into `ycbcr_color` rows, 32 pixels at a time.
+/** Like interleave_rows_sse2_(). The AVX2 unpack instructions operate on each 128 bit lane separately, so the
+ ** results get reordered across lanes before storing. */
+MF_TARGET_AVX2 std::ptrdiff_t interleave_rows_avx2_(
+	const std::uint8_t* const* y_rows, ycbcr_color* const* out_rows, std::ptrdiff_t rows_count,
+	const std::uint8_t* cb_row, const std::uint8_t* cr_row, std::ptrdiff_t width, bool subsampled_x
+) {
+	const __m256i zero = _mm256_setzero_si256();
+	std::ptrdiff_t x = 0;
+	for(; x + 32 <= width; x += 32) {
+		__m256i cb, cr;
+		if(subsampled_x) {
+			__m128i cb_half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cb_row + x/2));
+			__m128i cr_half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cr_row + x/2));
+			cb = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(cb_half, cb_half)), _mm_unpackhi_epi8(cb_half, cb_half), 1);
+			cr = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(cr_half, cr_half)), _mm_unpackhi_epi8(cr_half, cr_half), 1);
+		} else {
+			cb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cb_row + x));
+			cr = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cr_row + x));
+		}
+		__m256i cb_lo = _mm256_unpacklo_epi8(cb, zero); // pixels [0, 8[, [16, 24[
+		__m256i cb_hi = _mm256_unpackhi_epi8(cb, zero); // pixels [8, 16[, [24, 32[
+	
+		for(std::ptrdiff_t i = 0; i < rows_count; ++i) {
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y_rows[i] + x));
+			__m256i ycr_lo = _mm256_unpacklo_epi8(y, cr);
+			__m256i ycr_hi = _mm256_unpackhi_epi8(y, cr);
+			__m256i a = _mm256_unpacklo_epi16(ycr_lo, cb_lo); // pixels [0, 4[, [16, 20[
+			__m256i b = _mm256_unpackhi_epi16(ycr_lo, cb_lo); // pixels [4, 8[, [20, 24[
+			__m256i c = _mm256_unpacklo_epi16(ycr_hi, cb_hi); // pixels [8, 12[, [24, 28[
+			__m256i d = _mm256_unpackhi_epi16(ycr_hi, cb_hi); // pixels [12, 16[, [28, 32[
+			__m256i* out = reinterpret_cast<__m256i*>(out_rows[i] + x);
+			_mm256_storeu_si256(out, _mm256_permute2x128_si256(a, b, 0x20));
+			_mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(c, d, 0x20));
+			_mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(a, b, 0x31));
+			_mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(c, d, 0x31));
+		}
+	}
+	return x;
+}
+
+#endif
+
+
+/// Select vectorized interleave function for processor, or `nullptr` if none available.
+interleave_rows_function* select_interleave_rows_() {
+	#ifdef MF_X86_SIMD
+	if(cpu_supports_avx2()) return &interleave_rows_avx2_;
+	else return &interleave_rows_sse2_;
+	#else
+	return nullptr;
+	#endif
+}
+
+}
+
+void interleave_ycbcr_planes(
+	const ycbcr_plane_view_type& y_plane,
+	const ycbcr_plane_view_type& cb_plane,
+	const ycbcr_plane_view_type& cr_plane,
+	std::size_t chroma_scale_y,
+	std::size_t chroma_scale_x,
+	const ndarray_view<2, ycbcr_color>& out
+) {
+	static interleave_rows_function* const interleave_rows = select_interleave_rows_();
+	
+	Expects(out.shape() == y_plane.shape());
+	Expects(y_plane.strides()[1] == 1 && cb_plane.strides()[1] == 1 && cr_plane.strides()[1] == 1);
+	
+	const std::ptrdiff_t height = y_plane.shape()[0];
+	const std::ptrdiff_t width = y_plane.shape()[1];
+	const std::ptrdiff_t scale_x = chroma_scale_x, scale_y = chroma_scale_y;
+	
+	if(out.strides()[1] != sizeof(ycbcr_color)) {
+		// output rows not contiguous: copy each pixel
+		for(std::ptrdiff_t y = 0; y < height; ++y)
+		for(std::ptrdiff_t x = 0; x < width; ++x) {
+			ycbcr_color& col = out[y][x];
+			col.y = y_plane[y][x];
+			col.cb = cb_plane[y / scale_y][x / scale_x];
+			col.cr = cr_plane[y / scale_y][x / scale_x];
+		}
+		return;
+	}
+	
+	auto row = [](const ycbcr_plane_view_type& plane, std::ptrdiff_t y) {
+		return advance_raw_ptr(plane.start(), y * plane.strides()[0]);
+	};
+	
+	// process the (one or two) rows that share a chroma row together
+	for(std::ptrdiff_t y = 0; y < height; y += scale_y) {
+		std::ptrdiff_t rows_count = std::min(scale_y, height - y);
+		const std::uint8_t* y_rows[2];
+		ycbcr_color* out_rows[2];
+		for(std::ptrdiff_t i = 0; i < rows_count; ++i) {
+			y_rows[i] = row(y_plane, y + i);
+			out_rows[i] = advance_raw_ptr(out.start(), (y + i) * out.strides()[0]);
+		}
+		const std::uint8_t* cb_row = row(cb_plane, y / scale_y);
+		const std::uint8_t* cr_row = row(cr_plane, y / scale_y);
+		
+		std::ptrdiff_t x_begin = 0;
+		if(interleave_rows != nullptr)
+			x_begin = interleave_rows(y_rows, out_rows, rows_count, cb_row, cr_row, width, (scale_x == 2));
+		
+		for(std::ptrdiff_t i = 0; i < rows_count; ++i)
+		for(std::ptrdiff_t x = x_begin; x < width; ++x) {
+			ycbcr_color& col = out_rows[i][x];
+			col.y = y_rows[i][x];
+			col.cb = cb_row[x / scale_x];
+			col.cr = cr_row[x / scale_x];
+		}
+	}
+}
+
+
 yuv_importer::yuv_importer(const std::string& filename, const ndsize<2>& frame_shape, int sampling) :
 	base(frame_shape),
 	file_(filename, std::ios_base::in | std::ios_base::binary),
@@ -40,7 +220,7 @@ yuv_importer::yuv_importer(const std::string& filename, const ndsize<2>& frame_s
 	frame_size_ = luma_size + 2*chroma_size;
 
 	// allocate buffer for raw frame data
-	frame_buffer_.reset(new char_type[frame_size_]);
+	frame_buffer_.reset(new std::uint8_t[frame_size_]);
 
 	// make 2D views for Y, Cr, Cb in local buffer
 	y_view_.reset(
@@ -64,16 +244,9 @@ void yuv_importer::read_frame(const ndarray_view<2, ycbcr_color>& out) {
 	if(out.shape() != shape) throw std::invalid_argument("output view has wrong shape");
 	
 	// read raw frame into local buffer
-	file_.read(frame_buffer_.get(), frame_size_);
+	file_.read(reinterpret_cast<char_type*>(frame_buffer_.get()), frame_size_);
 	
-	// copy from 2D views into output
-	for(std::ptrdiff_t y = 0; y < shape[0]; ++y)
-	for(std::ptrdiff_t x = 0; x < shape[1]; ++x) {
-		ycbcr_color& col = out[y][x];
-		col.y = y_view_[y][x];
-		col.cb = cb_view_[y / chroma_scale_y_][x / chroma_scale_x_];
-		col.cr = cr_view_[y / chroma_scale_y_][x / chroma_scale_x_];
-	}
+	interleave_ycbcr_planes(y_view_, cb_view_, cr_view_, chroma_scale_y_, chroma_scale_x_, out);
 	
 	current_time_++;
 }
@@ -23,12 +23,31 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 
 #include <fstream>
 #include <memory>
+#include <cstdint>
 #include "../color.h"
 #include "../io/seekable_frame_importer.h"
 #include "../nd/ndarray_view.h"
 
 namespace mf {
 
+/// View to one plane of planar YUV frame.
+using ycbcr_plane_view_type = ndarray_view<2, const std::uint8_t>;
+
+
+/// Interleave planar Y, Cb, Cr data into `ycbcr_color` view.
+/** Chroma planes are subsampled by \a chroma_scale_y and \a chroma_scale_x (1 or 2) relative to the Y plane.
+ ** When the rows of the output view are contiguous, the planes are interleaved using SIMD instructions if available
+ ** (SSE2 or AVX2 on x86-64, selected at runtime). Otherwise each pixel is copied separately. */
+void interleave_ycbcr_planes(
+	const ycbcr_plane_view_type& y_plane,
+	const ycbcr_plane_view_type& cb_plane,
+	const ycbcr_plane_view_type& cr_plane,
+	std::size_t chroma_scale_y,
+	std::size_t chroma_scale_x,
+	const ndarray_view<2, ycbcr_color>& out
+);
+
+
 // TODO rewrite with raw_video_frame_format, name raw_video_importer
 
 /// Seekable frame importer which reads YUV file.
@@ -42,11 +61,11 @@ private:
 	std::size_t file_size_;
 	std::size_t current_time_ = 0;
 	
-	std::unique_ptr<char_type[]> frame_buffer_;
+	std::unique_ptr<std::uint8_t[]> frame_buffer_;
 	std::streamsize frame_size_;
-	ndarray_view<2, char_type> y_view_;
-	ndarray_view<2, char_type> cb_view_;
-	ndarray_view<2, char_type> cr_view_;
+	ycbcr_plane_view_type y_view_;
+	ycbcr_plane_view_type cb_view_;
+	ycbcr_plane_view_type cr_view_;
 	
 	std::size_t chroma_scale_y_;
 	std::size_t chroma_scale_x_;
@@ -0,0 +1,121 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_NDARRAY_LOOP_H_
+#define MF_NDARRAY_LOOP_H_
+
+#include "../ndcoord.h"
+#include <array>
+#include <cstddef>
+
+namespace mf { namespace detail {
+
+/// Loop nest over the elements of \a Views_count views with same shape, but possibly different strides.
+/** On construction, adjacent axis which are contiguous in all views (i.e. the stride of the outer axis is the stride of
+ ** the inner axis times its length) get collapsed into one, and axis of length 1 are removed. The innermost remaining
+ ** axis forms the _runs_ which the callback processes in a flat loop. The remaining outer axis get iterated using
+ ** per-axis counters, without index to coordinates conversion. */
+template<std::size_t Dim, std::size_t Views_count>
+class ndarray_loop {
+public:
+	using strides_array_type = std::array<ndptrdiff<Dim>, Views_count>;
+	using offsets_type = std::array<std::ptrdiff_t, Views_count>;
+
+private:
+	std::ptrdiff_t axis_count_ = 0; // collapsed axis, innermost first
+	std::array<std::ptrdiff_t, (Dim > 0 ? Dim : 1)> lengths_;
+	std::array<std::array<std::ptrdiff_t, (Dim > 0 ? Dim : 1)>, Views_count> strides_;
+	bool empty_ = false;
+
+public:
+	ndarray_loop(const ndsize<Dim>& shape, const strides_array_type& strides) {
+		lengths_[0] = 1;
+		for(std::size_t k = 0; k < Views_count; ++k) strides_[k][0] = 0;
+		axis_count_ = 1;
+		
+		for(std::ptrdiff_t i = Dim - 1; i >= 0; --i) {
+			std::ptrdiff_t len = shape[i];
+			if(len == 0) { empty_ = true; return; }
+			if(len == 1) continue;
+			
+			std::ptrdiff_t inner = axis_count_ - 1;
+			if(lengths_[inner] == 1) {
+				// replace axis of length 1
+				lengths_[inner] = len;
+				for(std::size_t k = 0; k < Views_count; ++k) strides_[k][inner] = strides[k][i];
+				continue;
+			}
+			
+			bool contiguous = true;
+			for(std::size_t k = 0; k < Views_count; ++k)
+				if(strides[k][i] != strides_[k][inner] * lengths_[inner]) contiguous = false;
+			
+			if(contiguous) {
+				// collapse into inner axis, its stride stays the same
+				lengths_[inner] *= len;
+			} else {
+				lengths_[axis_count_] = len;
+				for(std::size_t k = 0; k < Views_count; ++k) strides_[k][axis_count_] = strides[k][i];
+				++axis_count_;
+			}
+		}
+	}
+	
+	bool is_empty() const { return empty_; }
+	
+	/// Length of the runs, i.e. of the innermost collapsed axis.
+	std::ptrdiff_t run_length() const { return lengths_[0]; }
+	
+	/// Stride of view \a k along the runs, in bytes.
+	std::ptrdiff_t run_stride(std::size_t k) const { return strides_[k][0]; }
+	
+	/// Number of runs.
+	std::ptrdiff_t runs_count() const {
+		std::ptrdiff_t count = 1;
+		for(std::ptrdiff_t i = 1; i < axis_count_; ++i) count *= lengths_[i];
+		return (empty_ ? 0 : count);
+	}
+	
+	/// Call `func(offsets)` for each run, where `offsets[k]` is the byte offset of the run start in view \a k.
+	/** Stops and returns `false` as soon as \a func returns `false`. */
+	template<typename Function>
+	bool run(Function&& func) const {
+		if(empty_) return true;
+		offsets_type offsets;
+		offsets.fill(0);
+		std::array<std::ptrdiff_t, (Dim > 0 ? Dim : 1)> counters;
+		counters.fill(0);
+		for(;;) {
+			if(! func(const_cast<const offsets_type&>(offsets))) return false;
+			std::ptrdiff_t i = 1;
+			for(; i < axis_count_; ++i) {
+				for(std::size_t k = 0; k < Views_count; ++k) offsets[k] += strides_[k][i];
+				if(++counters[i] < lengths_[i]) break;
+				for(std::size_t k = 0; k < Views_count; ++k) offsets[k] -= strides_[k][i] * lengths_[i];
+				counters[i] = 0;
+			}
+			if(i == axis_count_) return true;
+		}
+	}
+};
+
+}}
+
+#endif
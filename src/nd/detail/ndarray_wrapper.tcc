@@ -69,7 +69,7 @@ ndarray_wrapper<View, Const_view, Allocator>::ndarray_wrapper(const Allocator& a
 
 template<typename View, typename Const_view, typename Allocator>
 ndarray_wrapper<View, Const_view, Allocator>::ndarray_wrapper(ndarray_wrapper&& arr) :
-	allocator_(),
+	allocator_(arr.allocator_),
 	allocated_size_(arr.allocated_size_),
 	allocated_buffer_(arr.allocated_buffer_),
 	view_(arr.view_)
@@ -92,6 +92,7 @@ auto ndarray_wrapper<View, Const_view, Allocator>::operator=(ndarray_wrapper&& a
 	
 	deallocate_();
 	
+	allocator_ = arr.allocator_;
 	allocated_size_ = arr.allocated_size_;
 	allocated_buffer_ = arr.allocated_buffer_;
 	view_.reset(arr.view_);
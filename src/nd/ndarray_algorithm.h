@@ -0,0 +1,59 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_NDARRAY_ALGORITHM_H_
+#define MF_NDARRAY_ALGORITHM_H_
+
+#include "ndarray_view.h"
+
+namespace mf {
+
+/// Call `func(elem)` for each element of \a vw, in row-major order.
+/** Axis along which \a vw is contiguous get collapsed into flat loops, see \ref detail::ndarray_loop. */
+template<std::size_t Dim, typename T, typename Function>
+void ndarray_for_each(const ndarray_view<Dim, T>& vw, Function&& func);
+
+/// Call `func(a_elem, b_elem)` for each pair of corresponding elements of \a a and \a b.
+/** Views must have same shape. */
+template<std::size_t Dim, typename T1, typename T2, typename Function>
+void ndarray_for_each(const ndarray_view<Dim, T1>& a, const ndarray_view<Dim, T2>& b, Function&& func);
+
+/// Assign `func(in_elem)` to each element of \a out.
+/** Views must have same shape. */
+template<std::size_t Dim, typename In, typename Out, typename Function>
+void ndarray_transform(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out, Function&& func);
+
+/// Assign elements of \a in to \a out.
+/** Views must have same shape, and not overlap. When elements have same trivially copyable type, contiguous runs get
+ ** copied using `std::memcpy`. */
+template<std::size_t Dim, typename In, typename Out>
+void ndarray_copy(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out);
+
+/// Check if \a a and \a b have same shape and equal elements.
+/** Elements are compared using `operator==`. For integral and enumeration types, contiguous runs get compared using
+ ** `std::memcmp`. */
+template<std::size_t Dim, typename T1, typename T2>
+bool ndarray_equal(const ndarray_view<Dim, T1>& a, const ndarray_view<Dim, T2>& b);
+
+}
+
+#include "ndarray_algorithm.tcc"
+
+#endif
@@ -0,0 +1,174 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "detail/ndarray_loop.h"
+#include <cstring>
+#include <type_traits>
+
+namespace mf {
+
+namespace detail {
+
+template<std::size_t Dim, typename T1, typename T2, typename Function>
+void ndarray_for_each_pair_(const ndarray_view<Dim, T1>& a, const ndarray_view<Dim, T2>& b, Function&& func) {
+	ndarray_loop<Dim, 2> loop(a.shape(), {{ a.strides(), b.strides() }});
+	const std::ptrdiff_t length = loop.run_length();
+	const std::ptrdiff_t a_stride = loop.run_stride(0), b_stride = loop.run_stride(1);
+	T1* a_start = a.start();
+	T2* b_start = b.start();
+	if(a_stride == sizeof(T1) && b_stride == sizeof(T2)) {
+		loop.run([&](const auto& offsets) {
+			T1* a_run = advance_raw_ptr(a_start, offsets[0]);
+			T2* b_run = advance_raw_ptr(b_start, offsets[1]);
+			for(std::ptrdiff_t i = 0; i < length; ++i) func(a_run[i], b_run[i]);
+			return true;
+		});
+	} else {
+		loop.run([&](const auto& offsets) {
+			T1* a_ptr = advance_raw_ptr(a_start, offsets[0]);
+			T2* b_ptr = advance_raw_ptr(b_start, offsets[1]);
+			for(std::ptrdiff_t i = 0; i < length; ++i) {
+				func(*a_ptr, *b_ptr);
+				a_ptr = advance_raw_ptr(a_ptr, a_stride);
+				b_ptr = advance_raw_ptr(b_ptr, b_stride);
+			}
+			return true;
+		});
+	}
+}
+
+
+template<std::size_t Dim, typename In, typename Out>
+void ndarray_copy_(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out, std::true_type) {
+	// same trivially copyable type: memcpy on contiguous runs
+	ndarray_loop<Dim, 2> loop(in.shape(), {{ in.strides(), out.strides() }});
+	if(loop.run_stride(0) == sizeof(Out) && loop.run_stride(1) == sizeof(Out)) {
+		const std::size_t run_size = loop.run_length() * sizeof(Out);
+		loop.run([&](const auto& offsets) {
+			std::memcpy(advance_raw_ptr(out.start(), offsets[1]), advance_raw_ptr(in.start(), offsets[0]), run_size);
+			return true;
+		});
+	} else {
+		ndarray_for_each_pair_(in, out, [](const In& a, Out& b) { b = a; });
+	}
+}
+
+
+template<std::size_t Dim, typename In, typename Out>
+void ndarray_copy_(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out, std::false_type) {
+	ndarray_for_each_pair_(in, out, [](const In& a, Out& b) { b = a; });
+}
+
+
+template<std::size_t Dim, typename T1, typename T2>
+bool ndarray_equal_(const ndarray_view<Dim, T1>& a, const ndarray_view<Dim, T2>& b, std::false_type) {
+	ndarray_loop<Dim, 2> loop(a.shape(), {{ a.strides(), b.strides() }});
+	const std::ptrdiff_t length = loop.run_length();
+	const std::ptrdiff_t a_stride = loop.run_stride(0), b_stride = loop.run_stride(1);
+	return loop.run([&](const auto& offsets) {
+		T1* a_ptr = advance_raw_ptr(a.start(), offsets[0]);
+		T2* b_ptr = advance_raw_ptr(b.start(), offsets[1]);
+		for(std::ptrdiff_t i = 0; i < length; ++i) {
+			if(! (*a_ptr == *b_ptr)) return false;
+			a_ptr = advance_raw_ptr(a_ptr, a_stride);
+			b_ptr = advance_raw_ptr(b_ptr, b_stride);
+		}
+		return true;
+	});
+}
+
+
+template<std::size_t Dim, typename T1, typename T2>
+bool ndarray_equal_(const ndarray_view<Dim, T1>& a, const ndarray_view<Dim, T2>& b, std::true_type) {
+	// same integral type: memcmp on contiguous runs
+	ndarray_loop<Dim, 2> loop(a.shape(), {{ a.strides(), b.strides() }});
+	const std::ptrdiff_t length = loop.run_length();
+	const std::ptrdiff_t a_stride = loop.run_stride(0), b_stride = loop.run_stride(1);
+	if(a_stride == sizeof(T1) && b_stride == sizeof(T2)) {
+		const std::size_t run_size = length * sizeof(T1);
+		return loop.run([&](const auto& offsets) {
+			return (std::memcmp(advance_raw_ptr(a.start(), offsets[0]), advance_raw_ptr(b.start(), offsets[1]), run_size) == 0);
+		});
+	} else {
+		return ndarray_equal_(a, b, std::false_type());
+	}
+}
+
+}
+
+
+template<std::size_t Dim, typename T, typename Function>
+void ndarray_for_each(const ndarray_view<Dim, T>& vw, Function&& func) {
+	detail::ndarray_loop<Dim, 1> loop(vw.shape(), {{ vw.strides() }});
+	const std::ptrdiff_t length = loop.run_length();
+	const std::ptrdiff_t stride = loop.run_stride(0);
+	T* start = vw.start();
+	if(stride == sizeof(T)) {
+		loop.run([&](const auto& offsets) {
+			T* run = advance_raw_ptr(start, offsets[0]);
+			for(std::ptrdiff_t i = 0; i < length; ++i) func(run[i]);
+			return true;
+		});
+	} else {
+		loop.run([&](const auto& offsets) {
+			T* ptr = advance_raw_ptr(start, offsets[0]);
+			for(std::ptrdiff_t i = 0; i < length; ++i, ptr = advance_raw_ptr(ptr, stride)) func(*ptr);
+			return true;
+		});
+	}
+}
+
+
+template<std::size_t Dim, typename T1, typename T2, typename Function>
+void ndarray_for_each(const ndarray_view<Dim, T1>& a, const ndarray_view<Dim, T2>& b, Function&& func) {
+	Assert_crit(a.shape() == b.shape());
+	detail::ndarray_for_each_pair_(a, b, func);
+}
+
+
+template<std::size_t Dim, typename In, typename Out, typename Function>
+void ndarray_transform(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out, Function&& func) {
+	Assert_crit(in.shape() == out.shape());
+	detail::ndarray_for_each_pair_(in, out, [&func](In& a, Out& b) { b = func(a); });
+}
+
+
+template<std::size_t Dim, typename In, typename Out>
+void ndarray_copy(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out) {
+	Assert_crit(in.shape() == out.shape());
+	using memcpy_possible = std::integral_constant<bool,
+		std::is_same<std::remove_const_t<In>, Out>::value && std::is_trivially_copyable<Out>::value
+	>;
+	detail::ndarray_copy_(in, out, memcpy_possible());
+}
+
+
+template<std::size_t Dim, typename T1, typename T2>
+bool ndarray_equal(const ndarray_view<Dim, T1>& a, const ndarray_view<Dim, T2>& b) {
+	if(a.shape() != b.shape()) return false;
+	using elem_type = std::remove_const_t<T1>;
+	using memcmp_possible = std::integral_constant<bool,
+		std::is_same<elem_type, std::remove_const_t<T2>>::value &&
+		(std::is_integral<elem_type>::value || std::is_enum<elem_type>::value)
+	>;
+	return detail::ndarray_equal_(a, b, memcmp_possible());
+}
+
+}
@@ -49,7 +49,9 @@ kernel_placement<Dim, Elem, Kernel_elem> place_kernel_at(
 /** \param func Function `void(const kernel_placement<Dim, In_elem, Kernel_elem>&, Out_elem&)`.
  ** \param in_view View over which kernel gets applied. `In_elem` may be const.
  ** \param out_view View whose elements get modified by kernel. Must be same shape as `in_view`.
- ** \param kernel The kernel. */
+ ** \param kernel The kernel.
+ ** Computes the kernel placement for each element, which is slow. For linear filtering of 2D images use
+ ** \ref convolve() instead. */
 template<std::size_t Dim, typename In_elem, typename Out_elem, typename Kernel_elem, typename Function>
 void apply_kernel(
 	Function&& func,
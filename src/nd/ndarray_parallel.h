@@ -0,0 +1,83 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_NDARRAY_PARALLEL_H_
+#define MF_NDARRAY_PARALLEL_H_
+
+#include "ndarray_view.h"
+#include "ndarray_algorithm.h"
+#include "ndarray_filter.h"
+#include "ndspan.h"
+#include <vector>
+
+namespace mf {
+
+/// Default size in bytes of the tiles into which views get decomposed for parallel processing.
+/** Chosen to fit in the per-core L2 cache. */
+constexpr std::size_t default_parallel_tile_size = 256 * 1024;
+
+
+/// Decompose span of shape \a shape into tiles of about \a tile_size bytes, along the outer axis.
+/** Splits axis 0, and also axis 1 if a single slice on axis 0 is larger than \a tile_size. The inner axis are never
+ ** split, so that the tiles keep the contiguous runs of the view. Tiles are returned in row-major order. */
+template<std::size_t Dim>
+std::vector<ndspan<Dim>> parallel_tiles(
+	const ndsize<Dim>& shape,
+	std::size_t elem_size,
+	std::size_t tile_size = default_parallel_tile_size
+);
+
+
+/// Call `func(elem)` for each element of \a vw, with the tiles distributed over the \ref worker_pool.
+/** Order in which elements are processed is unspecified. */
+template<std::size_t Dim, typename T, typename Function>
+void parallel_for_each(const ndarray_view<Dim, T>& vw, Function&& func);
+
+/// Assign `func(in_elem)` to each element of \a out, with the tiles distributed over the \ref worker_pool.
+template<std::size_t Dim, typename In, typename Out, typename Function>
+void parallel_transform(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out, Function&& func);
+
+/// Assign elements of \a in to \a out, with the tiles distributed over the \ref worker_pool.
+/** Like \ref ndarray_copy(). */
+template<std::size_t Dim, typename In, typename Out>
+void parallel_copy(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out);
+
+/// Reduce the elements of \a vw, with the tiles distributed over the \ref worker_pool.
+/** Each tile gets reduced by `acc = accumulate(acc, elem)`, starting with \a init. The results of the tiles then get
+ ** combined in tile order by `combine(a, b)`, so the result is deterministic if \a combine is associative. */
+template<std::size_t Dim, typename T, typename Result, typename Accumulate, typename Combine>
+Result parallel_reduce(const ndarray_view<Dim, T>& vw, const Result& init, Accumulate&& accumulate, Combine&& combine);
+
+/// Parallel version of \ref apply_kernel().
+/** The tiles of \a out_view get distributed over the \ref worker_pool. Kernel placements are the same as with
+ ** \ref apply_kernel(), i.e. truncated only at the limits of \a in_view. */
+template<std::size_t Dim, typename In_elem, typename Out_elem, typename Kernel_elem, typename Function>
+void parallel_apply_kernel(
+	Function&& func,
+	const ndarray_view<Dim, In_elem>& in_view,
+	const ndarray_view<Dim, Out_elem>& out_view,
+	const ndarray_view<Dim, Kernel_elem> kernel
+);
+
+}
+
+#include "ndarray_parallel.tcc"
+
+#endif
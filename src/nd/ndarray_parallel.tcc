@@ -0,0 +1,129 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "../os/worker_pool.h"
+#include <algorithm>
+
+namespace mf {
+
+template<std::size_t Dim>
+std::vector<ndspan<Dim>> parallel_tiles(const ndsize<Dim>& shape, std::size_t elem_size, std::size_t tile_size) {
+	static_assert(Dim >= 1, "parallel_tiles requires at least one dimension");
+	std::vector<ndspan<Dim>> tiles;
+	if(shape.product() == 0) return tiles;
+	
+	auto slice_size = [&](std::size_t axis) {
+		std::size_t size = elem_size;
+		for(std::size_t i = axis + 1; i < Dim; ++i) size *= shape[i];
+		return size;
+	};
+	auto chunk_length = [&](std::size_t axis) {
+		return std::max<std::ptrdiff_t>(1, tile_size / slice_size(axis));
+	};
+	
+	ndptrdiff<Dim> start(0);
+	ndptrdiff<Dim> end = shape;
+	const std::ptrdiff_t rows = shape[0];
+	if(Dim >= 2 && slice_size(0) > tile_size) {
+		const std::ptrdiff_t cols = shape[1];
+		std::ptrdiff_t length = chunk_length(1);
+		for(std::ptrdiff_t i = 0; i < rows; ++i)
+		for(std::ptrdiff_t j = 0; j < cols; j += length) {
+			start[0] = i; end[0] = i + 1;
+			start[1] = j; end[1] = std::min(j + length, cols);
+			tiles.emplace_back(start, end);
+		}
+	} else {
+		std::ptrdiff_t length = chunk_length(0);
+		for(std::ptrdiff_t i = 0; i < rows; i += length) {
+			start[0] = i;
+			end[0] = std::min(i + length, rows);
+			tiles.emplace_back(start, end);
+		}
+	}
+	return tiles;
+}
+
+
+template<std::size_t Dim, typename T, typename Function>
+void parallel_for_each(const ndarray_view<Dim, T>& vw, Function&& func) {
+	auto tiles = parallel_tiles(vw.shape(), sizeof(T));
+	worker_pool::instance().parallel_for(tiles.size(), [&](std::ptrdiff_t i) {
+		ndarray_for_each(vw.section(tiles[i]), func);
+	});
+}
+
+
+template<std::size_t Dim, typename In, typename Out, typename Function>
+void parallel_transform(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out, Function&& func) {
+	Assert_crit(in.shape() == out.shape());
+	auto tiles = parallel_tiles(out.shape(), sizeof(Out));
+	worker_pool::instance().parallel_for(tiles.size(), [&](std::ptrdiff_t i) {
+		ndarray_transform(in.section(tiles[i]), out.section(tiles[i]), func);
+	});
+}
+
+
+template<std::size_t Dim, typename In, typename Out>
+void parallel_copy(const ndarray_view<Dim, In>& in, const ndarray_view<Dim, Out>& out) {
+	Assert_crit(in.shape() == out.shape());
+	auto tiles = parallel_tiles(out.shape(), sizeof(Out));
+	worker_pool::instance().parallel_for(tiles.size(), [&](std::ptrdiff_t i) {
+		ndarray_copy(in.section(tiles[i]), out.section(tiles[i]));
+	});
+}
+
+
+template<std::size_t Dim, typename T, typename Result, typename Accumulate, typename Combine>
+Result parallel_reduce(const ndarray_view<Dim, T>& vw, const Result& init, Accumulate&& accumulate, Combine&& combine) {
+	auto tiles = parallel_tiles(vw.shape(), sizeof(T));
+	if(tiles.empty()) return init;
+	std::vector<Result> tile_results(tiles.size(), init);
+	worker_pool::instance().parallel_for(tiles.size(), [&](std::ptrdiff_t i) {
+		Result& acc = tile_results[i];
+		ndarray_for_each(vw.section(tiles[i]), [&acc, &accumulate](T& elem) { acc = accumulate(acc, elem); });
+	});
+	Result result = tile_results.front();
+	for(std::size_t i = 1; i < tile_results.size(); ++i) result = combine(result, tile_results[i]);
+	return result;
+}
+
+
+template<std::size_t Dim, typename In_elem, typename Out_elem, typename Kernel_elem, typename Function>
+void parallel_apply_kernel(
+	Function&& func,
+	const ndarray_view<Dim, In_elem>& in_view,
+	const ndarray_view<Dim, Out_elem>& out_view,
+	const ndarray_view<Dim, Kernel_elem> kernel
+) {
+	Expects_crit(in_view.shape() == out_view.shape());
+	auto tiles = parallel_tiles(out_view.shape(), sizeof(Out_elem));
+	worker_pool::instance().parallel_for(tiles.size(), [&](std::ptrdiff_t i) {
+		const ndspan<Dim>& tile = tiles[i];
+		auto out_section = out_view.section(tile);
+		for(auto it = out_section.begin(); it != out_section.end(); ++it) {
+			auto pos = tile.start_pos() + it.coordinates();
+			auto placement = place_kernel_at(in_view, kernel, pos);
+			func(placement, *it);
+		}
+	});
+}
+
+}
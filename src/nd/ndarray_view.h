@@ -306,6 +306,7 @@ ndarray_format format(const ndarray_view<Dim, Elem>& vw) {
 
 }
 
+#include "ndarray_algorithm.h"
 #include "ndarray_view.tcc"
 
 #endif
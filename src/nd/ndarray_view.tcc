@@ -146,8 +146,7 @@ template<std::size_t Dim, typename T> template<typename T2>
 void ndarray_view<Dim, T>::assign_static_cast(const ndarray_view<Dim, T2>& other) const {
 	// converting assignment
 	Assert_crit(shape() == other.shape(), "ndarray_view must have same shape for assignment");
-	if(shape().product() == 0) return;	
-	std::transform(other.begin(), other.end(), begin(), [](const T2& t) {
+	ndarray_transform(other, *this, [](const T2& t) {
 		return static_cast<T>(t);
 	});
 }
@@ -157,33 +156,21 @@ template<std::size_t Dim, typename T> template<typename T2>
 void ndarray_view<Dim, T>::assign(const ndarray_view<Dim, T2>& other) const {
 	// converting assignment
 	Assert_crit(shape() == other.shape(), "ndarray_view must have same shape for assignment");
-	if(shape().product() == 0) return;
-	std::copy(other.begin(), other.end(), begin());
+	ndarray_copy(other, *this);
 }
 
 
 template<std::size_t Dim, typename T>
 void ndarray_view<Dim, T>::assign(const ndarray_view<Dim, const T>& other) const {
-	// assignment without conversion
-	
+	// assignment without conversion, uses memcpy on contiguous runs if possible
 	Assert_crit(shape() == other.shape(), "ndarray_view must have same shape for assignment");
-	if(shape().product() == 0) return;
-	
-	if(std::is_pod<T>::value && strides() == other.strides() && has_default_strides()) {
-		// optimize when possible
-		const ndarray_format& array_format = format(*this);
-		Assert_crit(array_format == format(other));
-		ndarray_data_copy(static_cast<void*>(start()), static_cast<const void*>(other.start()), array_format);
-	} else {
-		std::copy(other.begin(), other.end(), begin());
-	}
+	ndarray_copy(other, *this);
 }
 
 
 template<std::size_t Dim, typename T> template<typename T2>
 bool ndarray_view<Dim, T>::compare(const ndarray_view<Dim, T2>& other) const {
-	if(shape() != other.shape()) return false;
-	else return std::equal(other.begin(), other.end(), begin());
+	return ndarray_equal(*this, other);
 }
 
 
@@ -191,20 +178,7 @@ template<std::size_t Dim, typename T>
 bool ndarray_view<Dim, T>::compare(const ndarray_view<Dim, const T>& other) const {
 	if(shape() != other.shape()) return false;
 	else if(same(*this, other)) return true;
-
-	if(std::is_pod<T>::value && strides() == other.strides() && has_default_strides()) {
-		const ndarray_format& array_format = format(*this);
-		Assert_crit(array_format == format(other));
-		return ndarray_data_compare
-			(static_cast<const void*>(start()), static_cast<const void*>(other.start()), array_format);
-	} else {
-		return std::equal(other.begin(), other.end(), begin());
-	}
-	
-	
-	if(shape() != other.shape()) return false;
-	else if(same(*this, other)) return true;
-	else return std::equal(other.begin(), other.end(), begin());
+	else return ndarray_equal(*this, other);
 }
 
 
@@ -85,6 +85,47 @@ auto ndarray_opaque_frame_format::add_part(const ndarray_format& new_part_format
 	update_frame_size_with_end_padding_();
 	return parts_.back();
 }
+
+
+void ndarray_opaque_frame_format::add_parts(const ndarray_opaque_frame_format& frm) {
+	Expects(frm.is_defined() && ! frm.is_raw());
+	
+	std::ptrdiff_t start_offset = 0;
+	if(parts_.size() > 0) {
+		const part& previous_part = parts_.back();
+		std::ptrdiff_t min_offset = previous_part.offset + previous_part.format.frame_size();
+		std::ptrdiff_t alignment_requirement = frm.frame_alignment_requirement();
+		if(is_multiple_of(min_offset, alignment_requirement)) {
+			start_offset = min_offset;
+		} else {
+			start_offset = (1 + (min_offset / alignment_requirement)) * alignment_requirement;
+			contiguous_ = false;
+		}
+	}
+	if(! frm.is_contiguous()) contiguous_ = false;
+	
+	for(const part& frm_part : frm.parts_) parts_.push_back({ start_offset + frm_part.offset, frm_part.format });
+	frame_size_without_end_padding_ = start_offset + frm.frame_size_without_end_padding_;
+	frame_alignment_requirement_ = lcm(frame_alignment_requirement_, frm.frame_alignment_requirement_);
+	update_frame_size_with_end_padding_();
+}
+
+
+ndarray_opaque_frame_format ndarray_opaque_frame_format::extract_parts
+(std::ptrdiff_t first_part_index, std::size_t count) const {
+	std::ptrdiff_t end_part_index = first_part_index + count;
+	Expects(count > 0 && first_part_index >= 0 && end_part_index <= std::ptrdiff_t(parts_count()));
+	if(count == 1) return ndarray_opaque_frame_format(part_at(first_part_index).format);
+	
+	std::ptrdiff_t base_offset = part_at(first_part_index).offset;
+	ndarray_opaque_frame_format frm;
+	for(std::ptrdiff_t part_index = first_part_index; part_index < end_part_index; ++part_index) {
+		const part& added_part = frm.add_part(part_at(part_index).format);
+		Assert(added_part.offset == part_at(part_index).offset - base_offset,
+			"extracted parts must keep their relative offsets");
+	}
+	return frm;
+}
 	
 
 bool operator==(const ndarray_opaque_frame_format& a, const ndarray_opaque_frame_format& b) {
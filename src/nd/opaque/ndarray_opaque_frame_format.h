@@ -56,6 +56,16 @@ public:
 	
 	const part& add_part(const ndarray_format& format);
 	
+	/// Append all parts of \a frm.
+	/** The first appended part is placed at an offset that is a multiple of the alignment requirement of \a frm, so
+	 ** that the appended parts keep their offsets relative to each other. */
+	void add_parts(const ndarray_opaque_frame_format& frm);
+	
+	/// Frame format consisting of \a count parts starting at \a first_part_index, with offsets relative to first.
+	/** The returned format describes the same memory layout, when its frames start at the first extracted part.
+	 ** For one part, it is the single-part format of that part. */
+	ndarray_opaque_frame_format extract_parts(std::ptrdiff_t first_part_index, std::size_t count) const;
+	
 	std::size_t frame_size() const noexcept { return frame_size_with_end_padding_; }
 	std::size_t frame_alignment_requirement() const noexcept { return frame_alignment_requirement_; }
 	
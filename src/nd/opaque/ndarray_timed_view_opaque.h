@@ -41,6 +41,14 @@ ndarray_timed_view_opaque<Dim, Mutable> extract_part
 }
 
 
+template<std::size_t Dim, bool Mutable>
+ndarray_timed_view_opaque<Dim, Mutable> extract_parts
+(const ndarray_timed_view_opaque<Dim, Mutable>& vw, std::ptrdiff_t first_part_index, std::size_t count) {
+	auto non_timed_vw = extract_parts(vw.non_timed(), first_part_index, count);
+	return ndarray_timed_view_opaque<Dim, Mutable>(non_timed_vw, vw.start_time());
+}
+
+
 
 template<std::size_t Opaque_dim, std::size_t Concrete_dim, typename Concrete_elem>
 auto to_opaque(const ndarray_timed_view<Concrete_dim, Concrete_elem>& concrete_view) {
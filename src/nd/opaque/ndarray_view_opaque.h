@@ -26,7 +26,9 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include "../ndarray_timed_view.h"
 #include "../../common.h"
 #include "../detail/ndarray_view_fcall.h"
+#include "../detail/ndarray_loop.h"
 #include <stdexcept>
+#include <cstring>
 
 namespace mf {
 
@@ -173,6 +175,11 @@ public:
 template<std::size_t Dim, bool Mutable>
 ndarray_view_opaque<Dim, Mutable> extract_part(const ndarray_view_opaque<Dim, Mutable>&, std::ptrdiff_t part_index);
 
+/// View to \a count consecutive parts of the frames, starting at \a first_part_index.
+template<std::size_t Dim, bool Mutable>
+ndarray_view_opaque<Dim, Mutable> extract_parts
+(const ndarray_view_opaque<Dim, Mutable>&, std::ptrdiff_t first_part_index, std::size_t count);
+
 
 /// Cast input \ref ndarray_view to opaque \ref ndarray_view_opaque with given dimension.
 template<std::size_t Opaque_dim, std::size_t Concrete_dim, typename Concrete_elem>
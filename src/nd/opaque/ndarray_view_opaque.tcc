@@ -101,16 +101,28 @@ void ndarray_view_opaque<Dim, Mutable>::assign(const ndarray_view_opaque<Dim, fa
 		// directly copy entire memory segment
 		std::memcpy(start(), vw.start(), format_.frame_size() * size());
 	} else {
-		// copy frame-by-frame, optimizing the frame copies when possible
-		auto it = base_view().begin();
-		auto it_end = base_view().end();
-		auto other_it = vw.base_view().begin();
-		for(; it != it_end; ++it, ++other_it)
-			ndarray_opaque_frame_copy(
-				static_cast<void*>(it.ptr()),
-				static_cast<const void*>(other_it.ptr()),
-				frame_format()
-			);
+		// copy run-by-run, with one memcpy for runs of adjacent contiguous frames
+		detail::ndarray_loop<Dim, 2> loop(shape(), {{ strides(), vw.strides() }});
+		const std::ptrdiff_t length = loop.run_length();
+		const std::ptrdiff_t stride = loop.run_stride(0), other_stride = loop.run_stride(1);
+		const std::ptrdiff_t frame_size = format_.frame_size();
+		if(format_.is_contiguous() && stride == frame_size && other_stride == frame_size) {
+			loop.run([&](const auto& offsets) {
+				std::memcpy(advance_raw_ptr(start(), offsets[0]), advance_raw_ptr(vw.start(), offsets[1]), length * frame_size);
+				return true;
+			});
+		} else {
+			loop.run([&](const auto& offsets) {
+				auto ptr = advance_raw_ptr(start(), offsets[0]);
+				auto other_ptr = advance_raw_ptr(vw.start(), offsets[1]);
+				for(std::ptrdiff_t i = 0; i < length; ++i) {
+					ndarray_opaque_frame_copy(static_cast<void*>(ptr), static_cast<const void*>(other_ptr), format_);
+					ptr = advance_raw_ptr(ptr, stride);
+					other_ptr = advance_raw_ptr(other_ptr, other_stride);
+				}
+				return true;
+			});
+		}
 	}
 }
 
@@ -125,20 +137,36 @@ bool ndarray_view_opaque<Dim, Mutable>::compare(const ndarray_view_opaque& vw) c
 		// directly compare entire memory segment
 		return (std::memcmp(start(), vw.start(), format_.frame_size() * size()) == 0);
 	} else {
-		// copy frame-by-frame, optimizing the frame copies when possible
-		auto it = base_view().begin();
-		auto it_end = base_view().end();
-		auto other_it = vw.base_view().begin();
-		for(; it != it_end; ++it, ++other_it) {
-			bool frame_equal = ndarray_opaque_frame_compare(
-				static_cast<const void*>(it.ptr()),
-				static_cast<const void*>(other_it.ptr()),
-				frame_format()
-			);
-			if(! frame_equal) return false;
+		// compare run-by-run, with one memcmp for runs of adjacent contiguous frames
+		detail::ndarray_loop<Dim, 2> loop(shape(), {{ strides(), vw.strides() }});
+		const std::ptrdiff_t length = loop.run_length();
+		const std::ptrdiff_t stride = loop.run_stride(0), other_stride = loop.run_stride(1);
+		const std::ptrdiff_t frame_size = format_.frame_size();
+		if(format_.is_contiguous() && stride == frame_size && other_stride == frame_size) {
+			return loop.run([&](const auto& offsets) {
+				const void* ptr = advance_raw_ptr(start(), offsets[0]);
+				const void* other_ptr = advance_raw_ptr(vw.start(), offsets[1]);
+				return (std::memcmp(ptr, other_ptr, length * frame_size) == 0);
+			});
+		} else {
+			return loop.run([&](const auto& offsets) {
+				auto ptr = advance_raw_ptr(start(), offsets[0]);
+				auto other_ptr = advance_raw_ptr(vw.start(), offsets[1]);
+				for(std::ptrdiff_t i = 0; i < length; ++i) {
+					bool frame_equal = ndarray_opaque_frame_compare(
+						static_cast<const void*>(ptr),
+						static_cast<const void*>(other_ptr),
+						format_
+					);
+					if(! frame_equal) return false;
+					ptr = advance_raw_ptr(ptr, stride);
+					other_ptr = advance_raw_ptr(other_ptr, other_stride);
+				}
+				return true;
+			});
 		}
-		return true;
-	}}
+	}
+}
 
 
 ///////////////
@@ -154,6 +182,16 @@ ndarray_view_opaque<Dim, Mutable> extract_part
 }
 
 
+template<std::size_t Dim, bool Mutable>
+ndarray_view_opaque<Dim, Mutable> extract_parts
+(const ndarray_view_opaque<Dim, Mutable>& vw, std::ptrdiff_t first_part_index, std::size_t count) {
+	const auto& first_format_part = vw.format().part_at(first_part_index);
+	auto new_start = advance_raw_ptr(vw.start(), first_format_part.offset);
+	ndarray_opaque_frame_format frm = vw.format().extract_parts(first_part_index, count);
+	return ndarray_view_opaque<Dim, Mutable>(new_start, vw.shape(), vw.strides(), frm);
+}
+
+
 template<std::size_t Opaque_dim, std::size_t Concrete_dim, typename Concrete_elem>
 auto to_opaque(const ndarray_view<Concrete_dim, Concrete_elem>& concrete_view) {
 	static_assert(Opaque_dim <= Concrete_dim,
@@ -0,0 +1,186 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "buffer_pool.h"
+#include <cstdint>
+
+namespace mf {
+
+buffer_pool& buffer_pool::instance() {
+	static buffer_pool* pool = new buffer_pool;
+	return *pool;
+}
+
+
+auto buffer_pool::heap_key_(std::size_t size) -> key {
+	return key { buffer_kind::heap, size, false, -1 };
+}
+
+
+auto buffer_pool::ring_key_(const raw_ring_allocator& allocator, std::size_t size) -> key {
+	return key { buffer_kind::ring, size, allocator.huge_pages(), allocator.numa_node() };
+}
+
+
+void* buffer_pool::acquire_(const key& k, std::size_t align) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto range = buffers_.equal_range(k);
+	for(auto it = range.first; it != range.second; ++it) {
+		lru_list_type::iterator entry_it = it->second;
+		void* buffer = entry_it->buffer;
+		if(reinterpret_cast<std::uintptr_t>(buffer) % align != 0) continue;
+		
+		buffers_.erase(it);
+		lru_list_.erase(entry_it);
+		statistics_.retained_buffers--;
+		statistics_.retained_size -= k.size;
+		statistics_.hits++;
+		return buffer;
+	}
+	statistics_.misses++;
+	return nullptr;
+}
+
+
+bool buffer_pool::retain_(const key& k, void* buffer) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if(k.size > capacity_) return false;
+	
+	shrink_(capacity_ - k.size);
+	lru_list_.push_front(entry { k, buffer });
+	buffers_.emplace(k, lru_list_.begin());
+	statistics_.retained_buffers++;
+	statistics_.retained_size += k.size;
+	return true;
+}
+
+
+void buffer_pool::release_(const entry& e) {
+	switch(e.buffer_key.kind) {
+	case buffer_kind::heap:
+		raw_allocator().raw_deallocate_unpooled(e.buffer, e.buffer_key.size);
+		break;
+	case buffer_kind::ring:
+		raw_ring_allocator(e.buffer_key.huge_pages, e.buffer_key.numa_node).raw_deallocate_unpooled(e.buffer, e.buffer_key.size);
+		break;
+	}
+}
+
+
+void buffer_pool::shrink_(std::size_t retained_size) {
+	// called with mutex_ locked
+	while(statistics_.retained_size > retained_size) {
+		const entry& e = lru_list_.back();
+		auto range = buffers_.equal_range(e.buffer_key);
+		for(auto it = range.first; it != range.second; ++it) if(it->second->buffer == e.buffer) {
+			buffers_.erase(it);
+			break;
+		}
+		statistics_.retained_buffers--;
+		statistics_.retained_size -= e.buffer_key.size;
+		release_(e);
+		lru_list_.pop_back();
+	}
+}
+
+
+void* buffer_pool::allocate(raw_allocator& allocator, std::size_t size, std::size_t align) {
+	if(size >= minimal_heap_size()) {
+		void* buffer = acquire_(heap_key_(size), align);
+		if(buffer != nullptr) return buffer;
+	}
+	return allocator.raw_allocate_unpooled(size, align);
+}
+
+
+void buffer_pool::deallocate(raw_allocator& allocator, void* buffer, std::size_t size) {
+	if(size < minimal_heap_size() || !retain_(heap_key_(size), buffer))
+		allocator.raw_deallocate_unpooled(buffer, size);
+}
+
+
+void* buffer_pool::allocate(raw_ring_allocator& allocator, std::size_t size, std::size_t align) {
+	void* buffer = acquire_(ring_key_(allocator, size), align);
+	if(buffer != nullptr) return buffer;
+	else return allocator.raw_allocate_unpooled(size, align);
+}
+
+
+void buffer_pool::deallocate(raw_ring_allocator& allocator, void* buffer, std::size_t size) {
+	if(! retain_(ring_key_(allocator, size), buffer))
+		allocator.raw_deallocate_unpooled(buffer, size);
+}
+
+
+auto buffer_pool::get_statistics() -> statistics {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return statistics_;
+}
+
+
+void buffer_pool::clear() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	shrink_(0);
+}
+
+
+std::size_t buffer_pool::capacity() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return capacity_;
+}
+
+
+void buffer_pool::set_capacity(std::size_t cap) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	capacity_ = cap;
+	shrink_(capacity_);
+}
+
+
+std::size_t buffer_pool::minimal_heap_size() {
+	return minimal_heap_size_;
+}
+
+
+void buffer_pool::set_minimal_heap_size(std::size_t size) {
+	minimal_heap_size_ = size;
+}
+
+
+void* raw_allocator::raw_allocate(std::size_t size, std::size_t align) {
+	return buffer_pool::instance().allocate(*this, size, align);
+}
+
+
+void raw_allocator::raw_deallocate(void* ptr, std::size_t size) {
+	buffer_pool::instance().deallocate(*this, ptr, size);
+}
+
+
+void* raw_ring_allocator::raw_allocate(std::size_t size, std::size_t align) {
+	return buffer_pool::instance().allocate(*this, size, align);
+}
+
+
+void raw_ring_allocator::raw_deallocate(void* ptr, std::size_t size) {
+	buffer_pool::instance().deallocate(*this, ptr, size);
+}
+
+}
@@ -0,0 +1,119 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_OS_BUFFER_POOL_H_
+#define MF_OS_BUFFER_POOL_H_
+
+#include "../common.h"
+#include "memory.h"
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <tuple>
+
+namespace mf {
+
+/// Process-wide pool of deallocated buffers, which get reused by later allocations.
+/** Used by \ref raw_allocator and \ref raw_ring_allocator. When a graph gets torn down and rebuilt with the same
+ ** frame formats, the ring buffers and arrays get the same mappings again. These are already faulted in, so that the
+ ** allocation and the page faults on first touch are avoided.
+ **
+ ** Buffers are keyed by size, kind (heap or ring), and ring allocator options. Alignment is checked on the buffer
+ ** address, so a buffer is reused for any alignment that it satisfies. Heap buffers smaller than
+ ** \ref minimal_heap_size() bypass the pool. The pool retains at most \ref capacity() bytes, and releases the least
+ ** recently deallocated buffers to the OS when that is exceeded. A capacity of 0 disables the pool. */
+class buffer_pool {
+public:
+	/// Counters of the pool.
+	struct statistics {
+		std::size_t hits = 0; ///< Allocations served by a retained buffer.
+		std::size_t misses = 0; ///< Allocations passed to the OS.
+		std::size_t retained_buffers = 0; ///< Number of buffers currently retained.
+		std::size_t retained_size = 0; ///< Total size of retained buffers, in bytes.
+	};
+
+private:
+	enum class buffer_kind { heap, ring };
+	
+	struct key {
+		buffer_kind kind;
+		std::size_t size;
+		bool huge_pages;
+		int numa_node;
+		
+		friend bool operator<(const key& a, const key& b) {
+			return std::tie(a.kind, a.size, a.huge_pages, a.numa_node) < std::tie(b.kind, b.size, b.huge_pages, b.numa_node);
+		}
+	};
+	
+	struct entry {
+		key buffer_key;
+		void* buffer;
+	};
+	
+	using lru_list_type = std::list<entry>;
+	
+	std::mutex mutex_;
+	lru_list_type lru_list_; ///< Retained buffers, most recently deallocated first.
+	std::multimap<key, lru_list_type::iterator> buffers_;
+	statistics statistics_;
+	std::size_t capacity_ = 256 * 1024 * 1024;
+	std::atomic<std::size_t> minimal_heap_size_ {64 * 1024};
+
+	buffer_pool() = default;
+	
+	static key heap_key_(std::size_t size);
+	static key ring_key_(const raw_ring_allocator&, std::size_t size);
+	
+	void* acquire_(const key&, std::size_t align);
+	bool retain_(const key&, void* buffer);
+	void release_(const entry&);
+	void shrink_(std::size_t retained_size);
+
+public:
+	/// The process-wide instance.
+	/** Never destroyed, so that buffers can be deallocated during static destruction. */
+	static buffer_pool& instance();
+	
+	buffer_pool(const buffer_pool&) = delete;
+	buffer_pool& operator=(const buffer_pool&) = delete;
+	
+	void* allocate(raw_allocator&, std::size_t size, std::size_t align);
+	void deallocate(raw_allocator&, void* buffer, std::size_t size);
+	void* allocate(raw_ring_allocator&, std::size_t size, std::size_t align);
+	void deallocate(raw_ring_allocator&, void* buffer, std::size_t size);
+	
+	statistics get_statistics();
+	
+	/// Release all retained buffers to the OS. Does not reset hit and miss counters.
+	void clear();
+	
+	std::size_t capacity();
+	void set_capacity(std::size_t);
+	
+	std::size_t minimal_heap_size();
+	void set_minimal_heap_size(std::size_t);
+};
+
+}
+
+#endif
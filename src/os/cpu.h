@@ -0,0 +1,41 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_OS_CPU_H_
+#define MF_OS_CPU_H_
+
+#include "os.h"
+
+// SIMD code paths for x86-64, compiled with function target attributes and selected at runtime
+// SSE2 is always available on x86-64
+#if defined(MF_ARCH_X86_64) && (defined(MF_COMPILER_GCC) || defined(MF_COMPILER_CLANG))
+	#define MF_X86_SIMD
+	#define MF_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace mf {
+
+/// Check if the processor supports AVX2 instructions.
+/** Always `false` when \ref MF_X86_SIMD is not defined. */
+bool cpu_supports_avx2();
+
+}
+
+#endif
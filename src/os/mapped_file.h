@@ -0,0 +1,51 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_OS_MAPPED_FILE_H_
+#define MF_OS_MAPPED_FILE_H_
+
+#include "../common.h"
+#include <string>
+#include <cstddef>
+
+namespace mf {
+
+/// Read-only memory mapping of whole file.
+/** File contents are accessible at data() for the lifetime of the object. Pages are loaded by the OS on first access,
+ ** the access pattern can be hinted using \ref set_memory_usage_advice(). */
+class mapped_file {
+private:
+	void* data_ = nullptr;
+	std::size_t size_ = 0;
+
+public:
+	explicit mapped_file(const std::string& filename);
+	~mapped_file();
+	
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+	
+	const byte* data() const noexcept { return static_cast<const byte*>(data_); }
+	std::size_t size() const noexcept { return size_; }
+};
+
+}
+
+#endif
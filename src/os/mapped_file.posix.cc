@@ -0,0 +1,69 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "os.h"
+#if defined(MF_OS_LINUX) || defined(MF_OS_DARWIN)
+
+#include "mapped_file.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <system_error>
+
+namespace mf {
+
+mapped_file::mapped_file(const std::string& filename) {
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if(fd == -1)
+		throw std::system_error(errno, std::system_category(), "mapped file open failed");
+	
+	struct stat file_stat;
+	if(::fstat(fd, &file_stat) != 0) {
+		int err = errno;
+		::close(fd);
+		throw std::system_error(err, std::system_category(), "mapped file fstat failed");
+	}
+	size_ = file_stat.st_size;
+	
+	if(size_ > 0) {
+		void* ptr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+		if(ptr == MAP_FAILED) {
+			int err = errno;
+			::close(fd);
+			throw std::system_error(err, std::system_category(), "mapped file mmap failed");
+		}
+		data_ = ptr;
+	}
+	
+	// mapping remains valid after closing file descriptor
+	::close(fd);
+}
+
+
+mapped_file::~mapped_file() {
+	if(data_ != nullptr) ::munmap(data_, size_);
+}
+
+}
+
+#endif
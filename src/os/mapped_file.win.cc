@@ -0,0 +1,74 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "os.h"
+#ifdef MF_OS_WINDOWS
+
+#include "mapped_file.h"
+#include <windows.h>
+#include <system_error>
+
+namespace mf {
+
+mapped_file::mapped_file(const std::string& filename) {
+	HANDLE file = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		throw std::system_error(::GetLastError(), std::system_category(), "mapped file open failed");
+	
+	LARGE_INTEGER file_size;
+	if(! ::GetFileSizeEx(file, &file_size)) {
+		DWORD err = ::GetLastError();
+		::CloseHandle(file);
+		throw std::system_error(err, std::system_category(), "mapped file size query failed");
+	}
+	size_ = file_size.QuadPart;
+	
+	// empty file cannot be mapped
+	if(size_ > 0) {
+		HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(mapping == nullptr) {
+			DWORD err = ::GetLastError();
+			::CloseHandle(file);
+			throw std::system_error(err, std::system_category(), "mapped file mapping failed");
+		}
+		
+		void* ptr = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		DWORD err = ::GetLastError();
+		// view remains valid after closing mapping and file handles
+		::CloseHandle(mapping);
+		if(ptr == nullptr) {
+			::CloseHandle(file);
+			throw std::system_error(err, std::system_category(), "mapped file view failed");
+		}
+		data_ = ptr;
+	}
+	
+	::CloseHandle(file);
+}
+
+
+mapped_file::~mapped_file() {
+	if(data_ != nullptr) ::UnmapViewOfFile(data_);
+}
+
+}
+
+#endif
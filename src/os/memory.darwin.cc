@@ -53,12 +53,27 @@ void set_memory_usage_advice(void* buf, std::size_t len, memory_usage_advice adv
 	case memory_usage_advice::random:
 		madvise(buf, len, MADV_RANDOM);
 		break;
+	case memory_usage_advice::will_need:
+		madvise(buf, len, MADV_WILLNEED);
+		break;
 	return;	
 	}
 }
 
 
-void* raw_allocator::raw_allocate(std::size_t size, std::size_t align) {
+std::size_t system_huge_page_size() {
+	// huge pages not used on Darwin
+	return 0;
+}
+
+
+int current_numa_node() {
+	// No NUMA support on Darwin
+	return -1;
+}
+
+
+void* raw_allocator::raw_allocate_unpooled(std::size_t size, std::size_t align) {
 	// for posix_memalign, alignment must be multiple of sizeof(void*) AND power of 2
 	std::size_t actual_align = sizeof(void*);
 	while(actual_align < align) actual_align *= 2;
@@ -71,13 +86,14 @@ void* raw_allocator::raw_allocate(std::size_t size, std::size_t align) {
 }
 
 
-void raw_allocator::raw_deallocate(void* ptr, std::size_t size) {
+void raw_allocator::raw_deallocate_unpooled(void* ptr, std::size_t size) {
 	::free(ptr);
 }
 	
 
 
-void* raw_ring_allocator::raw_allocate(std::size_t size, std::size_t align) {	
+void* raw_ring_allocator::raw_allocate_unpooled(std::size_t size, std::size_t align) {	
+	// huge pages and NUMA node options are ignored on Darwin
 	std::size_t page_size = system_page_size();
 	
 	if(size % page_size != 0) throw std::invalid_argument("size must be multiple of page size");
@@ -118,7 +134,7 @@ void* raw_ring_allocator::raw_allocate(std::size_t size, std::size_t align) {
 }
 
 
-void raw_ring_allocator::raw_deallocate(void* base, std::size_t size) {
+void raw_ring_allocator::raw_deallocate_unpooled(void* base, std::size_t size) {
 	::munmap(base, size * 2);
 }
 
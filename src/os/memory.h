@@ -30,6 +30,9 @@ namespace mf {
 /// Get page size of operating system, in bytes.
 std::size_t system_page_size();
 
+/// Get size of default huge page of operating system, in bytes, or 0 if huge pages are not supported.
+std::size_t system_huge_page_size();
+
 
 /// Round `n` up so that `T[n]` has a size that is a multiple of the system page size.
 template<typename T>
@@ -48,29 +51,75 @@ inline std::size_t raw_round_up_to_fit_system_page_size(std::size_t len) {
 enum class memory_usage_advice {
 	normal,
 	sequential,
-	random
+	random,
+	will_need ///< Memory will be accessed soon, for read-ahead of file mappings.
 };
 
 /// Provide hint to operating system on how memory at `ptr` will be accessed.
+/** `ptr` must be aligned to the system page size. */
 void set_memory_usage_advice(void* ptr, std::size_t, memory_usage_advice);
 
 
 /// Raw allocator, allocates given number of bytes.
+/** Large buffers are recycled through the process-wide \ref buffer_pool. */
 class raw_allocator {
 public:
 	void* raw_allocate(std::size_t size, std::size_t align = 1);	
 	void raw_deallocate(void* ptr, std::size_t size);
+	
+	/// Allocate directly from the OS, bypassing the \ref buffer_pool.
+	void* raw_allocate_unpooled(std::size_t size, std::size_t align = 1);	
+	void raw_deallocate_unpooled(void* ptr, std::size_t size);
 };
 
 
+/// Get NUMA node on which the calling thread is currently running, or -1 if unknown.
+int current_numa_node();
+
+
 /// Ring allocator, allocates ring buffer memory.
 /** Allocates given segment of memory, and maps additional same sized segment immediatly after it in virtual memory,
  ** which is mapped to the same allocated segment. In the allocated segment `seg`, `seg[i]` and `seg[i+n]` always
- ** map to the same data. The segment length `n` must be a multiple of the system page size. */
+ ** map to the same data. The segment length `n` must be a multiple of the system page size.
+ **
+ ** Optionally the segment can be backed by huge pages, and its physical memory can be bound to a NUMA node. Both are
+ ** hints: when the OS does not support them, or when no huge pages are available, or when `n` is not a multiple of
+ ** the huge page size, the allocator falls back to normal pages and default memory placement. Users such as \ref ring
+ ** round `n` up to \ref segment_granularity(), so that huge pages can be used.
+ **
+ ** Deallocated rings are kept in the process-wide \ref buffer_pool, and get reused by allocations of the same size
+ ** and options. */
 class raw_ring_allocator {
+private:
+	bool huge_pages_ = false;
+	int numa_node_ = -1;
+
 public:
+	raw_ring_allocator() = default;
+	explicit raw_ring_allocator(bool huge_pages, int numa_node = -1) :
+		huge_pages_(huge_pages), numa_node_(numa_node) { }
+	
+	/// Whether the allocator tries to back the segment with huge pages.
+	bool huge_pages() const noexcept { return huge_pages_; }
+	void set_huge_pages(bool huge) noexcept { huge_pages_ = huge; }
+	
+	/// NUMA node to which the allocated memory gets bound, or -1 for default placement.
+	int numa_node() const noexcept { return numa_node_; }
+	void set_numa_node(int node) noexcept { numa_node_ = node; }
+	
+	/// Size in bytes of which the segment length should be a multiple.
+	/** The huge page size if huge pages are requested and supported, otherwise the system page size. */
+	std::size_t segment_granularity() const {
+		std::size_t huge_page_size = (huge_pages_ ? system_huge_page_size() : 0);
+		return (huge_page_size != 0 ? huge_page_size : system_page_size());
+	}
+
 	void* raw_allocate(std::size_t size, std::size_t align = 1);
 	void raw_deallocate(void* ptr, std::size_t size);
+	
+	/// Allocate directly from the OS, bypassing the \ref buffer_pool.
+	void* raw_allocate_unpooled(std::size_t size, std::size_t align = 1);
+	void raw_deallocate_unpooled(void* ptr, std::size_t size);
 };
 
 
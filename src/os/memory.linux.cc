@@ -32,6 +32,9 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include <cerrno>
 #include <system_error>
 #include <stdio.h>
+#include <sys/syscall.h>
+#include <cstdio>
+#include <vector>
 
 #include "../utility/misc.h"
 
@@ -42,6 +45,22 @@ std::size_t system_page_size() {
 	return sysconf(_SC_PAGESIZE);
 }
 
+
+std::size_t system_huge_page_size() {
+	static const std::size_t size = [] {
+		std::size_t size_kb = 0;
+		FILE* meminfo = ::fopen("/proc/meminfo", "r");
+		if(meminfo == nullptr) return std::size_t(0);
+		char line[256];
+		while(::fgets(line, sizeof(line), meminfo) != nullptr)
+			if(std::sscanf(line, "Hugepagesize: %zu kB", &size_kb) == 1) break;
+		::fclose(meminfo);
+		return size_kb * 1024;
+	}();
+	return size;
+}
+
+
 void set_memory_usage_advice(void* buf, std::size_t len, memory_usage_advice adv) {
 	switch(adv) {
 	case memory_usage_advice::normal:
@@ -53,12 +72,15 @@ void set_memory_usage_advice(void* buf, std::size_t len, memory_usage_advice adv
 	case memory_usage_advice::random:
 		madvise(buf, len, MADV_RANDOM);
 		break;
+	case memory_usage_advice::will_need:
+		madvise(buf, len, MADV_WILLNEED);
+		break;
 	return;	
 	}
 }
 
 
-void* raw_allocator::raw_allocate(std::size_t size, std::size_t align) {
+void* raw_allocator::raw_allocate_unpooled(std::size_t size, std::size_t align) {
 	// for posix_memalign, alignment must be multiple of sizeof(void*) AND power of 2
 	std::size_t actual_align = sizeof(void*);
 	while(actual_align < align) actual_align *= 2;
@@ -71,54 +93,153 @@ void* raw_allocator::raw_allocate(std::size_t size, std::size_t align) {
 }
 
 
-void raw_allocator::raw_deallocate(void* ptr, std::size_t size) {
+void raw_allocator::raw_deallocate_unpooled(void* ptr, std::size_t) {
 	::free(ptr);
 }
 	
 
 
-void* raw_ring_allocator::raw_allocate(std::size_t size, std::size_t align) {	
+namespace {
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+/// Create anonymous in-memory file with memfd_create, optionally on huge pages. Returns -1 on failure.
+int create_memory_file_(std::size_t size, bool huge_pages) {
+	#ifdef SYS_memfd_create
+	unsigned flags = MFD_CLOEXEC;
+	if(huge_pages) flags |= MFD_HUGETLB;
+	int fd = ::syscall(SYS_memfd_create, "mf_ring", flags);
+	if(fd == -1) return -1;
+	if(::ftruncate(fd, size) != 0) {
+		::close(fd);
+		return -1;
+	}
+	return fd;
+	#else
+	return -1;
+	#endif
+}
+
+
+/// Map segment of file `fd` twice into contiguous virtual memory, at address aligned to `alignment`.
+/** Returns `nullptr` on failure, with `errno` set. `alignment` must be multiple of system page size. */
+void* map_ring_(int fd, std::size_t size, std::size_t alignment) {
+	std::size_t page_size = system_page_size();
+	std::size_t reserved_size = 2 * size + (alignment - page_size);
+	
+	void* reserved = ::mmap(nullptr, reserved_size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0); // ...aligns to page size
+	if(reserved == MAP_FAILED) return nullptr;
+	
+	// unmap excess before and after aligned region
+	std::uintptr_t reserved_begin = reinterpret_cast<std::uintptr_t>(reserved);
+	std::uintptr_t begin = ((reserved_begin + alignment - 1) / alignment) * alignment;
+	std::uintptr_t end = begin + 2 * size;
+	if(begin != reserved_begin) ::munmap(reserved, begin - reserved_begin);
+	if(end != reserved_begin + reserved_size) ::munmap(reinterpret_cast<void*>(end), reserved_begin + reserved_size - end);
+	void* base = reinterpret_cast<void*>(begin);
+
+	void* ptr = ::mmap(base, size, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED, fd, 0);
+	if(ptr != MAP_FAILED)
+		ptr = ::mmap(advance_raw_ptr(base, size), size, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED, fd, 0);
+	
+	if(ptr == MAP_FAILED) {
+		int err = errno;
+		::munmap(base, 2 * size);
+		errno = err;
+		return nullptr;
+	}
+	return base;
+}
+
+
+/// Bind physical memory of `base[0, size[` to NUMA node `node`. Ignores failure.
+void bind_to_numa_node_(void* base, std::size_t size, int node) {
+	#ifdef SYS_mbind
+	constexpr std::size_t bits = 8 * sizeof(unsigned long);
+	std::vector<unsigned long> node_mask(node / bits + 1, 0);
+	node_mask[node / bits] |= 1ul << (node % bits);
+	::syscall(SYS_mbind, base, size, MPOL_BIND, node_mask.data(), node_mask.size() * bits + 1, 0);
+	#endif
+}
+
+}
+
+
+int current_numa_node() {
+	#ifdef SYS_getcpu
+	unsigned cpu, node;
+	if(::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return node;
+	#endif
+	return -1;
+}
+
+
+void* raw_ring_allocator::raw_allocate_unpooled(std::size_t size, std::size_t align) {	
 	std::size_t page_size = system_page_size();
 	
 	if(size % page_size != 0) throw std::invalid_argument("size must be multiple of page size");
 	if(page_size % align != 0) throw std::invalid_argument("requested alignment must be divisor of page size"); 
 
-	int status;
-	void* ptr;
+	void* base = nullptr;
 	
-	FILE* file = ::tmpfile();
-	if(file == nullptr)
-		throw std::system_error(errno, std::system_category(), "ring allocator tmpfile failed");
+	// try huge pages, if segment length is multiple of huge page size
+	// memfd file with MFD_HUGETLB is on internal hugetlbfs mount
+	// mmap fails when not enough huge pages are available, then fall back to normal pages
+	std::size_t huge_page_size = system_huge_page_size();
+	if(huge_pages_ && huge_page_size != 0 && size % huge_page_size == 0) {
+		int fd = create_memory_file_(size, true);
+		if(fd != -1) {
+			base = map_ring_(fd, size, huge_page_size);
+			::close(fd);
+		}
+	}
 	
-	int fd = ::fileno(file);
+	// try in-memory file with normal pages, avoids disk-backed /tmp
+	if(base == nullptr) {
+		int fd = create_memory_file_(size, false);
+		if(fd != -1) {
+			base = map_ring_(fd, size, page_size);
+			::close(fd);
+		}
+	}
 	
-	status = ::ftruncate(fd, size);
-	if(status != 0)
-		throw std::system_error(errno, std::system_category(), "ring allocator ftruncate failed");
-		
-	void* base = ::mmap(nullptr, size * 2, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0); // ...aligns to page size
-	if(base == MAP_FAILED)
-		throw std::system_error(errno, std::system_category(), "ring allocator mmap failed (whole region)");
+	// fall back to temporary file
+	if(base == nullptr) {
+		FILE* file = ::tmpfile();
+		if(file == nullptr)
+			throw std::system_error(errno, std::system_category(), "ring allocator tmpfile failed");
+	
+		int fd = ::fileno(file);
+		if(::ftruncate(fd, size) != 0) {
+			int err = errno;
+			::fclose(file);
+			throw std::system_error(err, std::system_category(), "ring allocator ftruncate failed");
+		}
 		
-	assert(reinterpret_cast<std::uintptr_t>(base) % align == 0);
-
-	ptr = ::mmap(base, size, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED, fd, 0);
-	if(ptr == MAP_FAILED)
-		throw std::system_error(errno, std::system_category(), "ring allocator mmap failed (base)");
-
-	ptr = ::mmap(advance_raw_ptr(base, size), size, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED, fd, 0);
-	if(ptr == MAP_FAILED)
-		throw std::system_error(errno, std::system_category(), "ring allocator mmap failed (mirror)");
+		base = map_ring_(fd, size, page_size);
+		int err = errno;
+		::fclose(file);
+		if(base == nullptr)
+			throw std::system_error(err, std::system_category(), "ring allocator mmap failed");
+	}
+	
+	Assert(reinterpret_cast<std::uintptr_t>(base) % align == 0);
 	
-	status = ::close(fd);
-	if(status != 0)
-		throw std::system_error(errno, std::system_category(), "ring allocator close failed");
+	if(numa_node_ != -1) bind_to_numa_node_(base, size, numa_node_);
 	
 	return base;
 }
 
 
-void raw_ring_allocator::raw_deallocate(void* base, std::size_t size) {
+void raw_ring_allocator::raw_deallocate_unpooled(void* base, std::size_t size) {
 	::munmap(base, size * 2);
 }
 
@@ -36,11 +36,22 @@ std::size_t system_page_size() {
 	return page_size;
 }
 
+std::size_t system_huge_page_size() {
+	// huge pages not used on Windows
+	return 0;
+}
+
 void set_memory_usage_advice(void* buf, std::size_t len, memory_usage_advice adv) {
 	// Not available on Windows
 	return;
 }
 
+int current_numa_node() {
+	UCHAR node;
+	if(GetNumaProcessorNode(static_cast<UCHAR>(GetCurrentProcessorNumber()), &node)) return node;
+	else return -1;
+}
+
 }
 
 #endif
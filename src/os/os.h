@@ -33,6 +33,11 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 	#define MF_OS_LINUX
 #endif
 
+// macros for processor architecture
+#if defined(__x86_64__) || defined(_M_X64)
+	#define MF_ARCH_X86_64
+#endif
+
 // macros for compiler
 #if defined(__clang__)
 	#define MF_COMPILER_CLANG
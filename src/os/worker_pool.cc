@@ -0,0 +1,144 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace mf {
+
+/// Loop in progress, shared by the calling thread and the workers taking part in it.
+struct worker_pool::loop {
+	const std::function<loop_function_type>* function;
+	std::ptrdiff_t count;
+	std::atomic<std::ptrdiff_t> next_index {0};
+	std::atomic<std::ptrdiff_t> done_count {0};
+	std::atomic<bool> failed {false};
+	
+	std::mutex mutex;
+	std::condition_variable done_cv;
+	std::exception_ptr exception;
+};
+
+
+thread_local worker_pool::scheduler* worker_pool::this_thread_scheduler_ = nullptr;
+
+
+worker_pool& worker_pool::instance() {
+	static worker_pool* pool = new worker_pool;
+	return *pool;
+}
+
+
+worker_pool::worker_pool() {
+	unsigned concurrency = std::thread::hardware_concurrency();
+	workers_count_ = (concurrency > 1 ? concurrency - 1 : 0);
+}
+
+
+std::size_t worker_pool::workers_count() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return workers_count_;
+}
+
+
+void worker_pool::set_workers_count(std::size_t count) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	workers_count_ = count;
+}
+
+
+void worker_pool::set_this_thread_scheduler(scheduler* sched) {
+	this_thread_scheduler_ = sched;
+}
+
+
+void worker_pool::work_(loop& lp) {
+	// the function is only accessed for indices below count: the calling thread waits for these
+	std::ptrdiff_t index;
+	while((index = lp.next_index++) < lp.count) {
+		if(! lp.failed) {
+			try {
+				(*lp.function)(index);
+			} catch(...) {
+				std::lock_guard<std::mutex> lock(lp.mutex);
+				if(! lp.exception) lp.exception = std::current_exception();
+				lp.failed = true;
+			}
+		}
+		if(++lp.done_count == lp.count) {
+			std::lock_guard<std::mutex> lock(lp.mutex);
+			lp.done_cv.notify_all();
+		}
+	}
+}
+
+
+void worker_pool::thread_main_() {
+	for(;;) {
+		std::shared_ptr<loop> lp;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			wake_cv_.wait(lock, [this] { return ! loops_.empty(); });
+			lp = std::move(loops_.front());
+			loops_.pop_front();
+		}
+		work_(*lp);
+	}
+}
+
+
+void worker_pool::parallel_for(std::ptrdiff_t count, const std::function<loop_function_type>& func) {
+	if(count <= 0) return;
+	
+	std::size_t helpers_count;
+	auto lp = std::make_shared<loop>();
+	lp->function = &func;
+	lp->count = count;
+	
+	scheduler* sched = this_thread_scheduler_;
+	if(sched != nullptr) {
+		// helpers are tasks on the scheduler's threads, which hold their own reference to the loop
+		helpers_count = std::min<std::size_t>({ workers_count(), sched->helpers_count(), std::size_t(count - 1) });
+		for(std::size_t i = 0; i < helpers_count; ++i)
+			sched->schedule_helper([lp] { work_(*lp); }, i);
+	} else {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			helpers_count = std::min<std::size_t>(workers_count_, count - 1);
+			while(threads_.size() < helpers_count) {
+				threads_.emplace_back(&worker_pool::thread_main_, this);
+				threads_.back().detach();
+			}
+			for(std::size_t i = 0; i < helpers_count; ++i) loops_.push_back(lp);
+		}
+		if(helpers_count == 1) wake_cv_.notify_one();
+		else if(helpers_count > 1) wake_cv_.notify_all();
+	}
+	
+	work_(*lp);
+	
+	std::unique_lock<std::mutex> lock(lp->mutex);
+	lp->done_cv.wait(lock, [&lp] { return lp->done_count == lp->count; });
+	if(lp->exception) std::rethrow_exception(lp->exception);
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_OS_WORKER_POOL_H_
+#define MF_OS_WORKER_POOL_H_
+
+#include "../common.h"
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace mf {
+
+/// Process-wide pool of worker threads for data-parallel loops.
+/** Used by the parallel ndarray algorithms, for example inside `filter::process`. The calling thread takes part in
+ ** the loop, and only the iterations not yet started get taken by the helpers. So a loop always completes even when
+ ** all helpers are busy, and loops can be nested.
+ ** When the calling thread has a \ref scheduler, the helpers are tasks scheduled on the threads of another thread
+ ** pool instead. The `flow::executor` is the scheduler of its own threads: loops called from asynchronous nodes of
+ ** a graph run on the executor, and do not oversubscribe the processor with this pool's threads. Loops called from
+ ** other threads, such as the thread running the synchronous nodes, still use the worker threads.
+ ** Otherwise the helpers are the worker threads of this pool. They are started on first use, and their number
+ ** defaults to the hardware concurrency minus one. */
+class worker_pool {
+public:
+	using loop_function_type = void(std::ptrdiff_t);
+	class scheduler;
+
+private:
+	struct loop;
+	
+	static thread_local scheduler* this_thread_scheduler_;
+	
+	std::mutex mutex_;
+	std::condition_variable wake_cv_;
+	std::deque<std::shared_ptr<loop>> loops_;
+	std::vector<std::thread> threads_;
+	std::size_t workers_count_;
+	
+	worker_pool();
+	
+	static void work_(loop&);
+	void thread_main_();
+	
+public:
+	/// The process-wide instance.
+	/** Never destroyed, its threads stay alive until the process ends. */
+	static worker_pool& instance();
+	
+	worker_pool(const worker_pool&) = delete;
+	worker_pool& operator=(const worker_pool&) = delete;
+	
+	/// Maximal number of worker threads, not counting the calling thread.
+	std::size_t workers_count();
+	
+	/// Set maximal number of worker threads. With 0, loops get run on the calling thread only.
+	/** Already started threads are kept, but no more than \a count threads take part in a loop. Also limits the number
+	 ** of helper tasks given to a \ref scheduler. */
+	void set_workers_count(std::size_t count);
+	
+	/// Set scheduler for helpers of loops called from the calling thread, or `nullptr` to use the worker threads.
+	/** \a sched must remain valid until it is unset, or the thread ends. */
+	static void set_this_thread_scheduler(scheduler* sched);
+	
+	/// Call `func(i)` for `i` in `[0, count[`, distributed over the calling thread and the workers.
+	/** Returns once all iterations have completed. If an iteration throws an exception, the remaining iterations are
+	 ** skipped and the exception is rethrown on the calling thread. */
+	void parallel_for(std::ptrdiff_t count, const std::function<loop_function_type>& func);
+};
+
+
+/// Thread pool on which \ref worker_pool schedules the helpers of loops, instead of on its own worker threads.
+class worker_pool::scheduler {
+public:
+	virtual ~scheduler() = default;
+	
+	/// Maximal number of helper tasks for one loop, not counting the calling thread.
+	virtual std::size_t helpers_count() = 0;
+	
+	/// Schedule helper task \a task, with index \a helper_index in `[0, helpers_count()[`.
+	/** The calling thread runs the iterations not yet taken by helpers, so the task may also run late. */
+	virtual void schedule_helper(const std::function<void()>& task, std::ptrdiff_t helper_index) = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "depth_back_projection.h"
+#include "../os/cpu.h"
+
+#ifdef MF_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace mf {
+
+namespace {
+
+using back_project_function = std::ptrdiff_t(
+	const Eigen_vec4& row_term,
+	const Eigen_vec4& depth_term,
+	const Eigen_scalar* const column_terms[4],
+	const Eigen_scalar* depth,
+	point_xyz* out,
+	std::ptrdiff_t count
+);
+
+
+#ifdef MF_X86_SIMD
+
+/// Back-project contiguous row of points, 4 at a time.
+/** Returns number of points processed, the remaining points need to be processed by scalar code. Does not use FMA
+ ** instructions, so that results are identical to the scalar code path. */
+MF_TARGET_AVX2 std::ptrdiff_t back_project_avx2_(
+	const Eigen_vec4& row_term,
+	const Eigen_vec4& depth_term,
+	const Eigen_scalar* const column_terms[4],
+	const Eigen_scalar* depth,
+	point_xyz* out,
+	std::ptrdiff_t count
+) {
+	static_assert(sizeof(Eigen_scalar) == sizeof(double), "AVX2 path requires double precision Eigen_scalar");
+	static_assert(sizeof(point_xyz) == 4 * sizeof(double), "point_xyz must be 4 packed components");
+	
+	__m256d r[4], dt[4];
+	for(int c = 0; c < 4; ++c) {
+		r[c] = _mm256_set1_pd(row_term[c]);
+		dt[c] = _mm256_set1_pd(depth_term[c]);
+	}
+	const __m256d one = _mm256_set1_pd(1.0);
+	
+	std::ptrdiff_t i = 0;
+	for(; i + 4 <= count; i += 4) {
+		__m256d d = _mm256_loadu_pd(depth + i);
+		__m256d h[4];
+		for(int c = 0; c < 4; ++c)
+			h[c] = _mm256_add_pd(_mm256_add_pd(r[c], _mm256_loadu_pd(column_terms[c] + i)), _mm256_mul_pd(dt[c], d));
+		
+		// Null points (NaN depth) get all components zero
+		__m256d valid = _mm256_cmp_pd(d, d, _CMP_ORD_Q);
+		__m256d inv_w = _mm256_div_pd(one, h[3]);
+		__m256d x = _mm256_and_pd(_mm256_mul_pd(h[0], inv_w), valid);
+		__m256d y = _mm256_and_pd(_mm256_mul_pd(h[1], inv_w), valid);
+		__m256d z = _mm256_and_pd(_mm256_mul_pd(h[2], inv_w), valid);
+		__m256d w = _mm256_and_pd(one, valid);
+		
+		// Transpose 4 component vectors into 4 points
+		__m256d xy_02 = _mm256_unpacklo_pd(x, y), xy_13 = _mm256_unpackhi_pd(x, y);
+		__m256d zw_02 = _mm256_unpacklo_pd(z, w), zw_13 = _mm256_unpackhi_pd(z, w);
+		double* o = out[i].homogeneous_coordinates.data();
+		_mm256_storeu_pd(o, _mm256_permute2f128_pd(xy_02, zw_02, 0x20));
+		_mm256_storeu_pd(o + 4, _mm256_permute2f128_pd(xy_13, zw_13, 0x20));
+		_mm256_storeu_pd(o + 8, _mm256_permute2f128_pd(xy_02, zw_02, 0x31));
+		_mm256_storeu_pd(o + 12, _mm256_permute2f128_pd(xy_13, zw_13, 0x31));
+	}
+	return i;
+}
+
+#endif
+
+
+/// Select vectorized back-projection function for processor, or `nullptr` if none available.
+back_project_function* select_back_project_() {
+	#ifdef MF_X86_SIMD
+	if(sizeof(Eigen_scalar) == sizeof(double) && cpu_supports_avx2()) return &back_project_avx2_;
+	#endif
+	return nullptr;
+}
+
+
+void back_project_point_(
+	const Eigen_vec4& row_term,
+	const Eigen_vec4& depth_term,
+	const Eigen_scalar* const column_terms[4],
+	Eigen_scalar d,
+	std::ptrdiff_t i,
+	point_xyz& out
+) {
+	if(d != d) {
+		out = point_xyz();
+		return;
+	}
+	Eigen_vec4 h;
+	for(int c = 0; c < 4; ++c) h[c] = (row_term[c] + column_terms[c][i]) + depth_term[c] * d;
+	Eigen_scalar inv_w = 1.0 / h[3];
+	out.homogeneous_coordinates = Eigen_vec4(h[0] * inv_w, h[1] * inv_w, h[2] * inv_w, 1.0);
+}
+
+}
+
+
+depth_back_projection::depth_back_projection(
+	const projection_camera& cam,
+	const ndsize<2>& shape,
+	bool flipped,
+	Eigen_scalar depth_scale,
+	Eigen_scalar depth_offset
+) {
+	// Image coordinates of pixel (y, x) are (y + 0.5, x + 0.5), or (x + 0.5, y + 0.5) when flipped.
+	// The homogeneous world point is M * (u, v, depth_scale*d + depth_offset, 1).
+	const Eigen_mat4& mat = cam.image_to_world_transformation().matrix();
+	Eigen_vec4 row_axis = mat.col(flipped ? 1 : 0);
+	Eigen_vec4 column_axis = mat.col(flipped ? 0 : 1);
+	depth_term_ = mat.col(2) * depth_scale;
+	Eigen_vec4 constant_term = mat.col(3) + mat.col(2) * depth_offset;
+	
+	const std::ptrdiff_t rows = shape[0], columns = shape[1];
+	row_terms_.reserve(rows);
+	for(std::ptrdiff_t y = 0; y < rows; ++y)
+		row_terms_.push_back(constant_term + row_axis * (y + 0.5));
+	
+	for(int c = 0; c < 4; ++c) {
+		column_terms_[c].resize(columns);
+		for(std::ptrdiff_t x = 0; x < columns; ++x) column_terms_[c][x] = column_axis[c] * (x + 0.5);
+	}
+}
+
+
+void depth_back_projection::row(std::ptrdiff_t y, const Eigen_scalar* depth, const ndarray_view<1, point_xyz>& out) const {
+	static back_project_function* const back_project_simd = select_back_project_();
+	Expects(std::ptrdiff_t(out.size()) == columns());
+
+	const Eigen_vec4& row_term = row_terms_.at(y);
+	const Eigen_scalar* const column_terms[4] = {
+		column_terms_[0].data(), column_terms_[1].data(), column_terms_[2].data(), column_terms_[3].data()
+	};
+	
+	std::ptrdiff_t i = 0;
+	if(back_project_simd != nullptr && out.strides()[0] == sizeof(point_xyz))
+		i = back_project_simd(row_term, depth_term_, column_terms, depth, out.start(), columns());
+	for(; i < columns(); ++i)
+		back_project_point_(row_term, depth_term_, column_terms, depth[i], i, out[i]);
+}
+
+}
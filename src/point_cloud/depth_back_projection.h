@@ -0,0 +1,82 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_POINT_CLOUD_DEPTH_BACK_PROJECTION_H_
+#define MF_POINT_CLOUD_DEPTH_BACK_PROJECTION_H_
+
+#include "point.h"
+#include "../camera/projection_camera.h"
+#include "../camera/projection_image_camera.h"
+#include "../nd/ndarray_view.h"
+#include <vector>
+
+namespace mf {
+
+/// Batch back-projection of depth image rows to points, for a \ref projection_camera.
+/** Equivalent to `projection_camera::point(image_camera::to_image(pix), to_depth(d))` for each pixel, but the
+ ** homogeneous world point is decomposed as `row_term[y] + column_term[x] + depth_term * d`. The terms get precomputed
+ ** from `image_to_world_transformation()`, so that each pixel takes 4 multiply-adds and one division. Pixels are
+ ** processed 4 at a time using AVX2 when available.
+ ** Depth values are linear depth values, as returned by `depth_image_camera::to_depth()` applied to pixel depths.
+ ** NaN depth values produce null points. */
+class depth_back_projection {
+private:
+	Eigen_vec4 depth_term_;
+	std::vector<Eigen_vec4, Eigen::aligned_allocator<Eigen_vec4>> row_terms_;
+	std::vector<Eigen_scalar> column_terms_[4]; ///< Column term, one array per component.
+
+public:
+	/// Prepare back-projection for image of shape \a shape (rows, columns).
+	/** Depth of each pixel is `depth_scale * d + depth_offset`, where `d` is the value passed to row().
+	 ** When \a flipped, row index maps to the second image coordinate, like `image_camera::to_image()` does with
+	 ** flipped pixel coordinates. */
+	depth_back_projection(
+		const projection_camera&,
+		const ndsize<2>& shape,
+		bool flipped,
+		Eigen_scalar depth_scale = 1.0,
+		Eigen_scalar depth_offset = 0.0
+	);
+	
+	std::ptrdiff_t rows() const { return row_terms_.size(); }
+	std::ptrdiff_t columns() const { return column_terms_[0].size(); }
+	
+	/// Back-project row \a y with depth values \a depth into \a out.
+	/** \a depth and \a out must both have `columns()` elements. */
+	void row(std::ptrdiff_t y, const Eigen_scalar* depth, const ndarray_view<1, point_xyz>& out) const;
+};
+
+
+/// Back-project depth image \a depth taken by \a cam into points \a out.
+/** Pixels with depth \a null_depth become null points. Other pixel depths are mapped using
+ ** `depth_image_camera::to_depth()`. \a out must have same shape as \a depth. */
+template<typename Depth>
+void back_project(
+	const ndarray_view<2, const Depth>& depth,
+	const projection_image_camera<Depth>& cam,
+	const ndarray_view<2, point_xyz>& out,
+	Depth null_depth = 0
+);
+
+}
+
+#include "depth_back_projection.tcc"
+
+#endif
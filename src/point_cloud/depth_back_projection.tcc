@@ -0,0 +1,51 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <limits>
+
+namespace mf {
+
+template<typename Depth>
+void back_project(
+	const ndarray_view<2, const Depth>& depth,
+	const projection_image_camera<Depth>& cam,
+	const ndarray_view<2, point_xyz>& out,
+	Depth null_depth
+) {
+	Expects(depth.shape() == out.shape());
+	
+	// to_depth() is affine in pixel depth
+	const real depth_offset = cam.to_depth(0);
+	const real depth_scale = cam.to_depth(1) - depth_offset;
+	depth_back_projection projection(cam, depth.shape(), cam.pixel_coordinates_flipped(), depth_scale, depth_offset);
+	
+	const Eigen_scalar nan = std::numeric_limits<Eigen_scalar>::quiet_NaN();
+	std::vector<Eigen_scalar> depth_row(depth.shape()[1]);
+	for(std::ptrdiff_t y = 0; y < depth.shape()[0]; ++y) {
+		auto in_row = depth[y];
+		for(std::ptrdiff_t x = 0; x < in_row.size(); ++x) {
+			Depth d = in_row[x];
+			depth_row[x] = (d == null_depth ? nan : static_cast<Eigen_scalar>(d));
+		}
+		projection.row(y, depth_row.data(), out[y]);
+	}
+}
+
+}
@@ -0,0 +1,236 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "kdtree.h"
+#include "../os/worker_pool.h"
+#include <algorithm>
+#include <queue>
+#include <limits>
+
+namespace mf {
+
+namespace {
+	/// Maximal depth of traversal stack. Tree depth is logarithmic in number of points.
+	constexpr std::size_t max_depth_ = 64;
+	
+	/// Number of queries processed as one task in batched queries.
+	constexpr std::ptrdiff_t batch_block_size_ = 64;
+	
+	/// Whether \a p is inside all of \a planes. Same criterion as `view_frustum::contains(planes, box)` for corners.
+	bool planes_contain_(const view_frustum::planes_array& planes, const Eigen_vec3& p) {
+		for(const Eigen_hyperplane3& pl : planes)
+			if(pl.signedDistance(p) <= 0) return false;
+		return true;
+	}
+}
+
+
+constexpr std::size_t point_cloud_kdtree::leaf_size;
+
+
+void point_cloud_kdtree::build_() {
+	std::size_t n = entries_.size();
+	if(n == 0) return;
+
+	// Number of levels below root, such that leaves contain at most leaf_size points.
+	std::ptrdiff_t levels = 0;
+	while((n + (std::size_t(1) << levels) - 1) >> levels > leaf_size) ++levels;
+	
+	first_leaf_ = (std::ptrdiff_t(1) << levels) - 1;
+	nodes_.resize(2*first_leaf_ + 1);
+	nodes_[0].begin = 0;
+	nodes_[0].end = n;
+
+	// Nodes of one level cover disjoint ranges, and get built in parallel.
+	for(std::ptrdiff_t level = 0; level <= levels; ++level) {
+		std::ptrdiff_t first = (std::ptrdiff_t(1) << level) - 1;
+		worker_pool::instance().parallel_for(first + 1, [&](std::ptrdiff_t i) {
+			build_node_(first + i);
+		});
+	}
+}
+
+
+void point_cloud_kdtree::build_node_(std::ptrdiff_t nd) {
+	node& nod = nodes_[nd];
+	auto begin = entries_.begin() + nod.begin;
+	auto end = entries_.begin() + nod.end;
+	
+	// Tight bounding box of the node's points.
+	Eigen_vec3 min_pos = begin->position, max_pos = begin->position;
+	for(auto it = begin; it != end; ++it) {
+		min_pos = min_pos.cwiseMin(it->position);
+		max_pos = max_pos.cwiseMax(it->position);
+	}
+	nod.box = bounding_box(min_pos, max_pos);
+	if(is_leaf_(nd)) return;
+	
+	// Split at median along longest side.
+	std::ptrdiff_t axis;
+	nod.box.side_lengths().maxCoeff(&axis);
+	index_type mid = (nod.begin + nod.end) / 2;
+	std::nth_element(begin, entries_.begin() + mid, end, [axis](const entry& a, const entry& b) {
+		return (a.position[axis] < b.position[axis]);
+	});
+	
+	nodes_[2*nd + 1].begin = nod.begin;
+	nodes_[2*nd + 1].end = mid;
+	nodes_[2*nd + 2].begin = mid;
+	nodes_[2*nd + 2].end = nod.end;
+}
+
+
+void point_cloud_kdtree::append_range_(const node& nod, std::vector<index_type>& out) const {
+	for(index_type i = nod.begin; i != nod.end; ++i) out.push_back(entries_[i].index);
+}
+
+
+auto point_cloud_kdtree::radius_search(const Eigen_vec3& center, Eigen_scalar radius) const -> std::vector<index_type> {
+	std::vector<index_type> out;
+	if(nodes_.empty()) return out;
+	
+	const Eigen_scalar radius_sq = radius * radius;
+	std::ptrdiff_t stack[max_depth_];
+	std::size_t stack_size = 0;
+	stack[stack_size++] = 0;
+	while(stack_size > 0) {
+		std::ptrdiff_t nd = stack[--stack_size];
+		const node& nod = nodes_[nd];
+		if(minimal_distance_sq(center, nod.box) > radius_sq) continue;
+
+		if(maximal_distance_sq(center, nod.box) <= radius_sq) {
+			append_range_(nod, out);
+		} else if(is_leaf_(nd)) {
+			for(index_type i = nod.begin; i != nod.end; ++i)
+				if((entries_[i].position - center).squaredNorm() <= radius_sq) out.push_back(entries_[i].index);
+		} else {
+			stack[stack_size++] = 2*nd + 1;
+			stack[stack_size++] = 2*nd + 2;
+		}
+	}
+	return out;
+}
+
+
+auto point_cloud_kdtree::nearest_neighbors(const Eigen_vec3& center, std::size_t k) const -> std::vector<neighbor> {
+	std::vector<neighbor> out;
+	if(nodes_.empty() || k == 0) return out;
+	
+	// Max-heap of the k nearest points found so far.
+	std::priority_queue<neighbor> heap;
+	auto worst_distance_sq = [&]() {
+		return (heap.size() < k ? std::numeric_limits<Eigen_scalar>::infinity() : heap.top().first);
+	};
+	
+	// Depth-first, visiting nearer child first. Stack stores node index and its minimal distance.
+	std::pair<std::ptrdiff_t, Eigen_scalar> stack[max_depth_];
+	std::size_t stack_size = 0;
+	stack[stack_size++] = { 0, minimal_distance_sq(center, nodes_[0].box) };
+	while(stack_size > 0) {
+		std::ptrdiff_t nd = stack[stack_size - 1].first;
+		Eigen_scalar node_distance_sq = stack[stack_size - 1].second;
+		--stack_size;
+		if(node_distance_sq > worst_distance_sq()) continue;
+
+		const node& nod = nodes_[nd];
+		if(is_leaf_(nd)) {
+			for(index_type i = nod.begin; i != nod.end; ++i) {
+				Eigen_scalar d = (entries_[i].position - center).squaredNorm();
+				if(heap.size() < k) {
+					heap.emplace(d, entries_[i].index);
+				} else if(d < heap.top().first) {
+					heap.pop();
+					heap.emplace(d, entries_[i].index);
+				}
+			}
+		} else {
+			std::ptrdiff_t near = 2*nd + 1, far = 2*nd + 2;
+			Eigen_scalar near_distance_sq = minimal_distance_sq(center, nodes_[near].box);
+			Eigen_scalar far_distance_sq = minimal_distance_sq(center, nodes_[far].box);
+			if(far_distance_sq < near_distance_sq) {
+				std::swap(near, far);
+				std::swap(near_distance_sq, far_distance_sq);
+			}
+			stack[stack_size++] = { far, far_distance_sq };
+			stack[stack_size++] = { near, near_distance_sq };
+		}
+	}
+	
+	out.resize(heap.size());
+	for(auto it = out.rbegin(); it != out.rend(); ++it) {
+		*it = heap.top();
+		heap.pop();
+	}
+	return out;
+}
+
+
+auto point_cloud_kdtree::frustum_cull(const view_frustum& fr) const -> std::vector<index_type> {
+	std::vector<index_type> out;
+	if(nodes_.empty()) return out;
+	
+	const view_frustum::planes_array planes = fr.planes();
+	std::ptrdiff_t stack[max_depth_];
+	std::size_t stack_size = 0;
+	stack[stack_size++] = 0;
+	while(stack_size > 0) {
+		std::ptrdiff_t nd = stack[--stack_size];
+		const node& nod = nodes_[nd];
+		view_frustum::intersection inter = view_frustum::contains(planes, nod.box);
+		if(inter == view_frustum::outside_frustum) {
+			continue;
+		} else if(inter == view_frustum::inside_frustum) {
+			append_range_(nod, out);
+		} else if(is_leaf_(nd)) {
+			for(index_type i = nod.begin; i != nod.end; ++i)
+				if(planes_contain_(planes, entries_[i].position)) out.push_back(entries_[i].index);
+		} else {
+			stack[stack_size++] = 2*nd + 1;
+			stack[stack_size++] = 2*nd + 2;
+		}
+	}
+	return out;
+}
+
+
+auto point_cloud_kdtree::radius_search(const std::vector<Eigen_vec3>& centers, Eigen_scalar radius) const
+-> std::vector<std::vector<index_type>> {
+	std::vector<std::vector<index_type>> out(centers.size());
+	std::ptrdiff_t blocks = (centers.size() + batch_block_size_ - 1) / batch_block_size_;
+	worker_pool::instance().parallel_for(blocks, [&](std::ptrdiff_t block) {
+		std::ptrdiff_t end = std::min<std::ptrdiff_t>((block + 1) * batch_block_size_, centers.size());
+		for(std::ptrdiff_t i = block * batch_block_size_; i < end; ++i) out[i] = radius_search(centers[i], radius);
+	});
+	return out;
+}
+
+
+auto point_cloud_kdtree::nearest_neighbors(const std::vector<Eigen_vec3>& centers, std::size_t k) const
+-> std::vector<std::vector<neighbor>> {
+	std::vector<std::vector<neighbor>> out(centers.size());
+	std::ptrdiff_t blocks = (centers.size() + batch_block_size_ - 1) / batch_block_size_;
+	worker_pool::instance().parallel_for(blocks, [&](std::ptrdiff_t block) {
+		std::ptrdiff_t end = std::min<std::ptrdiff_t>((block + 1) * batch_block_size_, centers.size());
+		for(std::ptrdiff_t i = block * batch_block_size_; i < end; ++i) out[i] = nearest_neighbors(centers[i], k);
+	});
+	return out;
+}
+
+}
@@ -0,0 +1,112 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_POINT_CLOUD_KDTREE_H_
+#define MF_POINT_CLOUD_KDTREE_H_
+
+#include "point.h"
+#include "point_cloud.h"
+#include "../nd/ndarray_view.h"
+#include "../geometry/bounding_box.h"
+#include "../geometry/view_frustum.h"
+#include <vector>
+#include <utility>
+
+namespace mf {
+
+/// Spatial index over points of a point cloud, implicit k-d tree.
+/** The non-null point positions are copied into one array, and reordered so that each tree node covers a contiguous
+ ** range. Nodes are split at the median of the range, along the longest side of its bounding box, until they contain
+ ** at most \ref leaf_size points. Because the split position only depends on the range, the tree is complete and
+ ** implicit: children of node `i` are `2*i+1` and `2*i+2`, and nodes store only their tight bounding box. Each tree level
+ ** gets built in parallel on the \ref worker_pool.
+ ** Queries return indices of the points in the view the tree was built from. */
+class point_cloud_kdtree {
+public:
+	using index_type = std::ptrdiff_t;
+	using neighbor = std::pair<Eigen_scalar, index_type>; ///< Squared distance and index of point.
+	
+	/// Maximal number of points in a leaf node.
+	static constexpr std::size_t leaf_size = 32;
+
+private:
+	struct node {
+		bounding_box box;
+		index_type begin;
+		index_type end;
+	};
+
+	struct entry {
+		Eigen_vec3 position;
+		index_type index; ///< Index of point in original view.
+	};
+
+	std::vector<entry> entries_; ///< Points in tree order.
+	std::vector<node> nodes_;
+	std::ptrdiff_t first_leaf_ = 0; ///< Index of first leaf node.
+	
+	static const point_xyz& xyz_(const point_xyz& pt) { return pt; }
+	static const point_xyz& xyz_(const point_xyzrgb& pt) { return get<point_xyz>(pt); }
+	static const point_xyz& xyz_(const point_full& pt) { return get<point_xyz>(pt); }
+	
+	bool is_leaf_(std::ptrdiff_t nd) const { return (nd >= first_leaf_); }
+	void build_();
+	void build_node_(std::ptrdiff_t nd);
+	
+	void append_range_(const node&, std::vector<index_type>& out) const;
+	
+public:
+	template<typename Point>
+	explicit point_cloud_kdtree(const ndarray_view<1, const Point>&);
+	
+	template<typename Point>
+	explicit point_cloud_kdtree(const point_cloud<Point>& pc) :
+		point_cloud_kdtree(ndarray_view<1, const Point>(pc.view())) { }
+	
+	/// Number of non-null points in the index.
+	std::size_t size() const { return entries_.size(); }
+	
+	/// Bounding box of all points. Must not be empty.
+	const bounding_box& bounds() const { Expects(size() > 0); return nodes_.front().box; }
+
+	/// Indices of points whose distance to \a center is at most \a radius, in unspecified order.
+	std::vector<index_type> radius_search(const Eigen_vec3& center, Eigen_scalar radius) const;
+	
+	/// The \a k nearest points to \a center, sorted by increasing distance.
+	/** Returns less than \a k points if the index is smaller. */
+	std::vector<neighbor> nearest_neighbors(const Eigen_vec3& center, std::size_t k) const;
+	
+	/// Indices of points inside the view frustum \a fr, in unspecified order.
+	/** Whole subtrees are accepted or rejected using `view_frustum::contains(bounding_box)`. Points in partially
+	 ** contained leaves are tested against the frustum planes, the same way. */
+	std::vector<index_type> frustum_cull(const view_frustum& fr) const;
+
+	/// Batched \ref radius_search, processes the queries in parallel.
+	std::vector<std::vector<index_type>> radius_search(const std::vector<Eigen_vec3>& centers, Eigen_scalar radius) const;
+
+	/// Batched \ref nearest_neighbors, processes the queries in parallel.
+	std::vector<std::vector<neighbor>> nearest_neighbors(const std::vector<Eigen_vec3>& centers, std::size_t k) const;
+};
+
+}
+
+#include "kdtree.tcc"
+
+#endif
@@ -33,6 +33,8 @@ private:
 public:
 	explicit point_cloud(const ndarray_view<1, Point>& arr) :
 		view_(arr) { }
+	
+	const ndarray_view<1, Point>& view() const { return view_; }
 };
 
 }
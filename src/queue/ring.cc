@@ -27,14 +27,14 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 namespace mf {
 		
 
-ring::ring(const frame_format_type& frm, std::size_t capacity) :
-	base(make_ndsize(capacity), frm, adjust_padding_(frm, capacity)) { }
+ring::ring(const frame_format_type& frm, std::size_t capacity, const raw_ring_allocator& allocator) :
+	base(make_ndsize(capacity), frm, adjust_padding_(frm, capacity, allocator.segment_granularity()), allocator) { }
 
 
-std::size_t ring::adjust_padding_(const frame_format_type& frm, std::size_t capacity) {
+std::size_t ring::adjust_padding_(const frame_format_type& frm, std::size_t capacity, std::size_t granularity) {
 	std::size_t array_length = capacity; // array length, = number of frames
 	std::size_t frame_size = frm.frame_size(); // frame size, in bytes
-	std::size_t page_size = system_page_size(); // system page size, in bytes
+	std::size_t page_size = granularity; // segment granularity: system page size, or huge page size, in bytes
 
 	std::size_t a = frm.frame_alignment_requirement(); // a = alignment of elements
 
@@ -72,7 +72,7 @@ std::size_t ring::adjust_padding_(const frame_format_type& frm, std::size_t capa
 }
 
 
-auto ring::section_(time_unit start, time_unit duration) -> section_view_type {
+auto ring::section(time_unit start, time_unit duration) -> section_view_type {
 	Assert(duration <= capacity());
 		
 	auto new_start = advance_raw_ptr(base::start(), base::strides().front() * start);
@@ -98,7 +98,7 @@ time_unit ring::writable_duration() const {
 auto ring::begin_write(time_unit duration) -> section_view_type {
 	if(duration > capacity()) throw std::invalid_argument("write duration larger than ring capacity");
 	else if(duration > writable_duration()) throw sequencing_error("write duration larger than writable frames");
-	else return section_(write_position_, duration);
+	else return section(write_position_, duration);
 }
 
 
@@ -113,7 +113,7 @@ void ring::end_write(time_unit written_duration) {
 auto ring::begin_read(time_unit duration) -> section_view_type {
 	if(duration > capacity()) throw std::invalid_argument("read duration larger than ring capacity");
 	else if(duration > readable_duration()) throw sequencing_error("read duration larger than readable frames");
-	else return section_(read_position_, duration);
+	else return section(read_position_, duration);
 }
 
 
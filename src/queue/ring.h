@@ -41,11 +41,12 @@ private:
 	time_unit write_position_ = 0;
 	bool full_ = false;
 		
-	static std::size_t adjust_padding_(const frame_format_type&, std::size_t capacity); 
-	section_view_type section_(time_unit start, time_unit duration);
+	/// Padding between frames, such that the ring size is a multiple of \a granularity.
+	/** \a granularity is the segment granularity of the allocator, which is a power of 2. */
+	static std::size_t adjust_padding_(const frame_format_type&, std::size_t capacity, std::size_t granularity);
 
 public:
-	ring(const frame_format_type&, std::size_t capacity);
+	ring(const frame_format_type&, std::size_t capacity, const raw_ring_allocator& = raw_ring_allocator());
 	
 	ring(const ring&) = delete;
 	ring& operator=(const ring&) = delete;
@@ -64,6 +65,10 @@ public:
 	void end_read(time_unit read_duration);
 		
 	void skip(time_unit duration);
+	
+	/// Section of \a duration frames starting at ring position \a start, ignoring read and write positions.
+	/** May wrap around the end of the buffer. Used by \ref shared_ring, which keeps track of positions itself. */
+	section_view_type section(time_unit start, time_unit duration);
 };
 
 
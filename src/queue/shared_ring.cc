@@ -20,18 +20,116 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 
 #include "shared_ring.h"
 #include <algorithm>
+#include <thread>
 
 namespace mf {
 
+namespace {
+	/// Number of times a thread polls for frames to become available, before it blocks on condition variable.
+	constexpr int spin_iterations_ = 200;
+
+	template<typename Condition>
+	bool spin_until_(Condition&& cond) {
+		for(int i = 0; i < spin_iterations_; ++i) {
+			if(cond()) return true;
+			std::this_thread::yield();
+		}
+		return cond();
+	}
+}
+
+
 shared_ring::shared_ring
-(const ring::frame_format_type& frm, std::size_t capacity, time_unit end_time) :
-	ring_(frm, capacity, end_time)
+(const ring::frame_format_type& frm, std::size_t capacity, time_unit end_time, const raw_ring_allocator& allocator) :
+	ring_(frm, capacity, allocator),
+	end_time_(end_time)
 { 
 	reader_keep_waiting_.test_and_set();
 	writer_keep_waiting_.test_and_set();
 }
 
 
+time_unit shared_ring::readable_duration_(time_unit read_start) const {
+	return std::max<time_unit>(write_start_time_ - read_start, 0);
+}
+
+
+time_unit shared_ring::writable_duration_(time_unit write_start) const {
+	time_unit end = read_start_time_ + capacity();
+	if(end_time_ != undefined_time) end = std::min(end, end_time_);
+	// can be negative when read while reader seek()s to other time
+	return std::max<time_unit>(end - write_start, 0);
+}
+
+
+time_unit shared_ring::truncate_duration_(time_unit start, time_unit duration) const {
+	if(end_time_ != undefined_time && start + duration > end_time_) return std::max<time_unit>(end_time_ - start, 0);
+	else return duration;
+}
+
+
+auto shared_ring::section_(time_unit start, time_unit duration) -> section_view_type {
+	return section_view_type(ring_.section(start % capacity(), duration), start);
+}
+
+
+bool shared_ring::writer_try_access_(time_unit write_start) {
+	// seek() sets seek_pending_ before testing writer_state_, and writer sets writer_state_ before testing
+	// seek_pending_ (both sequentially consistent): so either seek() waits for end_write(), or writer backs off
+	writer_state_ = accessing;
+	if(! seek_pending_ && write_start_time_ == write_start) return true;
+	
+	writer_state_ = idle;
+	notify_reader_(); // seek() may be waiting for writer
+	return false;
+}
+
+
+void shared_ring::notify_reader_() {
+	// waiting thread sets its state before (re)testing its condition with mutex_ locked, so after the
+	// notifying thread changed the condition, either the waiter sees the change, or it is seen waiting here
+	if(reader_is_waiting_() || seek_pending_) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		readable_cv_.notify_one();
+	}
+}
+
+
+void shared_ring::notify_writer_() {
+	// c.f. notify_reader_()
+	if(writer_is_waiting_()) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		writable_cv_.notify_one();
+	}
+}
+
+
+template<typename Condition>
+bool shared_ring::wait_(std::unique_lock<std::mutex>& lock, std::atomic<thread_state>& state, time_unit frames,
+std::condition_variable& cv, std::atomic_flag& keep_waiting, Condition&& cond) {
+	// mark as waiting: other thread notifies cv, and can detect deadlocks
+	state = frames;
+
+	// spin without mutex first: avoids blocking when other thread is about to make the frames available
+	lock.unlock();
+	spin_until_(cond);
+	lock.lock();
+	
+	for(;;) {
+		// test if break event occured
+		if(! keep_waiting.test_and_set()) {
+			state = idle;
+			return false;
+		}
+		if(cond()) break;
+		cv.wait(lock);
+	}
+	
+	state = idle;
+	return true;
+}
+
+
 void shared_ring::break_reader() {
 	std::lock_guard<std::mutex> lock(mutex_);
 	if(reader_is_waiting_()) {
@@ -50,122 +148,99 @@ void shared_ring::break_writer() {
 }
 
 
-auto shared_ring::begin_write(time_unit original_duration) -> section_view_type {
+auto shared_ring::begin_write_(time_unit original_duration, bool wait) -> section_view_type {
 	Assert(original_duration <= capacity());
 	if(writer_state_ != idle) throw sequencing_error("writer not idle");
 
-	std::unique_lock<std::mutex> lock(mutex_);
-locked:
-
-	// write start position
-	// if writer needs to wait (during which mutex gets unlocked),
-	// then reader may seek to another position and write_start will change again...
-	time_unit write_start = ring_.write_start_time();
-
-	// truncate write span if near end
-	time_unit duration = original_duration;
-	if(ring_.end_time() != undefined_time)
-		if(write_start + duration > end_time()) duration = end_time() - write_start;
-
+	// fast path: frames are writable, no need to lock mutex
+	time_unit write_start = write_start_time_;
+	time_unit duration = truncate_duration_(write_start, original_duration);
+	
 	// if duration zero (possibly because at end), return zero-length view
-	if(duration == 0) return ring_.begin_write(0);
+	if(duration == 0) return section_(write_start, 0);
 
-	// prevent deadlock
-	// c.f. begin_read_span
-	time_unit readable = ring_.readable_duration();
-	if(ring_.writable_duration() < duration && readable < frames_reader_waits_for_())
-		throw sequencing_error("deadlock detected: ring buffer reader was already waiting");
+	if(writable_duration_(write_start) >= duration) {
+		if(writer_try_access_(write_start)) return section_(write_start, duration);
+	} else if(! wait) {
+		return section_view_type::null();
+	}
+	
+	// slow path: need to wait for frames to become writable, or for seek() to end
+	std::unique_lock<std::mutex> lock(mutex_);
+	for(;;) {
+		// seek() may be waiting (with mutex unlocked) for writer to end access
+		// let it change the write start time first
+		writable_cv_.wait(lock, [&] { return ! seek_pending_; });
+	
+		// write start position
+		// if writer needs to wait (during which mutex gets unlocked),
+		// then reader may seek to another position and write_start will change again...
+		write_start = write_start_time_;
+		duration = truncate_duration_(write_start, original_duration);
+		if(duration == 0) return section_(write_start, 0);
+		
+		if(writable_duration_(write_start) >= duration) break;
+		else if(! wait) return section_view_type::null();
 
-	while(ring_.writable_duration() < duration) {
-		// wait for more frames to become available
-		writer_state_ = duration;
-		writable_cv_.wait(lock);
+		// prevent deadlock
+		// c.f. begin_read_
+		if(readable_duration_(read_start_time_) < frames_reader_waits_for_())
+			throw sequencing_error("deadlock detected: ring buffer reader was already waiting");
 		
-		// writable_cv_ woke up: either:
-		// - 1+ frame was read
-		// - reader seeked
+		// wait until either:
+		// - enough frames were read
+		// - reader seeked: then retry with the new write position
 		// - break event occured
-		// - spurious wakeup
-		
-		// test if writer break event occured
-		if(! writer_keep_waiting_.test_and_set()) {
-			writer_state_ = idle;
-			return section_view_type::null();
-		}
-		
-		// reader may now have seeked to other time
-		if(ring_.write_start_time() != write_start) {			
-			// then retry with the new write position
-			// only seek() changes write position (on reader thread), so no risk of repeated recursion
-			
-			// avoid recursive call (or loop),
-			// as it would require brief unlock with incorrect writer_state_
-			writer_state_ = idle;
-			goto locked;
-		}
+		auto writable_or_seeked = [&] {
+			return (write_start_time_ != write_start) || (writable_duration_(write_start) >= duration);
+		};
+		bool cont = wait_(lock, writer_state_, duration, writable_cv_, writer_keep_waiting_, writable_or_seeked);
+		if(! cont) return section_view_type::null();
 	}
 
-	// mutex_ is still locked
+	// mutex_ is still locked, and no seek() is ongoing: write start time cannot change now
 	writer_state_ = accessing;
-	return ring_.begin_write(duration);
+	return section_(write_start, duration);
 }
 
 
-auto shared_ring::try_begin_write(time_unit original_duration) -> section_view_type {
-	Assert(original_duration <= capacity());
-	if(writer_state_ != idle) throw sequencing_error("writer not idle");
-
-	std::unique_lock<std::mutex> lock(mutex_);
-
-	time_unit write_start = ring_.write_start_time();
-
-	time_unit duration = original_duration;
-	if(end_time() != -1)
-		if(write_start + duration > end_time()) duration = end_time() - write_start;
-
-	if(ring_.writable_duration() < duration) return section_view_type::null();
+auto shared_ring::begin_write(time_unit duration) -> section_view_type {
+	return begin_write_(duration, true);
+}
 
-	section_view_type vw = ring_.begin_write(duration);
 
-	writer_state_ = accessing;
-	return vw;
+auto shared_ring::try_begin_write(time_unit duration) -> section_view_type {
+	return begin_write_(duration, false);
 }
 
 
 bool shared_ring::wait_writable() {
 	if(writer_state_ != idle) throw sequencing_error("writer not idle");
+	
+	if(writable_duration_(write_start_time_) > 0) return true;
 
 	std::unique_lock<std::mutex> lock(mutex_);
 	
-	if(ring_.writable_duration() == 0 && ring_.readable_duration() < frames_reader_waits_for_())
+	if(writable_duration_(write_start_time_) == 0 && readable_duration_(read_start_time_) < frames_reader_waits_for_())
 		throw sequencing_error("deadlock detected: ring buffer reader was already waiting");
 
-	while(ring_.writable_time_span().duration() == 0) {
-		writer_state_ = 1;
-		writable_cv_.wait(lock);
-		
-		if(! writer_keep_waiting_.test_and_set()) {
-			writer_state_ = idle;
-			return false;		
-		}
-	}
-	
-	writer_state_ = idle;
-	return true;
+	auto writable = [&] { return (writable_duration_(write_start_time_) > 0); };
+	return wait_(lock, writer_state_, 1, writable_cv_, writer_keep_waiting_, writable);
 }
 
 
 void shared_ring::end_write(time_unit written_duration) {
-	if(writer_state_ == idle) throw sequencing_error("was not writing");
-	
-	{
-		std::lock_guard<std::mutex> lock(mutex_);
-		ring_.end_write(written_duration);
-	}
+	if(writer_state_ != accessing) throw sequencing_error("was not writing");
 	
+	// writer is accessing, so seek() cannot change write start time
+	time_unit write_start = write_start_time_;
+	if(written_duration > writable_duration_(write_start))
+		throw std::invalid_argument("reported written duration too large");
+
+	write_start_time_ = write_start + written_duration;
 	writer_state_ = idle;
 	
-	readable_cv_.notify_one();	
+	notify_reader_();
 	// notify even if no frame was written:
 	// seek() waits for writer to finish
 }
@@ -185,101 +260,100 @@ auto shared_ring::begin_read_span(time_span span) -> section_view_type {
 }
 
 
-auto shared_ring::begin_read(time_unit original_duration) -> section_view_type {
+auto shared_ring::begin_read_(time_unit original_duration, bool wait) -> section_view_type {
 	Assert(original_duration <= capacity());
 	if(reader_state_ != idle) throw sequencing_error("reader not idle");
 
-	// lock mutex for buffer state
-	std::unique_lock<std::mutex> lock(mutex_);
-
 	// truncate read duration if near end
 	// if end time not defined: buffer is not seekable, and so end can only by marked by writer (end_write).
 	// then if span is not readable yet, will need to recheck after waiting for additional frames
-	time_unit duration = original_duration;
-	if(end_time() != -1)
-		if(read_start_time_ + duration > end_time()) duration = end_time() - read_start_time_;
+	time_unit read_start = read_start_time_;
+	time_unit duration = truncate_duration_(read_start, original_duration);
 
 	// if duration zero (possibly because at end), return zero view
-	if(duration == 0) return ring_.begin_read(0);
+	if(duration == 0) return section_(read_start, 0);
 	
-	// prevent deadlock
-	// it is not sufficient to have a single writer_state_ == waiting state:
-	// need to store for how many frames the writer is waiting, and verify here if the wait is still necessary.
-	if(ring_.writable_duration() < frames_writer_waits_for_() && ring_.readable_duration() < duration)
-		throw sequencing_error("deadlock detected: ring buffer writer was already waiting");
-
-	// wait until duration becomes readable
-	while(ring_.readable_duration() < duration) {
-		reader_state_ = duration;
-		// wait until more frames written (mutex unlocked during wait, and relocked after)
+	if(readable_duration_(read_start) < duration) {
+		if(! wait) return section_view_type::null();
 		
-		readable_cv_.wait(lock);
+		std::unique_lock<std::mutex> lock(mutex_);
 		
-		if(! reader_keep_waiting_.test_and_set()) {
-			reader_state_ = idle;
-			return section_view_type::null();
-		}
+		// prevent deadlock
+		// it is not sufficient to have a single writer_state_ == waiting state:
+		// need to store for how many frames the writer is waiting, and verify here if the wait is still necessary.
+		if(writable_duration_(write_start_time_) < frames_writer_waits_for_()
+		&& readable_duration_(read_start) < duration)
+			throw sequencing_error("deadlock detected: ring buffer writer was already waiting");
+
+		// wait until duration becomes readable
+		auto readable = [&] { return (readable_duration_(read_start) >= duration); };
+		bool cont = wait_(lock, reader_state_, duration, readable_cv_, reader_keep_waiting_, readable);
+		if(! cont) return section_view_type::null();
 	}
 	
 	reader_state_ = accessing;
-	return ring_.begin_read(duration);
+	return section_(read_start, duration);
 }
 
 
+auto shared_ring::begin_read(time_unit duration) -> section_view_type {
+	return begin_read_(duration, true);
+}
 
-auto shared_ring::try_begin_read(time_unit original_duration) -> section_view_type {
-	Assert(original_duration <= capacity());
-	if(reader_state_ != idle) throw sequencing_error("reader not idle");
 
-	// lock mutex for buffer state
-	std::unique_lock<std::mutex> lock(mutex_);
+auto shared_ring::try_begin_read(time_unit duration) -> section_view_type {
+	return begin_read_(duration, false);
+}
 
-	// truncate read duration if near end
-	time_unit duration = original_duration;
-	if(end_time() != -1)
-		if(read_start_time_ + duration > end_time()) duration = end_time() - read_start_time_;
+
+bool shared_ring::wait_readable() {
+	if(reader_state_ != idle) throw sequencing_error("read not idle");
 	
-	if(ring_.readable_duration() < duration) return section_view_type::null();
+	if(readable_duration_(read_start_time_) > 0) return true;
 	
-	section_view_type vw = ring_.begin_read(duration);
-	reader_state_ = accessing;
-	return vw;
-}
+	std::unique_lock<std::mutex> lock(mutex_);
+	
+	if(writable_duration_(write_start_time_) < frames_writer_waits_for_() && readable_duration_(read_start_time_) == 0)
+		throw sequencing_error("deadlock detected: ring buffer writer was already waiting");
 
+	auto readable = [&] { return (readable_duration_(read_start_time_) > 0); };
+	wait_(lock, reader_state_, 1, readable_cv_, reader_keep_waiting_, readable);
 
+	return (readable_duration_(read_start_time_) > 0);
+}
 
-bool shared_ring::wait_readable() {
+
+bool shared_ring::wait_readable(time_unit original_duration, const std::function<bool()>& stop) {
+	Assert(original_duration <= capacity());
 	if(reader_state_ != idle) throw sequencing_error("read not idle");
 	
+	time_unit read_start = read_start_time_;
+	time_unit duration = truncate_duration_(read_start, original_duration);
+	auto readable = [&] { return (readable_duration_(read_start) >= duration); };
+	if(readable()) return true;
+	
 	std::unique_lock<std::mutex> lock(mutex_);
 	
-	if(ring_.writable_duration() < frames_writer_waits_for_() && ring_.readable_duration() == 0)
+	if(writable_duration_(write_start_time_) < frames_writer_waits_for_() && ! readable())
 		throw sequencing_error("deadlock detected: ring buffer writer was already waiting");
 
-	while(ring_.readable_duration() == 0) {
-		reader_state_ = 1;
-		
-		readable_cv_.wait(lock);
-		if(! reader_keep_waiting_.test_and_set()) break;
-	}
-	
-	reader_state_ = idle;
-	return (ring_.readable_duration() > 0);
+	auto readable_or_stop = [&] { return readable() || stop(); };
+	wait_(lock, reader_state_, duration, readable_cv_, reader_keep_waiting_, readable_or_stop);
+
+	return readable();
 }
 
 
 void shared_ring::end_read(time_unit read_duration) {
 	if(reader_state_ != accessing) throw sequencing_error("was not reading");
 	
-	{
-		std::lock_guard<std::mutex> lock(mutex_);
-		
-		ring_.end_read(read_duration);
-		read_start_time_ += read_duration;
-		Assert(read_start_time_ == ring_.read_start_time());	
-	}
+	time_unit read_start = read_start_time_;
+	if(read_duration > readable_duration_(read_start)) throw sequencing_error("reported read duration too large");
+	
+	read_start_time_ = read_start + read_duration;
 	reader_state_ = idle;
-	writable_cv_.notify_one();
+	
+	notify_writer_();
 }
 
 
@@ -298,49 +372,46 @@ bool shared_ring::can_seek(time_unit target_time) const {
 
 
 void shared_ring::seek(time_unit t) {	
-	Assert(t <= ring_.end_time());
+	Assert(t <= end_time());
+	
+	time_unit read_start = read_start_time_;
 
 	// no need to do anything if already at time t
-	if(t == read_start_time_) return;
+	if(t == read_start) return;
+	
+	// target time is already in buffer: simply skip to it ("short seek")
+	// only the read start time changes, and writer never makes readable frames unreadable
+	auto already_readable = [&] { return (t > read_start) && (t < write_start_time_); };
+	if(already_readable()) {
+		read_start_time_ = t;
+		notify_writer_();
+		return;
+	}
 
 	// lock the mutex
-	// writer will not start or end while locked, and readable time span will not change
+	// writer will not start waiting, and write start time will not change while locked,
+	// unless writer is currently accessing data
 	std::unique_lock<std::mutex> lock(mutex_);
-
-	bool already_readable = ring_.readable_time_span().includes(t);
-		
-	if(!already_readable && writer_state_ == accessing) {
-		// target tile span is not in buffer, and writer is currently accessing data:
-		// need to let the writer finish writing first 
-				
-		// allow writer to write its frames
-		// works because end_write sets writer_state_ before notifying readable_cv_
-				
-		while(writer_state_ == accessing) readable_cv_.wait(lock);
-		// mutex is now locked again
-		// writer now idle, or waiting if it started another begin_write() in meantime
+	seek_pending_ = true;
 		
-		// retest if target time is now in readable span
-		already_readable = ring_.readable_time_span().includes(t);
-	}
-	
+	// allow writer to write its frames
+	// works because end_write sets writer_state_ before notifying readable_cv_
+	// writer that attempts to begin writing meanwhile backs off, c.f. writer_try_access_
+	while(writer_state_ == accessing) readable_cv_.wait(lock);
+	// mutex is now locked again
+	// writer now idle, or waiting
 	
-	if(already_readable) {
-		// target time is already in buffer: simply skip to it ("short seek")
-		time_unit skip_duration = t - read_start_time_;
-		ring_.skip(skip_duration);
-		read_start_time_ += skip_duration;
-		Assert(read_start_time_ == ring_.read_start_time());
-						
+	if(already_readable()) {
+		// target time became readable while waiting for writer
+		read_start_time_ = t;
 	} else {
-		// writer is necessarily idle or waiting now
-		Assert(writer_state_ != accessing);
-
 		// perform seek on ring buffer now ("long seek")
-		ring_.seek(t);
+		// writer reading them in between is harmless: buffer is completely writable after the seek,
+		// and writer_try_access_ fails because write_start_time_ was changed or seek_pending_ is set
+		write_start_time_ = t;
 		read_start_time_ = t;
-		Assert(read_start_time_ == ring_.read_start_time());
 	}
+	seek_pending_ = false;
 
 	// notify writer: seeked, and new writable frames
 	// if it was idle, notification is ignored
@@ -352,39 +423,34 @@ void shared_ring::seek(time_unit t) {
 
 
 time_unit shared_ring::write_start_time() const {
-	// atomic, so no need to lock
-	return ring_.write_start_time();
+	return write_start_time_;
 }
 
 
 time_unit shared_ring::read_start_time() const {
-	std::lock_guard<std::mutex> lock(mutex_);
-	return ring_.read_start_time();
-	
-	// use atomic member, instead of non-atomic ring_.read_start_time()
-	//return read_start_time_;
+	return read_start_time_;
 }
 
 
 time_span shared_ring::writable_time_span() const {
-	std::lock_guard<std::mutex> lock(mutex_);
-	return ring_.writable_time_span();
+	time_unit write_start = write_start_time_;
+	return time_span(write_start, write_start + writable_duration_(write_start));
 }
 
 
 time_span shared_ring::readable_time_span() const {
-	std::lock_guard<std::mutex> lock(mutex_);
-	return ring_.readable_time_span();
+	time_unit read_start = read_start_time_;
+	return time_span(read_start, read_start + readable_duration_(read_start));
 }
 
 
 bool shared_ring::writer_reached_end() const {
-	return (write_start_time() == ring_.end_time());
+	return (write_start_time() == end_time());
 }
 
 
 bool shared_ring::reader_reached_end() const {
-	return (read_start_time() == ring_.end_time());
+	return (read_start_time() == end_time());
 }
 
 
@@ -29,6 +29,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include <ostream>
 #include <tuple>
 #include <utility>
+#include <functional>
 
 namespace mf {
 
@@ -37,7 +38,11 @@ namespace mf {
  ** Changed semantics:
  ** - When trying to read/write more than readable/writable duration, will block until the frames become available
  **   from the other thread. Deadlocks are prevented.
- ** - If span to read, write, skip crosses end time, it gets truncated. */
+ ** - If span to read, write, skip crosses end time, it gets truncated.
+ ** Read and write start times are atomic, and the frame at time `t` is always at ring position `t % capacity`. When
+ ** the frames are available, reads and writes proceed without locking the mutex. Otherwise the thread spins briefly
+ ** and then blocks on a condition variable. The mutex is needed only for blocking waits and for seeks outside of the
+ ** readable span. */
 class shared_ring {
 public:
 	using section_view_type = timed_ring::section_view_type;
@@ -51,9 +56,10 @@ private:
 	using thread_state = time_unit;
 	enum : thread_state { idle = 0, accessing = -1 };
 
-	timed_ring ring_;
+	ring ring_;
+	const time_unit end_time_;
 
-	mutable std::mutex mutex_; ///< Protects timed_ring from concurrent access, and 
+	mutable std::mutex mutex_; ///< Protects blocking waits and seeks which change write start time.
 	std::condition_variable readable_cv_;
 	std::condition_variable writable_cv_;
 	
@@ -63,16 +69,34 @@ private:
 	std::atomic<thread_state> reader_state_{idle}; ///< Current state of reader thread. Used to prevent deadlocks.
 	std::atomic<thread_state> writer_state_{idle}; ///< Current state of writer thread. Used to prevent deadlocks.
 	
-	std::atomic<time_unit> read_start_time_{0}; ///< Absolute time corresponding to current read start time.
+	std::atomic<time_unit> read_start_time_{0}; ///< Absolute read start time. Changed only by reader.
+	std::atomic<time_unit> write_start_time_{0}; ///< Absolute write start time. Changed by writer, or by seek().
+	std::atomic<bool> seek_pending_{false}; ///< Set while seek() waits for writer to change write start time.
 		
 	bool reader_is_waiting_() const { return (reader_state_ > 0); }
 	bool writer_is_waiting_() const { return (writer_state_ > 0); }
 	time_unit frames_reader_waits_for_() const { return std::max<time_unit>(reader_state_.load(), 0); }
 	time_unit frames_writer_waits_for_() const { return std::max<time_unit>(writer_state_.load(), 0); }
 
+	time_unit readable_duration_(time_unit read_start) const;
+	time_unit writable_duration_(time_unit write_start) const;
+	time_unit truncate_duration_(time_unit start, time_unit duration) const;
+	section_view_type section_(time_unit start, time_unit duration);
+	
+	bool writer_try_access_(time_unit write_start);
+	void notify_reader_();
+	void notify_writer_();
+	
+	template<typename Condition>
+	bool wait_(std::unique_lock<std::mutex>&, std::atomic<thread_state>&, time_unit frames, std::condition_variable&,
+		std::atomic_flag& keep_waiting, Condition&&);
+	
+	section_view_type begin_write_(time_unit duration, bool wait);
+	section_view_type begin_read_(time_unit duration, bool wait);
 
 public:
-	shared_ring(const ring::frame_format_type& frm, std::size_t capacity, time_unit end_time = undefined_time);
+	shared_ring(const ring::frame_format_type& frm, std::size_t capacity, time_unit end_time = undefined_time,
+		const raw_ring_allocator& = raw_ring_allocator());
 			
 	void break_reader();
 	void break_writer();
@@ -128,6 +152,12 @@ public:
 	 ** If reader break event occured, returns `false`. Otherwise returns `true`.
 	 ** Also waits if write start position is at end time, until reader break event occurs. */
 	bool wait_readable();
+	
+	/// Wait until \a read_duration frames become readable, reader break event occurs, or \a stop returns true.
+	/** \a read_duration gets truncated if it crosses end time. \a stop is tested with the mutex locked before blocking,
+	 ** so when another thread makes it true and then calls break_reader(), the reader always stops waiting.
+	 ** Returns `true` if the frames became readable. */
+	bool wait_readable(time_unit read_duration, const std::function<bool()>& stop);
 
 	/// Begin reading frames at time span \a span.
 	/** If \a span does not start at `readable_time_span().start_time()`, seeks to `span.start_time()` first.
@@ -186,7 +216,7 @@ public:
 	time_unit readable_duration() const { return readable_time_span().duration(); }
 
 	/// End of file time. */
-	time_unit end_time() const { return ring_.end_time(); }
+	time_unit end_time() const { return end_time_; }
 		
 	/// True if writer has written last frame.
 	/** For non-seekable buffer, true after end_write() call with mark end. begin_write() returns empty view if called
@@ -199,7 +229,7 @@ public:
 	 ** current read start position as being the end. */
 	bool reader_reached_end() const;
 	
-	time_unit current_time() const { return ring_.current_time(); }
+	time_unit current_time() const { return write_start_time() - 1; }
 };
 
 
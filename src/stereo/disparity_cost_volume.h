@@ -0,0 +1,122 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MF_STEREO_DISPARITY_COST_VOLUME_H_
+#define MF_STEREO_DISPARITY_COST_VOLUME_H_
+
+#include "../common.h"
+#include "../camera/projection_image_camera.h"
+#include "../nd/ndarray.h"
+#include <cstdint>
+
+namespace mf {
+
+/// Matching cost volume of a rectified stereo pair, for each source pixel and integer disparity.
+/** Source and target camera must be rectified: same orientation and intrinsics except for the horizontal principal
+ ** point, and baseline along image X axis. Source pixel at column `x` is matched with target pixel at column
+ ** `x + zero_disparity_offset - disparity` if the source is the left camera, or `x + zero_disparity_offset + disparity`
+ ** otherwise, on the same row, clamped into the image. The zero-disparity offset is the horizontal shift of points at
+ ** infinity from source to target image, rounded to integer.
+ ** \a Cost is called as `cost(source_camera, source_pixel, target_camera, target_pixel)` and returns a `real`, with
+ ** pixel coordinates in the convention of the cameras. It can be evaluated directly using cost(), or for all pixels and
+ ** disparities using compute().
+ ** The volume has disparity-major layout `[disparity][row][column]`, so that per-disparity slices are contiguous
+ ** images. compute() evaluates the raw costs on the \ref worker_pool in bands of rows, and then aggregates each slice
+ ** over a square window using running sums, with a cost independent of the window size. */
+template<typename Cost>
+class disparity_cost_volume {
+public:
+	using camera_type = projection_image_camera<int>;
+	using cost_type = float;
+	using disparity_type = std::int32_t;
+	
+	/// Number of image rows per task when evaluating raw costs.
+	static constexpr std::ptrdiff_t band_rows = 16;
+
+private:
+	camera_type source_camera_;
+	camera_type target_camera_;
+	bool source_is_left_;
+	Cost cost_function_;
+	std::ptrdiff_t disparities_count_;
+	std::ptrdiff_t horizontal_axis_; ///< Axis of camera pixel coordinates which corresponds to image X.
+	std::ptrdiff_t zero_disparity_offset_;
+	ndsize<2> shape_; ///< Image shape (rows, columns).
+	ndarray<3, cost_type> volume_;
+	bool computed_ = false;
+	
+	std::ptrdiff_t compute_zero_disparity_offset_() const;
+	ndptrdiff<2> pixel_(std::ptrdiff_t row, std::ptrdiff_t column) const;
+	std::ptrdiff_t target_column_(std::ptrdiff_t column, std::ptrdiff_t disparity) const;
+	
+	void compute_raw_costs_(std::ptrdiff_t row_begin, std::ptrdiff_t row_end);
+	void aggregate_(std::ptrdiff_t disparity, std::ptrdiff_t radius);
+	static ndarray<2, disparity_type> winner_take_all_(const ndarray_view<3, const cost_type>&);
+
+public:
+	disparity_cost_volume(
+		const camera_type& source,
+		const camera_type& target,
+		bool source_is_left,
+		const Cost& cost,
+		std::size_t disparities_count = 64
+	);
+	
+	const camera_type& source_camera() const { return source_camera_; }
+	const camera_type& target_camera() const { return target_camera_; }
+	std::ptrdiff_t disparities_count() const { return disparities_count_; }
+	std::ptrdiff_t zero_disparity_offset() const { return zero_disparity_offset_; }
+	
+	/// Shape of disparity map, (rows, columns).
+	const ndsize<2>& shape() const { return shape_; }
+	
+	/// Target pixel matched with source pixel \a source_coord at disparity \a disparity.
+	ndptrdiff<2> target_coordinates(const ndptrdiff<2>& source_coord, std::ptrdiff_t disparity) const;
+	
+	/// Evaluate cost function for source pixel \a source_coord at disparity \a disparity.
+	real cost(const ndptrdiff<2>& source_coord, std::ptrdiff_t disparity) const;
+	
+	/// Evaluate cost function for all pixels and disparities, and aggregate over window of `2*radius + 1` pixels.
+	/** Aggregated cost is mean of the raw costs in the window, clipped at the image borders. With \a radius zero, the
+	 ** volume contains the raw costs. */
+	void compute(std::size_t radius = 2);
+	
+	bool is_computed() const { return computed_; }
+	
+	/// Aggregated cost volume, with shape (disparities, rows, columns). Must be computed.
+	ndarray_view<3, const cost_type> volume() const { Expects(computed_); return volume_.cview(); }
+
+	/// Aggregated cost for source pixel \a source_coord at disparity \a disparity. Must be computed.
+	cost_type aggregated_cost(const ndptrdiff<2>& source_coord, std::ptrdiff_t disparity) const;
+	
+	/// Disparity map with lowest aggregated cost for each pixel, with shape `shape()`. Must be computed.
+	ndarray<2, disparity_type> winner_take_all() const;
+	
+	/// Disparity map using semi-global matching over the aggregated costs. Must be computed.
+	/** Costs are accumulated along 4 paths (horizontal and vertical, both directions), with penalty \a p1 for
+	 ** disparity changes of 1 and \a p2 for larger changes between neighboring pixels. */
+	ndarray<2, disparity_type> semi_global_matching(cost_type p1, cost_type p2) const;
+};
+
+}
+
+#include "disparity_cost_volume.tcc"
+
+#endif
@@ -0,0 +1,283 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "../os/worker_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace mf {
+
+template<typename Cost>
+constexpr std::ptrdiff_t disparity_cost_volume<Cost>::band_rows;
+
+
+template<typename Cost>
+disparity_cost_volume<Cost>::disparity_cost_volume(
+	const camera_type& source,
+	const camera_type& target,
+	bool source_is_left,
+	const Cost& cost,
+	std::size_t disparities_count
+) :
+	source_camera_(source),
+	target_camera_(target),
+	source_is_left_(source_is_left),
+	cost_function_(cost),
+	disparities_count_(disparities_count),
+	horizontal_axis_(source.pixel_coordinates_flipped() ? 1 : 0)
+{
+	Expects(disparities_count > 0);
+	Expects(source.image_size() == target.image_size());
+	Expects(source.pixel_coordinates_flipped() == target.pixel_coordinates_flipped());
+	
+	const ndsize<2>& image_size = source.image_size();
+	shape_ = make_ndsize(image_size[1 - horizontal_axis_], image_size[horizontal_axis_]);
+	zero_disparity_offset_ = compute_zero_disparity_offset_();
+}
+
+
+template<typename Cost>
+std::ptrdiff_t disparity_cost_volume<Cost>::compute_zero_disparity_offset_() const {
+	// Project direction of the ray through the center pixel of the source image, as point at infinity, into target.
+	ndptrdiff<2> center = pixel_(shape_[0] / 2, shape_[1] / 2);
+	camera::image_coordinates_type c = source_camera_.to_image(center);
+	const depth_projection_parameters& dparam = source_camera_.depth_parameters();
+	real depth_span = dparam.depth_max() - dparam.depth_min();
+	Eigen_vec3 a = source_camera_.point(c, dparam.depth_min() + 0.25*depth_span);
+	Eigen_vec3 b = source_camera_.point(c, dparam.depth_min() + 0.75*depth_span);
+	Eigen_vec4 direction; direction << (b - a), 0.0;
+	Eigen_vec4 h = target_camera_.world_to_image_transformation().matrix() * direction;
+	return static_cast<std::ptrdiff_t>(std::round(h[0] / h[3] - c[0]));
+}
+
+
+template<typename Cost>
+ndptrdiff<2> disparity_cost_volume<Cost>::pixel_(std::ptrdiff_t row, std::ptrdiff_t column) const {
+	ndptrdiff<2> pix;
+	pix[horizontal_axis_] = column;
+	pix[1 - horizontal_axis_] = row;
+	return pix;
+}
+
+
+template<typename Cost>
+std::ptrdiff_t disparity_cost_volume<Cost>::target_column_(std::ptrdiff_t column, std::ptrdiff_t disparity) const {
+	std::ptrdiff_t target_column = column + zero_disparity_offset_ + (source_is_left_ ? -disparity : disparity);
+	return std::min<std::ptrdiff_t>(std::max<std::ptrdiff_t>(target_column, 0), shape_[1] - 1);
+}
+
+
+template<typename Cost>
+ndptrdiff<2> disparity_cost_volume<Cost>::target_coordinates
+(const ndptrdiff<2>& source_coord, std::ptrdiff_t disparity) const {
+	return pixel_(source_coord[1 - horizontal_axis_], target_column_(source_coord[horizontal_axis_], disparity));
+}
+
+
+template<typename Cost>
+real disparity_cost_volume<Cost>::cost(const ndptrdiff<2>& source_coord, std::ptrdiff_t disparity) const {
+	return cost_function_(source_camera_, source_coord, target_camera_, target_coordinates(source_coord, disparity));
+}
+
+
+template<typename Cost>
+void disparity_cost_volume<Cost>::compute_raw_costs_(std::ptrdiff_t row_begin, std::ptrdiff_t row_end) {
+	for(std::ptrdiff_t d = 0; d < disparities_count_; ++d)
+	for(std::ptrdiff_t y = row_begin; y < row_end; ++y) {
+		cost_type* out = &volume_[d][y][0];
+		for(std::ptrdiff_t x = 0; x < shape_[1]; ++x)
+			out[x] = cost_function_(source_camera_, pixel_(y, x), target_camera_, pixel_(y, target_column_(x, d)));
+	}
+}
+
+
+template<typename Cost>
+void disparity_cost_volume<Cost>::aggregate_(std::ptrdiff_t disparity, std::ptrdiff_t radius) {
+	const std::ptrdiff_t rows = shape_[0], columns = shape_[1];
+	ndarray_view<2, cost_type> slice = volume_[disparity];
+	
+	// Horizontal running sums, one row at a time.
+	std::vector<double> row_sums(rows * columns);
+	std::vector<cost_type> row(columns);
+	for(std::ptrdiff_t y = 0; y < rows; ++y) {
+		std::copy_n(&slice[y][0], columns, row.begin());
+		double* sums = row_sums.data() + y * columns;
+		double sum = 0.0;
+		for(std::ptrdiff_t x = 0; x < std::min(radius, columns); ++x) sum += row[x];
+		for(std::ptrdiff_t x = 0; x < columns; ++x) {
+			if(x + radius < columns) sum += row[x + radius];
+			if(x - radius - 1 >= 0) sum -= row[x - radius - 1];
+			sums[x] = sum;
+		}
+	}
+	
+	// Vertical running sums, and division by window area clipped at borders.
+	std::vector<double> column_sums(columns, 0.0);
+	for(std::ptrdiff_t y = 0; y < std::min(radius, rows); ++y)
+		for(std::ptrdiff_t x = 0; x < columns; ++x) column_sums[x] += row_sums[y * columns + x];
+	for(std::ptrdiff_t y = 0; y < rows; ++y) {
+		if(y + radius < rows)
+			for(std::ptrdiff_t x = 0; x < columns; ++x) column_sums[x] += row_sums[(y + radius) * columns + x];
+		if(y - radius - 1 >= 0)
+			for(std::ptrdiff_t x = 0; x < columns; ++x) column_sums[x] -= row_sums[(y - radius - 1) * columns + x];
+		
+		std::ptrdiff_t window_rows = std::min(y + radius, rows - 1) - std::max<std::ptrdiff_t>(y - radius, 0) + 1;
+		cost_type* out = &slice[y][0];
+		for(std::ptrdiff_t x = 0; x < columns; ++x) {
+			std::ptrdiff_t window_columns = std::min(x + radius, columns - 1) - std::max<std::ptrdiff_t>(x - radius, 0) + 1;
+			out[x] = static_cast<cost_type>(column_sums[x] / (window_rows * window_columns));
+		}
+	}
+}
+
+
+template<typename Cost>
+void disparity_cost_volume<Cost>::compute(std::size_t radius) {
+	volume_ = ndarray<3, cost_type>(make_ndsize(disparities_count_, shape_[0], shape_[1]));
+	
+	std::ptrdiff_t bands_count = (shape_[0] + band_rows - 1) / band_rows;
+	worker_pool::instance().parallel_for(bands_count, [&](std::ptrdiff_t band) {
+		compute_raw_costs_(band * band_rows, std::min<std::ptrdiff_t>((band + 1) * band_rows, shape_[0]));
+	});
+	
+	if(radius > 0) worker_pool::instance().parallel_for(disparities_count_, [&](std::ptrdiff_t d) {
+		aggregate_(d, radius);
+	});
+	
+	computed_ = true;
+}
+
+
+template<typename Cost>
+auto disparity_cost_volume<Cost>::aggregated_cost(const ndptrdiff<2>& source_coord, std::ptrdiff_t disparity) const
+-> cost_type {
+	Expects(computed_);
+	return volume_[disparity][source_coord[1 - horizontal_axis_]][source_coord[horizontal_axis_]];
+}
+
+
+template<typename Cost>
+auto disparity_cost_volume<Cost>::winner_take_all_(const ndarray_view<3, const cost_type>& vol)
+-> ndarray<2, disparity_type> {
+	const std::ptrdiff_t disparities = vol.shape()[0], rows = vol.shape()[1], columns = vol.shape()[2];
+	ndarray<2, disparity_type> disparity_map(make_ndsize(rows, columns));
+	
+	// Disparity slices are contiguous, so iterate over disparities in the outer loop, with running minimum per pixel.
+	worker_pool::instance().parallel_for(rows, [&](std::ptrdiff_t y) {
+		std::vector<cost_type> minimum(&vol[0][y][0], &vol[0][y][0] + columns);
+		disparity_type* out = &disparity_map[y][0];
+		std::fill_n(out, columns, 0);
+		for(std::ptrdiff_t d = 1; d < disparities; ++d) {
+			const cost_type* costs = &vol[d][y][0];
+			for(std::ptrdiff_t x = 0; x < columns; ++x) if(costs[x] < minimum[x]) {
+				minimum[x] = costs[x];
+				out[x] = d;
+			}
+		}
+	});
+	return disparity_map;
+}
+
+
+template<typename Cost>
+auto disparity_cost_volume<Cost>::winner_take_all() const -> ndarray<2, disparity_type> {
+	Expects(computed_);
+	return winner_take_all_(volume_.cview());
+}
+
+
+template<typename Cost>
+auto disparity_cost_volume<Cost>::semi_global_matching(cost_type p1, cost_type p2) const -> ndarray<2, disparity_type> {
+	Expects(computed_);
+	const std::ptrdiff_t disparities = disparities_count_, rows = shape_[0], columns = shape_[1];
+	const auto& vol = volume_;
+	ndarray<3, cost_type> summed(vol.shape());
+	
+	// Path cost update: L(d) = C(d) + min(L'(d), L'(d-1) + p1, L'(d+1) + p1, min L' + p2) - min L'
+	auto path_cost = [&](const cost_type* previous, std::ptrdiff_t stride, cost_type previous_min, std::ptrdiff_t d) {
+		cost_type c = previous[d * stride];
+		if(d > 0) c = std::min(c, previous[(d - 1) * stride] + p1);
+		if(d + 1 < disparities) c = std::min(c, previous[(d + 1) * stride] + p1);
+		return std::min(c, previous_min + p2) - previous_min;
+	};
+	
+	// Horizontal paths, in parallel over rows. Path costs of previous pixel are kept for all disparities.
+	worker_pool::instance().parallel_for(rows, [&](std::ptrdiff_t y) {
+		std::vector<cost_type> previous(disparities), current(disparities);
+		for(std::ptrdiff_t d = 0; d < disparities; ++d) std::fill_n(&summed[d][y][0], columns, 0.0f);
+		for(int direction : { +1, -1 }) {
+			std::ptrdiff_t x = (direction > 0 ? 0 : columns - 1);
+			for(std::ptrdiff_t d = 0; d < disparities; ++d) previous[d] = vol[d][y][x];
+			for(std::ptrdiff_t d = 0; d < disparities; ++d) summed[d][y][x] += previous[d];
+			for(x += direction; x >= 0 && x < columns; x += direction) {
+				cost_type previous_min = *std::min_element(previous.begin(), previous.end());
+				for(std::ptrdiff_t d = 0; d < disparities; ++d) {
+					current[d] = vol[d][y][x] + path_cost(previous.data(), 1, previous_min, d);
+					summed[d][y][x] += current[d];
+				}
+				std::swap(previous, current);
+			}
+		}
+	});
+	
+	// Vertical paths, in parallel over bands of columns. Path costs of previous row are kept for all disparities and
+	// columns of the band, and each disparity gets processed over the band of contiguous columns.
+	const std::ptrdiff_t band_columns = 64;
+	std::ptrdiff_t bands_count = (columns + band_columns - 1) / band_columns;
+	worker_pool::instance().parallel_for(bands_count, [&](std::ptrdiff_t band) {
+		std::ptrdiff_t x_begin = band * band_columns;
+		std::ptrdiff_t width = std::min(band_columns, columns - x_begin);
+		std::vector<cost_type> previous(disparities * width), current(disparities * width), previous_min(width);
+		for(int direction : { +1, -1 }) {
+			std::ptrdiff_t y = (direction > 0 ? 0 : rows - 1);
+			for(std::ptrdiff_t d = 0; d < disparities; ++d) {
+				const cost_type* costs = &vol[d][y][x_begin];
+				cost_type* sums = &summed[d][y][x_begin];
+				for(std::ptrdiff_t x = 0; x < width; ++x) {
+					previous[d * width + x] = costs[x];
+					sums[x] += costs[x];
+				}
+			}
+			for(y += direction; y >= 0 && y < rows; y += direction) {
+				for(std::ptrdiff_t x = 0; x < width; ++x) {
+					cost_type m = previous[x];
+					for(std::ptrdiff_t d = 1; d < disparities; ++d) m = std::min(m, previous[d * width + x]);
+					previous_min[x] = m;
+				}
+				for(std::ptrdiff_t d = 0; d < disparities; ++d) {
+					const cost_type* costs = &vol[d][y][x_begin];
+					cost_type* sums = &summed[d][y][x_begin];
+					for(std::ptrdiff_t x = 0; x < width; ++x) {
+						cost_type l = costs[x] + path_cost(previous.data() + x, width, previous_min[x], d);
+						current[d * width + x] = l;
+						sums[x] += l;
+					}
+				}
+				std::swap(previous, current);
+			}
+		}
+	});
+	
+	return winner_take_all_(summed.cview());
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/camera/projection_image_camera.h>
+#include <mf/nd/ndarray.h>
+#include <cstdint>
+#include <random>
+#include <cmath>
+
+using namespace mf;
+
+TEST_CASE("camera project_batch", "[camera][project_batch]") {
+	depth_projection_parameters dparam;
+	dparam.z_near = 1.0;
+	dparam.z_far = 20.0;
+	dparam.flip_z = false;
+	
+	Eigen_mat3 intrinsic; intrinsic <<
+		300.0, 0.0, 160.0,
+		0.0, 300.0, 120.0,
+		0.0, 0.0, 1.0;
+	projection_image_camera<std::uint16_t> cam(
+		pose(Eigen_vec3(0.5, -0.2, -3.0), Eigen_quaternion(Eigen_angleaxis(0.2, Eigen_vec3::UnitY()))),
+		intrinsic,
+		dparam,
+		make_ndsize(320, 240)
+	);
+	cam.flip_pixel_coordinates();
+	
+	const std::size_t n = 5000;
+	ndarray<1, point_xyz> points(make_ndsize(n));
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<Eigen_scalar> dist(-6.0, 6.0);
+	for(std::ptrdiff_t i = 0; i < n; ++i) {
+		if(i % 9 == 0) points[i] = point_xyz();
+		else points[i] = point_xyz(Eigen_vec3(dist(gen), dist(gen), dist(gen) + 5.0));
+	}
+	
+	ndarray<1, Eigen_vec2> coords(make_ndsize(n));
+	ndarray<1, real> depths(make_ndsize(n));
+	
+	SECTION("projection") {
+		cam.project_batch(points.cview(), coords.view(), depths.view());
+		
+		bool all_equal = true;
+		for(std::ptrdiff_t i = 0; i < n; ++i) {
+			if(points[i].is_null()) {
+				all_equal = all_equal && std::isnan(coords[i][0]) && std::isnan(coords[i][1]) && std::isnan(depths[i]);
+			} else {
+				Eigen_vec3 p = points[i].position();
+				all_equal = all_equal && coords[i].isApprox(cam.project(p), 1e-9);
+				all_equal = all_equal && (std::abs(depths[i] - cam.depth(p)) < 1e-9);
+			}
+		}
+		REQUIRE(all_equal);
+		
+		// through base class, without depth
+		ndarray<1, Eigen_vec2> coords2(make_ndsize(n));
+		const camera& base_cam = cam;
+		base_cam.project_batch(points.cview(), coords2.view());
+		REQUIRE(coords2[1] == coords[1]);
+	}
+	
+	SECTION("culling") {
+		ndarray<1, byte> mask(make_ndsize(n));
+		std::size_t retained = cam.project_batch(points.cview(), coords.view(), depths.view(), mask.view());
+		
+		std::size_t expected_retained = 0;
+		bool all_equal = true;
+		for(std::ptrdiff_t i = 0; i < n; ++i) {
+			bool expected = false;
+			if(! points[i].is_null()) {
+				Eigen_vec3 p = points[i].position();
+				Eigen_vec2 c = cam.project(p);
+				real d = cam.depth(p);
+				auto pix = cam.to_pixel(c);
+				expected = (c[0] >= 0.5 && c[1] >= 0.5 && cam.image_span().includes(pix) && d >= 0.0 && d <= 1.0);
+				if(expected) all_equal = all_equal && coords[i].isApprox(c, 1e-9);
+			}
+			all_equal = all_equal && (mask[i] == (expected ? 0xff : 0));
+			if(! expected) all_equal = all_equal && std::isnan(coords[i][0]);
+			expected_retained += expected;
+		}
+		REQUIRE(all_equal);
+		REQUIRE(retained == expected_retained);
+		REQUIRE(retained > 100);
+		REQUIRE(retained < n / 2);
+	}
+}
@@ -0,0 +1,131 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <mf/flow/executor.h>
+#include <mf/os/worker_pool.h>
+
+using namespace mf;
+using namespace mf::flow;
+
+
+TEST_CASE("executor", "[flow][executor]") {
+	SECTION("runs all tasks") {
+		std::atomic<int> counter(0);
+		{
+			executor exec(3);
+			REQUIRE(exec.workers_count() == 3);
+			for(int i = 0; i < 1000; ++i)
+				exec.submit([&] { ++counter; }, i % 7);
+		}
+		// destructor runs remaining tasks
+		REQUIRE(counter == 1000);
+	}
+	
+	SECTION("tasks submitted from tasks") {
+		std::atomic<int> counter(0);
+		std::function<void()> task;
+		{
+			executor exec(2);
+			task = [&] {
+				int n = ++counter;
+				if(n < 100) exec.submit(task);
+			};
+			exec.submit(task, 1);
+		}
+		REQUIRE(counter == 100);
+	}
+
+	SECTION("blocking task on single worker") {
+		// first task waits for second task, which gets submitted to the same worker
+		// blocking_scope lets another thread run the second task
+		executor exec(1);
+		std::mutex mut;
+		std::condition_variable cv;
+		bool first_done = false, second_done = false;
+		
+		exec.submit([&] {
+			exec.submit([&] {
+				std::lock_guard<std::mutex> lock(mut);
+				second_done = true;
+				cv.notify_all();
+			}, 0);
+			
+			executor::blocking_scope blocking;
+			std::unique_lock<std::mutex> lock(mut);
+			cv.wait(lock, [&] { return second_done; });
+			first_done = true;
+			cv.notify_all();
+		}, 0);
+		
+		std::unique_lock<std::mutex> lock(mut);
+		cv.wait(lock, [&] { return first_done; });
+		REQUIRE(second_done);
+		REQUIRE(exec.threads_count() == 2);
+	}
+	
+	SECTION("worker_pool loops on executor threads") {
+		executor exec(2);
+		std::mutex mut;
+		std::condition_variable cv;
+		std::set<std::thread::id> executor_threads, loop_threads;
+		
+		// identify the threads of both workers
+		for(thread_index i = 0; i < 2; ++i) exec.submit([&] {
+			std::unique_lock<std::mutex> lock(mut);
+			executor_threads.insert(std::this_thread::get_id());
+			cv.notify_all();
+			cv.wait(lock, [&] { return executor_threads.size() == 2; });
+		}, i);
+		
+		// helpers of the loop are tasks on the executor, not worker_pool threads
+		worker_pool& pool = worker_pool::instance();
+		std::size_t original_workers_count = pool.workers_count();
+		pool.set_workers_count(3);
+		bool done = false;
+		exec.submit([&] {
+			worker_pool::instance().parallel_for(200, [&](std::ptrdiff_t) {
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+				std::lock_guard<std::mutex> lock(mut);
+				loop_threads.insert(std::this_thread::get_id());
+			});
+			std::lock_guard<std::mutex> lock(mut);
+			done = true;
+			cv.notify_all();
+		}, 0);
+		
+		std::unique_lock<std::mutex> lock(mut);
+		cv.wait(lock, [&] { return done; });
+		pool.set_workers_count(original_workers_count);
+		REQUIRE(executor_threads.size() == 2);
+		for(std::thread::id id : loop_threads) REQUIRE(executor_threads.count(id) == 1);
+	}
+	
+	SECTION("blocking scope outside of executor") {
+		executor::blocking_scope blocking;
+	}
+}
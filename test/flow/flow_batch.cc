@@ -0,0 +1,106 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/filter/filter_graph.h>
+#include <mf/filter/filter.h>
+#include <mf/utility/misc.h>
+#include "../support/ndarray.h"
+#include "../support/flow.h"
+
+using namespace mf;
+using namespace mf::test;
+
+TEST_CASE("flow graph test: batched async", "[flow][async][batch]") {
+	flow::filter_graph gr;
+	auto shp = make_ndsize(10, 10);
+
+	std::size_t count = 20;
+	std::size_t last = count - 1;
+	std::vector<int> seq(count);
+	for(std::size_t i = 0; i < count; ++i) seq[i] = i;
+
+	SECTION("source[batch 4] --> sink") {
+		auto& source = gr.add_filter<sequence_frame_source>(last, shp, true);
+		auto& sink = gr.add_filter<expected_frames_sink>(seq);
+		
+		source.set_asynchonous(true);
+		source.set_batch_duration(4);
+		REQUIRE(source.batch_duration() == 4);
+		sink.input.connect(source.output);
+		
+		gr.setup();
+		gr.run();
+		
+		REQUIRE(sink.check());
+	}
+
+	SECTION("source[batch 3] --> [-3,+3]passthrough[batch 5] --> sink") {
+		auto& source = gr.add_filter<sequence_frame_source>(last, shp, true);
+		auto& passthrough = gr.add_filter<passthrough_filter>(3, 3);
+		auto& sink = gr.add_filter<expected_frames_sink>(seq);
+		
+		source.set_asynchonous(true);
+		source.set_batch_duration(3);
+		passthrough.set_asynchonous(true);
+		passthrough.set_batch_duration(5);
+		passthrough.input.connect(source.output);
+		sink.input.connect(passthrough.output);
+		
+		gr.setup();
+		gr.run();
+		
+		REQUIRE(sink.check());
+	}
+	
+	SECTION("seek") {
+		constexpr int m = missingframe;
+		std::vector<int> seek_seq { 0, 1, 2, 3, 4, 5, m, 7, 8, m, 10, m, m, m, m, 15, 16, m, m, 19 };
+
+		auto& source = gr.add_filter<sequence_frame_source>(seek_seq.size()-1, shp, true);
+		auto& passthrough = gr.add_filter<passthrough_filter>(0, 0);
+		auto& sink = gr.add_filter<expected_frames_sink>(seek_seq);
+
+		source.set_asynchonous(true);
+		source.set_batch_duration(4);
+		passthrough.set_asynchonous(true);
+		passthrough.set_batch_duration(2);
+		passthrough.input.connect(source.output);
+		sink.input.connect(passthrough.output);
+		
+		gr.setup();
+		gr.run_until(5);
+		REQUIRE(gr.current_time() == 5);
+		
+		// seek forward, into a region that a batch may already have covered
+		gr.seek(15);
+		gr.run_for(2);
+		REQUIRE(gr.current_time() == 16);
+		
+		// seek backward
+		gr.seek(10);
+		gr.run_for(1);
+		REQUIRE(gr.current_time() == 10);
+
+		gr.seek(19);
+		gr.run();
+		REQUIRE(sink.reached_end());
+	}
+}
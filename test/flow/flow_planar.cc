@@ -0,0 +1,161 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/filter/filter_graph.h>
+#include <mf/filter/filter.h>
+#include <cstdint>
+#include "../support/ndarray.h"
+#include "../support/flow.h"
+
+using namespace mf;
+using namespace mf::test;
+
+namespace {
+
+const ndsize<2> luma_shape = make_ndsize(6, 8);
+const ndsize<2> chroma_shape = make_ndsize(3, 4);
+
+std::uint8_t plane_value_(time_unit t, std::ptrdiff_t plane, std::ptrdiff_t y, std::ptrdiff_t x) {
+	return std::uint8_t(t * 11 + plane * 80 + y * 8 + x);
+}
+
+
+/// Source with an `index` output, and a planar 4:2:0 `planes` output.
+class planar_source : public flow::source_filter {
+private:
+	time_unit last_frame_;
+
+public:
+	output_type<2, int> index;
+	output_type<2, std::uint8_t> planes;
+	
+	explicit planar_source(time_unit last_frame) :
+		flow::source_filter(true, last_frame + 1), last_frame_(last_frame),
+		index(*this), planes(*this) { set_name("planar source"); }
+	
+	void setup() override {
+		index.define_frame_shape(make_ndsize(2, 2));
+		planes.define_planar_frame_shape({ luma_shape, chroma_shape, chroma_shape });
+	}
+	
+	void process(flow::filter_job& job) override {
+		time_unit t = job.time();
+		job.out(index) = make_frame(make_ndsize(2, 2), t);
+		for(std::ptrdiff_t plane = 0; plane < 3; ++plane) {
+			auto out = job.out_plane(planes, plane);
+			for(std::ptrdiff_t y = 0; y < out.shape()[0]; ++y)
+			for(std::ptrdiff_t x = 0; x < out.shape()[1]; ++x)
+				out[y][x] = plane_value_(t, plane, y, x);
+		}
+		if(t == last_frame_) job.mark_end();
+	}
+};
+
+
+class planar_passthrough : public flow::filter {
+public:
+	input_type<2, std::uint8_t> input;
+	output_type<2, std::uint8_t> output;
+	
+	planar_passthrough() :
+		input(*this), output(*this) { set_name("planar passthrough"); }
+	
+	void setup() override {
+		std::vector<ndsize<2>> plane_shapes;
+		for(std::ptrdiff_t plane = 0; plane < input.planes_count(); ++plane)
+			plane_shapes.push_back(input.plane_shape(plane));
+		output.define_planar_frame_shape(plane_shapes);
+	}
+	
+	void process(flow::filter_job& job) override {
+		for(std::ptrdiff_t plane = 0; plane < input.planes_count(); ++plane)
+			job.out_plane(output, plane) = job.in_plane(input, plane);
+	}
+};
+
+
+/// Verifies planes, and passes `index` through.
+class planar_check : public flow::filter {
+public:
+	input_type<2, int> index;
+	input_type<2, std::uint8_t> planes;
+	output_type<2, int> output;
+	
+	bool planes_valid = true;
+
+	planar_check() :
+		index(*this), planes(*this), output(*this) { set_name("planar check"); }
+	
+	void setup() override {
+		output.define_frame_shape(index.frame_shape());
+	}
+	
+	void process(flow::filter_job& job) override {
+		time_unit t = job.time();
+		job.out(output) = job.in(index);
+		
+		if(planes.planes_count() != 3) planes_valid = false;
+		if(planes.frame_shape() != luma_shape || planes.plane_shape(1) != chroma_shape) planes_valid = false;
+
+		for(std::ptrdiff_t plane = 0; plane < 3; ++plane) {
+			auto in = job.in_plane(planes, plane);
+			for(std::ptrdiff_t y = 0; y < in.shape()[0]; ++y)
+			for(std::ptrdiff_t x = 0; x < in.shape()[1]; ++x)
+				if(in[y][x] != plane_value_(t, plane, y, x)) planes_valid = false;
+		}
+	}
+};
+
+}
+
+
+TEST_CASE("flow graph test: planar frames", "[flow][planar]") {
+	flow::filter_graph gr;
+	
+	time_unit last = 9;
+	std::vector<int> seq;
+	for(int t = 0; t <= last; ++t) seq.push_back(t);
+
+	auto& source = gr.add_filter<planar_source>(last);
+	auto& check = gr.add_filter<planar_check>();
+	auto& sink = gr.add_filter<expected_frames_sink>(seq);
+	check.index.connect(source.index);
+	sink.input.connect(check.output);
+	
+	SECTION("source --> check --> sink") {
+		check.planes.connect(source.planes);
+	}
+	
+	SECTION("source --> passthrough --> check --> sink, async") {
+		auto& passthrough = gr.add_filter<planar_passthrough>();
+		source.set_asynchonous(true);
+		passthrough.set_asynchonous(true);
+		check.set_asynchonous(true);
+		passthrough.input.connect(source.planes);
+		check.planes.connect(passthrough.output);
+	}
+	
+	gr.setup();
+	gr.run();
+	
+	REQUIRE(sink.check());
+	REQUIRE(check.planes_valid);
+}
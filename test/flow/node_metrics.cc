@@ -0,0 +1,146 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/flow/diagnostic/node_metrics.h>
+#include <mf/flow/graph.h>
+#include <mf/filter/filter_graph.h>
+#include "../support/ndarray.h"
+#include "../support/flow.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace mf;
+using namespace mf::test;
+
+TEST_CASE("latency_histogram", "[flow][metrics]") {
+	using hist = flow::latency_histogram;
+	using ns = hist::duration_type;
+	
+	SECTION("buckets") {
+		for(std::uint64_t v : { 0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull, 1ull << 32, 1ull << 63, ~0ull }) {
+			std::size_t i = hist::bucket_index(v);
+			REQUIRE(i < hist::buckets_count);
+			REQUIRE(hist::bucket_lower_bound(i) <= v);
+			if(i + 1 < hist::buckets_count) REQUIRE(hist::bucket_lower_bound(i + 1) > v);
+			// relative error bounded by bucket width
+			REQUIRE(v - hist::bucket_lower_bound(i) <= v / hist::sub_buckets_count);
+		}
+		for(std::size_t i = 1; i < hist::buckets_count; ++i)
+			REQUIRE(hist::bucket_lower_bound(i) > hist::bucket_lower_bound(i - 1));
+	}
+	
+	SECTION("percentiles") {
+		hist h;
+		for(int i = 1; i <= 1000; ++i) h.record(ns(i * 1000));
+		hist::snapshot snap(h);
+		REQUIRE(snap.count() == 1000);
+		REQUIRE(snap.max() == ns(1000000));
+		REQUIRE(snap.mean() == ns(500500));
+		
+		auto within = [](ns measured, ns expected) {
+			return (measured <= expected) && (measured.count() >= expected.count() * 7 / 8);
+		};
+		REQUIRE(within(snap.percentile(0.5), ns(500000)));
+		REQUIRE(within(snap.percentile(0.99), ns(990000)));
+		REQUIRE(snap.percentile(1.0) <= snap.max());
+		REQUIRE(within(snap.percentile(0.0), ns(1000)));
+		
+		h.reset();
+		REQUIRE(hist::snapshot(h).count() == 0);
+		REQUIRE(hist::snapshot(h).percentile(0.5) == ns(0));
+	}
+}
+
+
+TEST_CASE("sharded_counter", "[flow][metrics]") {
+	flow::sharded_counter counter;
+	REQUIRE(counter.load() == 0);
+	
+	const std::size_t threads_count = 2 * flow::sharded_counter::shards_count + 1;
+	std::vector<std::thread> threads;
+	for(std::size_t i = 0; i < threads_count; ++i) threads.emplace_back([&counter] {
+		for(int j = 0; j < 1000; ++j) counter.add(2);
+	});
+	for(std::thread& th : threads) th.join();
+	REQUIRE(counter.load() == threads_count * 2000);
+	
+	counter.reset();
+	REQUIRE(counter.load() == 0);
+}
+
+
+TEST_CASE("graph metrics snapshot", "[flow][metrics]") {
+	flow::filter_graph gr;
+	auto shp = make_ndsize(10, 10);
+
+	std::size_t count = 20;
+	std::vector<int> seq(count);
+	for(std::size_t i = 0; i < count; ++i) seq[i] = i;
+	
+	auto& source = gr.add_filter<sequence_frame_source>(count - 1, shp, true);
+	auto& passthrough = gr.add_filter<passthrough_filter>(0, 0);
+	auto& sink = gr.add_filter<expected_frames_sink>(seq);
+	
+	source.set_asynchonous(true);
+	source.set_prefetch_duration(3);
+	passthrough.input.connect(source.output);
+	sink.input.connect(passthrough.output);
+	
+	gr.setup();
+	gr.run();
+	REQUIRE(sink.check());
+	
+	flow::graph& node_gr = gr.node_graph();
+	std::vector<flow::node_metrics_snapshot> snapshots = node_gr.metrics_snapshot();
+	REQUIRE(snapshots.size() == node_gr.nodes_count());
+	
+	auto find = [&](const std::string& name) {
+		auto it = std::find_if(snapshots.begin(), snapshots.end(),
+			[&](const flow::node_metrics_snapshot& snap) { return snap.node_name == name; });
+		REQUIRE(it != snapshots.end());
+		return *it;
+	};
+	
+	flow::node_metrics_snapshot source_metrics = find("source");
+	flow::node_metrics_snapshot passthrough_metrics = find("passthrough");
+	flow::node_metrics_snapshot sink_metrics = find("sink");
+	
+	REQUIRE(sink_metrics.frames == count);
+	REQUIRE(passthrough_metrics.frames == count);
+	REQUIRE(source_metrics.frames >= count);
+	REQUIRE(sink_metrics.processing_latency.count() == count);
+	REQUIRE(sink_metrics.frames_per_second > 0.0);
+	REQUIRE(sink_metrics.pull_failures == 0);
+	
+	// frames of async source get requested by passthrough, with prefetching
+	REQUIRE(source_metrics.prefetch_hits + source_metrics.prefetch_misses == count);
+	REQUIRE(source_metrics.prefetch_hit_rate() >= 0.0);
+	REQUIRE(source_metrics.prefetch_hit_rate() <= 1.0);
+	REQUIRE(passthrough_metrics.prefetch_hits + passthrough_metrics.prefetch_misses == 0);
+	
+	node_gr.stop();
+	node_gr.reset_metrics();
+	for(const flow::node_metrics_snapshot& snap : node_gr.metrics_snapshot()) {
+		REQUIRE(snap.frames == 0);
+		REQUIRE(snap.frames_per_second == 0.0);
+	}
+}
@@ -0,0 +1,117 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/flow/prefetch_controller.h>
+#include <mf/flow/async_node.h>
+#include <mf/flow/graph.h>
+#include <mf/filter/filter_graph.h>
+#include "../support/ndarray.h"
+#include "../support/flow.h"
+#include <chrono>
+
+using namespace mf;
+using namespace mf::test;
+using namespace std::chrono_literals;
+
+TEST_CASE("prefetch_controller", "[flow][prefetch]") {
+	flow::prefetch_controller controller(2, 10);
+	REQUIRE(controller.duration() == 2);
+	
+	auto now = flow::prefetch_controller::clock_type::now();
+	auto request = [&](std::chrono::nanoseconds period) {
+		now += period;
+		controller.record_request(now);
+	};
+	
+	// consumer requests a frame every 10ms, producer takes 1ms per frame
+	for(int i = 0; i < 10; ++i) {
+		request(10ms);
+		controller.record_produced(4, 4ms);
+	}
+	REQUIRE(controller.consumer_period() == 10ms);
+	REQUIRE(controller.producer_frame_time() == 1ms);
+	
+	SECTION("grows on stall by missed frames, up to maximum") {
+		request(10ms);
+		controller.record_stall(25ms);
+		REQUIRE(controller.duration() == 2 + 3);
+		request(10ms);
+		controller.record_stall(1000ms);
+		REQUIRE(controller.duration() == 10);
+	}
+	
+	SECTION("shrinks after streak of hits, down to minimum") {
+		controller.record_stall(30ms);
+		REQUIRE(controller.duration() == 5);
+		for(int i = 0; i < flow::prefetch_controller::shrink_streak - 1; ++i) controller.record_hit();
+		REQUIRE(controller.duration() == 5);
+		controller.record_hit();
+		REQUIRE(controller.duration() == 4);
+		for(int i = 0; i < 10 * flow::prefetch_controller::shrink_streak; ++i) controller.record_hit();
+		REQUIRE(controller.duration() == 2);
+	}
+	
+	SECTION("does not shrink when producer is slower") {
+		controller.record_stall(30ms);
+		for(int i = 0; i < 100; ++i) controller.record_produced(1, 50ms);
+		for(int i = 0; i < 10 * flow::prefetch_controller::shrink_streak; ++i) controller.record_hit();
+		REQUIRE(controller.duration() == 5);
+	}
+}
+
+
+TEST_CASE("flow graph test: adaptive prefetch", "[flow][async][prefetch]") {
+	flow::filter_graph gr;
+	auto shp = make_ndsize(10, 10);
+
+	std::size_t count = 30;
+	std::vector<int> seq(count);
+	for(int i = 0; i < count; ++i) seq[i] = i;
+
+	auto& source = gr.add_filter<sequence_frame_source>(count - 1, shp, true);
+	auto& passthrough = gr.add_filter<passthrough_filter>(1, 1);
+	auto& sink = gr.add_filter<expected_frames_sink>(seq);
+	
+	source.set_asynchonous(true);
+	source.set_prefetch_duration(1);
+	source.set_adaptive_prefetch(6);
+	REQUIRE(source.has_adaptive_prefetch());
+	passthrough.set_asynchonous(true);
+	passthrough.set_adaptive_prefetch(4);
+	passthrough.input.connect(source.output);
+	sink.input.connect(passthrough.output);
+	
+	gr.setup();
+	gr.run();
+	REQUIRE(sink.check());
+	
+	std::size_t adaptive_nodes = 0;
+	flow::graph& node_gr = gr.node_graph();
+	for(std::ptrdiff_t i = 0; i < node_gr.nodes_count(); ++i) {
+		auto* nd = dynamic_cast<flow::async_node*>(&node_gr.node_at(i));
+		if(nd == nullptr) continue;
+		REQUIRE(nd->has_adaptive_prefetch());
+		REQUIRE(nd->effective_prefetch_duration() >= nd->prefetch_duration());
+		REQUIRE(nd->effective_prefetch_duration() <= nd->maximal_prefetch_duration());
+		++adaptive_nodes;
+	}
+	REQUIRE(adaptive_nodes == 2);
+}
@@ -0,0 +1,167 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/flow/diagnostic/processing_timeline.h>
+#include <mf/flow/diagnostic/chrome_trace.h>
+#include <mf/flow/graph.h>
+#include <mf/flow/processing_node.h>
+#include <mf/filter/filter_graph.h>
+#include "../support/ndarray.h"
+#include "../support/flow.h"
+#include <sstream>
+#include <string>
+#include <chrono>
+
+using namespace mf;
+using namespace mf::test;
+
+namespace {
+
+std::size_t occurences_(const std::string& str, const std::string& substr) {
+	std::size_t count = 0;
+	for(std::size_t pos = str.find(substr); pos != std::string::npos; pos = str.find(substr, pos + 1)) ++count;
+	return count;
+}
+
+}
+
+
+TEST_CASE("processing timeline", "[flow][processing_timeline]") {
+	flow::filter_graph gr;
+	auto shp = make_ndsize(10, 10);
+
+	std::size_t count = 20;
+	std::vector<int> seq(count);
+	for(int i = 0; i < count; ++i) seq[i] = i;
+	
+	auto& source = gr.add_filter<sequence_frame_source>(count - 1, shp, true);
+	auto& passthrough = gr.add_filter<passthrough_filter>(0, 1);
+	auto& sink = gr.add_filter<expected_frames_sink>(seq);
+	
+	source.set_asynchonous(true);
+	passthrough.input.connect(source.output);
+	sink.input.connect(passthrough.output);
+	gr.setup();
+	
+	SECTION("record and export") {
+		flow::processing_timeline timeline(gr.node_graph());
+		gr.node_graph().set_diagnostic(timeline);
+		gr.run();
+		gr.node_graph().stop();
+		gr.node_graph().unset_diagnostic();
+		REQUIRE(sink.check());
+		
+		std::vector<flow::processing_timeline::job> jobs = timeline.jobs();
+		REQUIRE(timeline.dropped_jobs_count() == 0);
+		std::size_t sink_jobs = 0;
+		for(std::size_t i = 0; i < jobs.size(); ++i) {
+			const flow::processing_timeline::job& jb = jobs[i];
+			REQUIRE(jb.end_clock_time >= jb.start_clock_time);
+			REQUIRE(jb.thread == jb.node->processing_thread_index());
+			if(i > 0) REQUIRE(jb.start_clock_time >= jobs[i - 1].start_clock_time);
+			if(jb.node->name() == "sink") ++sink_jobs;
+		}
+		REQUIRE(sink_jobs == count);
+		
+		std::ostringstream str;
+		flow::chrome_trace trace(timeline, str);
+		trace.generate();
+		std::string json = str.str();
+		
+		REQUIRE(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+		REQUIRE(occurences_(json, "\"ph\":\"X\"") == jobs.size());
+		REQUIRE(occurences_(json, "\"name\":\"sink\"") == count);
+		REQUIRE(occurences_(json, "\"ph\":\"s\"") > 0);
+		REQUIRE(occurences_(json, "\"ph\":\"s\"") == occurences_(json, "\"ph\":\"f\""));
+		REQUIRE(occurences_(json, "\"name\":\"thread_name\"") >= 2);
+	}
+	
+	SECTION("bounded thread buffers") {
+		flow::processing_timeline timeline(gr.node_graph(), 4);
+		timeline.set_drain_interval(std::chrono::seconds(10));
+		gr.node_graph().set_diagnostic(timeline);
+		gr.run();
+		gr.node_graph().stop();
+		gr.node_graph().unset_diagnostic();
+		REQUIRE(sink.check());
+		
+		REQUIRE(timeline.thread_capacity() == 4);
+		REQUIRE(timeline.dropped_jobs_count() > 0);
+		REQUIRE(timeline.jobs().size() + timeline.dropped_jobs_count() >= 3 * count);
+	}
+	
+	SECTION("bounded retained jobs, with summaries") {
+		flow::processing_timeline timeline(gr.node_graph(), flow::processing_timeline::default_thread_capacity, 10);
+		gr.node_graph().set_diagnostic(timeline);
+		gr.run();
+		gr.node_graph().stop();
+		gr.node_graph().unset_diagnostic();
+		REQUIRE(sink.check());
+		
+		std::vector<flow::processing_timeline::job> jobs = timeline.jobs();
+		REQUIRE(jobs.size() == 10);
+		REQUIRE(timeline.dropped_jobs_count() == 0);
+		
+		std::size_t summarized_jobs = 0;
+		for(const flow::processing_timeline::node_summary& summary : timeline.summaries()) {
+			summarized_jobs += summary.durations.count();
+			if(summary.node->name() == "sink") REQUIRE(summary.durations.count() == count);
+			REQUIRE(summary.durations.max() >= summary.durations.percentile(0.5));
+		}
+		REQUIRE(summarized_jobs == jobs.size() + timeline.discarded_jobs_count());
+		
+		// the most recent jobs are retained
+		REQUIRE(jobs.back().node->name() == "sink");
+		REQUIRE(jobs.back().frame_time == count - 1);
+	}
+	
+	SECTION("frame sampling") {
+		flow::processing_timeline timeline(gr.node_graph());
+		timeline.set_frame_sampling(4);
+		gr.node_graph().set_diagnostic(timeline);
+		gr.run();
+		gr.node_graph().stop();
+		gr.node_graph().unset_diagnostic();
+		REQUIRE(sink.check());
+		
+		std::vector<flow::processing_timeline::job> jobs = timeline.jobs();
+		REQUIRE(jobs.size() > 0);
+		std::size_t sink_jobs = 0;
+		for(const flow::processing_timeline::job& jb : jobs) {
+			REQUIRE(jb.frame_time % 4 == 0);
+			if(jb.node->name() == "sink") ++sink_jobs;
+		}
+		REQUIRE(sink_jobs == count / 4);
+	}
+	
+	SECTION("latency threshold") {
+		flow::processing_timeline timeline(gr.node_graph());
+		timeline.set_latency_threshold(std::chrono::hours(1));
+		gr.node_graph().set_diagnostic(timeline);
+		gr.run();
+		gr.node_graph().stop();
+		gr.node_graph().unset_diagnostic();
+		REQUIRE(sink.check());
+		
+		REQUIRE(timeline.jobs().size() == 0);
+		REQUIRE(timeline.summaries().size() == 0);
+	}
+}
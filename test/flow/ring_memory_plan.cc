@@ -0,0 +1,156 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/flow/ring_memory_plan.h>
+#include <mf/flow/graph.h>
+#include <mf/flow/async_node.h>
+#include <mf/flow/graph_visualization.h>
+#include <mf/filter/filter_graph.h>
+#include <mf/exceptions.h>
+#include "../support/ndarray.h"
+#include "../support/flow.h"
+#include <sstream>
+
+using namespace mf;
+using namespace mf::test;
+
+namespace {
+
+const std::size_t count_ = 20;
+
+/// Builds graph source[async] --> [-1,+1]passthrough --> sink.
+struct test_graph {
+	flow::filter_graph gr;
+	sequence_frame_source& source;
+	passthrough_filter& passthrough;
+	expected_frames_sink& sink;
+	
+	static std::vector<int> sequence_() {
+		std::vector<int> seq(count_);
+		for(int i = 0; i < count_; ++i) seq[i] = i;
+		return seq;
+	}
+	
+	test_graph() :
+		source(gr.add_filter<sequence_frame_source>(count_ - 1, make_ndsize(10, 10), true)),
+		passthrough(gr.add_filter<passthrough_filter>(1, 1)),
+		sink(gr.add_filter<expected_frames_sink>(sequence_()))
+	{
+		source.set_asynchonous(true);
+		source.set_prefetch_duration(5);
+		source.set_adaptive_prefetch(8);
+		source.set_batch_duration(3);
+		passthrough.input.connect(source.output);
+		sink.input.connect(passthrough.output);
+	}
+};
+
+}
+
+
+TEST_CASE("ring memory plan", "[flow][memory_plan]") {
+	test_graph unlimited;
+	unlimited.gr.setup();
+	const flow::ring_memory_plan& unlimited_plan = unlimited.gr.node_graph().memory_plan();
+	
+	REQUIRE(unlimited_plan.budget() == 0);
+	REQUIRE(unlimited_plan.rings().size() == 2);
+	std::size_t total = 0;
+	for(const flow::ring_memory_plan::ring& rg : unlimited_plan.rings()) {
+		REQUIRE(rg.capacity == rg.node->output_ring_capacity());
+		REQUIRE(rg.frame_size == rg.node->output_frame_size());
+		REQUIRE(rg.frame_size >= 10 * 10 * sizeof(int));
+		REQUIRE_FALSE(rg.reduced);
+		total += rg.size();
+	}
+	REQUIRE(unlimited_plan.total_size() == total);
+	
+	const flow::ring_memory_plan::ring& async_ring = unlimited_plan.rings().front();
+	REQUIRE(async_ring.asynchronous);
+	REQUIRE(async_ring.capacity > unlimited_plan.rings().back().capacity);
+	std::size_t frame_size = async_ring.frame_size;
+	
+	SECTION("within budget") {
+		test_graph budgeted;
+		budgeted.gr.set_memory_budget(total);
+		budgeted.gr.setup();
+		REQUIRE(budgeted.gr.node_graph().memory_plan().total_size() == total);
+		REQUIRE_FALSE(budgeted.gr.node_graph().memory_plan().rings().front().reduced);
+	}
+	
+	SECTION("reduced to budget") {
+		test_graph budgeted;
+		std::size_t budget = total - 6 * frame_size;
+		budgeted.gr.set_memory_budget(budget);
+		budgeted.gr.setup();
+		
+		const flow::ring_memory_plan& plan = budgeted.gr.node_graph().memory_plan();
+		REQUIRE(plan.budget() == budget);
+		REQUIRE(plan.total_size() <= budget);
+		REQUIRE(plan.rings().front().reduced);
+		REQUIRE_FALSE(plan.rings().back().reduced);
+		
+		// adaptive range removed first, then prefetch reduced
+		const auto& nd = static_cast<const flow::async_node&>(*plan.rings().front().node);
+		REQUIRE(nd.maximal_prefetch_duration() == 2);
+		REQUIRE(nd.batch_duration() == 3);
+		
+		budgeted.gr.run();
+		REQUIRE(budgeted.sink.check());
+		
+		std::ostringstream str;
+		flow::graph_visualization vis(budgeted.gr.node_graph(), str);
+		vis.generate();
+		REQUIRE(str.str().find("ring buffers: ") != std::string::npos);
+		REQUIRE(str.str().find("(reduced)") != std::string::npos);
+	}
+	
+	SECTION("async node reduced to capacity of sync node") {
+		// without prefetch and batch, ring holds window [-1, +1] of passthrough
+		test_graph budgeted;
+		std::size_t sync_capacity = unlimited_plan.rings().back().capacity;
+		budgeted.gr.set_memory_budget((3 + sync_capacity) * frame_size);
+		budgeted.gr.setup();
+		
+		const flow::ring_memory_plan& plan = budgeted.gr.node_graph().memory_plan();
+		const auto& nd = static_cast<const flow::async_node&>(*plan.rings().front().node);
+		REQUIRE(nd.maximal_prefetch_duration() == 0);
+		REQUIRE(nd.batch_duration() == 1);
+		REQUIRE(plan.rings().front().capacity == 3);
+		
+		budgeted.gr.run();
+		REQUIRE(budgeted.sink.check());
+	}
+	
+	SECTION("budget cannot be met") {
+		test_graph budgeted;
+		budgeted.gr.set_memory_budget(frame_size);
+		REQUIRE_THROWS_AS(budgeted.gr.setup(), memory_budget_exceeded);
+	}
+}
+
+
+TEST_CASE("format_memory_size", "[flow][memory_plan]") {
+	REQUIRE(flow::format_memory_size(0) == "0 B");
+	REQUIRE(flow::format_memory_size(1023) == "1023 B");
+	REQUIRE(flow::format_memory_size(1536) == "1.5 KiB");
+	REQUIRE(flow::format_memory_size(std::size_t(3) << 30) == "3.0 GiB");
+}
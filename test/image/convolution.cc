@@ -0,0 +1,191 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/image/convolution.h>
+#include <mf/image/kernel.h>
+#include <mf/nd/ndarray.h>
+#include <mf/nd/ndarray_filter.h>
+#include <cmath>
+#include <cstdint>
+
+using namespace mf;
+
+namespace {
+
+std::ptrdiff_t reference_index_(std::ptrdiff_t i, std::ptrdiff_t n, border_mode border) {
+	while(i < 0 || i >= n) {
+		switch(border) {
+			case border_mode::constant: return -1;
+			case border_mode::replicate: i = (i < 0 ? 0 : n - 1); break;
+			case border_mode::reflect: i = (i < 0 ? -i : 2*(n - 1) - i); break;
+			case border_mode::wrap: i = (i < 0 ? i + n : i - n); break;
+		}
+	}
+	return i;
+}
+
+template<typename Elem>
+ndarray<2, float> reference_convolve_(
+	const ndarray_view<2, const Elem>& in, const ndarray_view<2, const real>& kernel,
+	border_mode border, float border_value
+) {
+	ndarray<2, float> out(in.shape());
+	std::ptrdiff_t ry = kernel.shape()[0] / 2, rx = kernel.shape()[1] / 2;
+	for(std::ptrdiff_t y = 0; y < in.shape()[0]; ++y)
+	for(std::ptrdiff_t x = 0; x < in.shape()[1]; ++x) {
+		double sum = 0.0;
+		for(std::ptrdiff_t i = 0; i < kernel.shape()[0]; ++i)
+		for(std::ptrdiff_t j = 0; j < kernel.shape()[1]; ++j) {
+			std::ptrdiff_t in_y = reference_index_(y + i - ry, in.shape()[0], border);
+			std::ptrdiff_t in_x = reference_index_(x + j - rx, in.shape()[1], border);
+			double value = (in_y == -1 || in_x == -1) ? border_value : in[in_y][in_x];
+			sum += kernel[i][j] * value;
+		}
+		out[y][x] = sum;
+	}
+	return out;
+}
+
+template<typename View>
+bool approx_equal_(const View& a, const ndarray_view<2, const float>& b, float tolerance) {
+	for(std::ptrdiff_t y = 0; y < a.shape()[0]; ++y)
+	for(std::ptrdiff_t x = 0; x < a.shape()[1]; ++x)
+		if(std::abs(a[y][x] - b[y][x]) > tolerance) return false;
+	return true;
+}
+
+}
+
+
+TEST_CASE("convolution", "[image][convolution]") {
+	auto shp = make_ndsize(23, 37);
+	ndarray<2, float> in(shp);
+	for(std::ptrdiff_t y = 0; y < shp[0]; ++y) for(std::ptrdiff_t x = 0; x < shp[1]; ++x)
+		in[y][x] = std::sin(0.3f * x) + std::cos(0.7f * y) + 0.01f * x * y;
+	
+	real_image_kernel separable_weights(make_ndsize(5, 3));
+	real_image_kernel weights(make_ndsize(3, 5));
+	const real column[] = { 1.0, 4.0, 6.0, 4.0, 1.0 };
+	const real row[] = { -1.0, 0.5, 2.0 };
+	for(std::ptrdiff_t i = 0; i < 5; ++i) for(std::ptrdiff_t j = 0; j < 3; ++j)
+		separable_weights[i][j] = column[i] * row[j];
+	for(std::ptrdiff_t i = 0; i < 3; ++i) for(std::ptrdiff_t j = 0; j < 5; ++j)
+		weights[i][j] = (i == 1 && j == 2) ? 3.0 : (i - j) * 0.25;
+
+	SECTION("separability") {
+		REQUIRE(convolution_kernel(separable_weights.cview()).is_separable());
+		REQUIRE_FALSE(convolution_kernel(weights.cview()).is_separable());
+		REQUIRE(convolution_kernel(box_image_kernel(5).cview()).is_separable());
+		REQUIRE_FALSE(convolution_kernel(disk_image_kernel(7).cview()).is_separable());
+		
+		convolution_kernel kernel({ 1.0, 2.0, 1.0 }, { 1.0, 0.0, -1.0 });
+		REQUIRE(kernel.is_separable());
+		REQUIRE(kernel.shape() == make_ndsize(3, 3));
+		REQUIRE(kernel.weight(1, 0) == 2.0f);
+		REQUIRE(kernel.weight(2, 2) == -1.0f);
+		
+		convolution_kernel box_kernel(box_image_kernel(3).cview());
+		REQUIRE(box_kernel.weight(0, 0) == Approx(1.0 / 9.0));
+		convolution_kernel sum_kernel(box_image_kernel(3).cview(), false);
+		REQUIRE(sum_kernel.weight(0, 0) == 1.0f);
+	}
+	
+	SECTION("float") {
+		const border_mode borders[] = {
+			border_mode::constant, border_mode::replicate, border_mode::reflect, border_mode::wrap
+		};
+		for(const real_image_kernel* w : { &separable_weights, &weights })
+		for(border_mode border : borders) {
+			convolution_kernel kernel(w->cview());
+			ndarray<2, float> out(shp);
+			convolve(in.cview(), out.view(), kernel, border, 1.5f);
+			auto expected = reference_convolve_(in.cview(), w->cview(), border, 1.5f);
+			REQUIRE(approx_equal_(out.cview(), expected.cview(), 1e-3));
+		}
+	}
+	
+	SECTION("strided") {
+		auto in_section = in.view().section(make_ndptrdiff(0, 0), make_ndptrdiff(shp[0], shp[1]), make_ndptrdiff(1, 2));
+		std::ptrdiff_t width = in_section.shape()[1];
+		ndarray<2, float> out(make_ndsize(shp[0], 2*width));
+		auto out_section = out.view().section(make_ndptrdiff(0, 1), make_ndptrdiff(shp[0], 2*width), make_ndptrdiff(1, 2));
+		REQUIRE(in_section.shape() == out_section.shape());
+		
+		convolve(in_section, out_section, convolution_kernel(weights.cview()), border_mode::reflect);
+		ndarray<2, float> in_copy(in_section);
+		auto expected = reference_convolve_(in_copy.cview(), weights.cview(), border_mode::reflect, 0.0f);
+		REQUIRE(approx_equal_(out_section, expected.cview(), 1e-3));
+	}
+	
+	SECTION("same as apply_kernel") {
+		ndarray<2, float> out(shp), expected(shp);
+		convolve(in.cview(), out.view(), convolution_kernel(weights.cview()), border_mode::constant, 0.0f);
+		apply_kernel([](const auto& placement, float& out) {
+			float sum = 0.0;
+			for(auto it = placement.view_section.begin(); it != placement.view_section.end(); ++it)
+				sum += *it * placement.kernel_section.at(it.coordinates());
+			out = sum;
+		}, in.cview(), expected.view(), weights.cview());
+		REQUIRE(approx_equal_(out.cview(), expected.cview(), 1e-3));
+	}
+	
+	SECTION("kernel larger than image") {
+		ndarray<2, float> small(make_ndsize(2, 3)), out(make_ndsize(2, 3));
+		for(std::ptrdiff_t i = 0; i < 6; ++i) small[i / 3][i % 3] = i;
+		real_image_kernel big(make_ndsize(7, 9));
+		for(auto it = big.begin(); it != big.end(); ++it) *it = 1.0 + it.coordinates()[1];
+		for(border_mode border : { border_mode::replicate, border_mode::reflect, border_mode::wrap }) {
+			convolve(small.cview(), out.view(), convolution_kernel(big.cview()), border);
+			auto expected = reference_convolve_(small.cview(), big.cview(), border, 0.0f);
+			REQUIRE(approx_equal_(out.cview(), expected.cview(), 1e-3));
+		}
+	}
+
+	SECTION("uint8") {
+		ndarray<2, std::uint8_t> in8(shp), out8(shp);
+		for(std::ptrdiff_t y = 0; y < shp[0]; ++y) for(std::ptrdiff_t x = 0; x < shp[1]; ++x)
+			in8[y][x] = (y * 37 + x * 11) % 256;
+		
+		// mean filter with disk kernel: result within range, compare with rounded reference
+		convolution_kernel disk_kernel(disk_image_kernel(5).cview());
+		convolve(in8.cview(), out8.view(), disk_kernel, border_mode::reflect);
+		real_image_kernel disk_weights(make_ndsize(5, 5));
+		for(std::ptrdiff_t i = 0; i < 5; ++i) for(std::ptrdiff_t j = 0; j < 5; ++j)
+			disk_weights[i][j] = disk_kernel.weight(i, j);
+		auto expected = reference_convolve_(in8.cview(), disk_weights.cview(), border_mode::reflect, 0.0f);
+		REQUIRE(approx_equal_(out8.cview(), expected.cview(), 1.0f));
+		
+		// saturation
+		convolution_kernel sum_kernel(box_image_kernel(3).cview(), false);
+		convolve(in8.cview(), out8.view(), sum_kernel, border_mode::constant, 255);
+		REQUIRE(out8[0][0] == 255);
+		convolution_kernel negative_kernel({ 1.0 }, { -1.0 });
+		convolve(in8.cview(), out8.view(), negative_kernel);
+		REQUIRE(std::all_of(out8.begin(), out8.end(), [](std::uint8_t v) { return v == 0; }));
+		
+		// rounding
+		convolution_kernel half_kernel({ 1.0 }, { 0.5 });
+		convolve(in8.cview(), out8.view(), half_kernel);
+		REQUIRE(out8[0][1] == 6); // 11 / 2 = 5.5 -> 6
+		REQUIRE(out8[0][2] == 11); // 22 / 2
+		REQUIRE(out8[0][3] == 16); // 33 / 2 = 16.5 -> 16
+	}
+}
@@ -0,0 +1,276 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/image/depth_warp.h>
+#include <mf/filter/depth_warp.h>
+#include <mf/filter/filter_graph.h>
+#include <mf/nd/ndarray.h>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+
+using namespace mf;
+
+namespace {
+
+const std::ptrdiff_t width_ = 80, height_ = 70;
+
+projection_image_camera<std::uint16_t> make_camera_(
+	real x, depth_projection_parameters::depth_range range = depth_projection_parameters::unsigned_normalized
+) {
+	depth_projection_parameters dparam;
+	dparam.z_near = 1.0;
+	dparam.z_far = 50.0;
+	dparam.flip_z = false;
+	dparam.range = range;
+	Eigen_mat3 intrinsic; intrinsic <<
+		60.0, 0.0, 40.0,
+		0.0, 60.0, 35.0,
+		0.0, 0.0, 1.0;
+	projection_image_camera<std::uint16_t> cam(
+		pose(Eigen_vec3(x, 0.0, 0.0), Eigen_quaternion::Identity()),
+		intrinsic,
+		dparam,
+		make_ndsize(width_, height_)
+	);
+	cam.flip_pixel_coordinates();
+	return cam;
+}
+
+
+/// Depth image with background plane and nearer square, and image containing index of pixel.
+void make_source_(ndarray<2, std::uint16_t>& depth, ndarray<2, int>& image, const projection_image_camera<std::uint16_t>& cam) {
+	for(std::ptrdiff_t y = 0; y < height_; ++y) for(std::ptrdiff_t x = 0; x < width_; ++x) {
+		real z = (y >= 20 && y < 45 && x >= 30 && x < 55) ? 4.0 : 10.0;
+		if(x == 5 && y == 5) depth[y][x] = 0;
+		else depth[y][x] = cam.to_pixel_depth(cam.depth(Eigen_vec3(0.0, 0.0, z)));
+		image[y][x] = y * width_ + x;
+	}
+}
+
+
+/// Compare warp result with brute force, where the source pixel with the lowest view space Z is kept.
+/** Cameras only differ by a translation, and have no Z flip, so view space Z is the distance along the viewing axis. */
+void compare_brute_force_(
+	const ndarray<2, std::uint16_t>& source_depth, const ndarray<2, int>& source_image,
+	const projection_image_camera<std::uint16_t>& source_cam, const projection_image_camera<std::uint16_t>& target_cam,
+	const ndarray<2, int>& target_image, const ndarray<2, byte>& target_mask,
+	std::ptrdiff_t& holes, std::ptrdiff_t& mismatches
+) {
+	ndarray<2, real> expected_z(make_ndsize(height_, width_));
+	ndarray<2, int> expected_image(make_ndsize(height_, width_));
+	for(std::ptrdiff_t y = 0; y < height_; ++y) for(std::ptrdiff_t x = 0; x < width_; ++x) {
+		expected_z[y][x] = std::numeric_limits<real>::infinity();
+		expected_image[y][x] = -1;
+	}
+	for(std::ptrdiff_t y = 0; y < height_; ++y) for(std::ptrdiff_t x = 0; x < width_; ++x) {
+		if(source_depth[y][x] == 0) continue;
+		Eigen_vec3 p = source_cam.point(source_cam.to_image(make_ndptrdiff(y, x)), source_cam.to_depth(source_depth[y][x]));
+		auto c = target_cam.project(p);
+		auto pix = make_ndptrdiff(std::ptrdiff_t(std::floor(c[1])), std::ptrdiff_t(std::floor(c[0])));
+		if(pix[0] < 0 || pix[0] >= height_ || pix[1] < 0 || pix[1] >= width_) continue;
+		real z = p[2];
+		if(z < expected_z[pix[0]][pix[1]]) {
+			expected_z[pix[0]][pix[1]] = z;
+			expected_image[pix[0]][pix[1]] = source_image[y][x];
+		}
+	}
+	
+	holes = 0; mismatches = 0;
+	for(std::ptrdiff_t y = 0; y < height_; ++y) for(std::ptrdiff_t x = 0; x < width_; ++x) {
+		if(expected_image[y][x] == -1) {
+			if(target_mask[y][x] != 0) ++mismatches;
+			++holes;
+		} else {
+			if(target_mask[y][x] != 0xff || target_image[y][x] != expected_image[y][x]) ++mismatches;
+		}
+	}
+}
+
+}
+
+
+TEST_CASE("forward_warp", "[image][depth_warp]") {
+	auto source_cam = make_camera_(0.0);
+	ndarray<2, std::uint16_t> source_depth(make_ndsize(height_, width_));
+	ndarray<2, int> source_image(make_ndsize(height_, width_));
+	make_source_(source_depth, source_image, source_cam);
+	
+	ndarray<2, int> target_image(make_ndsize(height_, width_));
+	ndarray<2, byte> target_mask(make_ndsize(height_, width_));
+	ndarray<2, std::uint16_t> target_depth(make_ndsize(height_, width_));
+	
+	SECTION("identity") {
+		forward_warp<int, std::uint16_t>(
+			source_depth.cview(), source_image.cview(), source_cam, source_cam,
+			target_image.view(), target_mask.view(), target_depth.view()
+		);
+		bool all_equal = true;
+		for(std::ptrdiff_t y = 0; y < height_; ++y) for(std::ptrdiff_t x = 0; x < width_; ++x) {
+			if(x == 5 && y == 5) {
+				all_equal = all_equal && (target_mask[y][x] == 0) && (target_depth[y][x] == 0);
+			} else {
+				all_equal = all_equal && (target_mask[y][x] == 0xff) && (target_image[y][x] == source_image[y][x]);
+				all_equal = all_equal && (std::abs(int(target_depth[y][x]) - int(source_depth[y][x])) <= 1);
+			}
+		}
+		REQUIRE(all_equal);
+	}
+	
+	SECTION("translated, with occlusion") {
+		auto target_cam = make_camera_(1.0);
+		forward_warp<int, std::uint16_t>(
+			source_depth.cview(), source_image.cview(), source_cam, target_cam,
+			target_image.view(), target_mask.view()
+		);
+		
+		std::ptrdiff_t holes = 0, mismatches = 0;
+		compare_brute_force_(
+			source_depth, source_image, source_cam, target_cam,
+			target_image, target_mask, holes, mismatches
+		);
+		REQUIRE(mismatches == 0);
+		REQUIRE(holes > 0);
+		
+		// the square is in front of the background
+		REQUIRE(target_image[30][20] / width_ == 30);
+		REQUIRE(target_image[30][20] % width_ >= 30);
+	}
+	
+	SECTION("disparity range, with occlusion") {
+		// depth decreases with distance, so the nearest splat has the highest depth
+		auto disparity_source_cam = make_camera_(0.0, depth_projection_parameters::unsigned_normalized_disparity);
+		auto disparity_target_cam = make_camera_(1.0, depth_projection_parameters::unsigned_normalized_disparity);
+		make_source_(source_depth, source_image, disparity_source_cam);
+		REQUIRE(source_depth[30][40] > source_depth[10][10]);
+		
+		forward_warp<int, std::uint16_t>(
+			source_depth.cview(), source_image.cview(), disparity_source_cam, disparity_target_cam,
+			target_image.view(), target_mask.view(), target_depth.view()
+		);
+		
+		std::ptrdiff_t holes = 0, mismatches = 0;
+		compare_brute_force_(
+			source_depth, source_image, disparity_source_cam, disparity_target_cam,
+			target_image, target_mask, holes, mismatches
+		);
+		REQUIRE(mismatches == 0);
+		REQUIRE(holes > 0);
+		
+		// the square is in front of the background
+		REQUIRE(target_image[30][20] / width_ == 30);
+		REQUIRE(target_image[30][20] % width_ >= 30);
+		REQUIRE(target_depth[30][20] > target_depth[10][10]);
+	}
+}
+
+
+namespace {
+
+class warp_source : public flow::source_filter {
+public:
+	output_type<2, int> image;
+	output_type<2, std::uint16_t> depth;
+	projection_image_camera<std::uint16_t> camera = make_camera_(0.0);
+
+	warp_source() : flow::source_filter(true, 3), image(*this), depth(*this) { }
+	
+	void setup() override {
+		image.define_frame_shape(make_ndsize(height_, width_));
+		depth.define_frame_shape(make_ndsize(height_, width_));
+	}
+	
+	void process(flow::filter_job& job) override {
+		ndarray<2, std::uint16_t> d(make_ndsize(height_, width_));
+		ndarray<2, int> im(make_ndsize(height_, width_));
+		make_source_(d, im, camera);
+		job.out(image) = im.cview();
+		job.out(depth) = d.cview();
+		if(job.time() == 2) job.mark_end();
+	}
+};
+
+
+/// Counts filled pixels of warped frames, and passes through the image.
+/** Needed because all outputs of a node must have a common successor node. */
+class warp_check : public flow::filter {
+public:
+	input_type<2, int> image;
+	input_type<2, byte> mask;
+	input_type<2, std::uint16_t> depth;
+	output_type<2, int> output;
+	std::size_t frames = 0;
+	std::size_t filled_pixels = 0;
+	bool depth_valid = true;
+	
+	warp_check() : image(*this), mask(*this), depth(*this), output(*this) { }
+	
+	void setup() override {
+		output.define_frame_shape(image.frame_shape());
+	}
+	
+	void process(flow::filter_job& job) override {
+		auto m = job.in(mask);
+		auto d = job.in(depth);
+		for(std::ptrdiff_t y = 0; y < height_; ++y) for(std::ptrdiff_t x = 0; x < width_; ++x) {
+			if(m[y][x]) ++filled_pixels;
+			depth_valid = depth_valid && ((m[y][x] != 0) == (d[y][x] != 0));
+		}
+		job.out(output) = job.in(image);
+		++frames;
+	}
+};
+
+
+class warp_sink : public flow::sink_filter {
+public:
+	input_type<2, int> input;
+	
+	warp_sink() : input(*this) { }
+	
+	void process(flow::filter_job&) override { }
+};
+}
+
+
+TEST_CASE("depth_warp_filter", "[image][depth_warp][flow]") {
+	flow::filter_graph gr;
+	auto& source = gr.add_filter<warp_source>();
+	auto& warp = gr.add_filter<flow::depth_warp_filter<int, std::uint16_t>>();
+	auto& check = gr.add_filter<warp_check>();
+	auto& sink = gr.add_filter<warp_sink>();
+	warp.source_camera.set_constant(source.camera);
+	warp.target_camera.set_constant(make_camera_(0.5));
+	warp.image_input.connect(source.image);
+	warp.depth_input.connect(source.depth);
+	check.image.connect(warp.image_output);
+	check.mask.connect(warp.mask_output);
+	check.depth.connect(warp.depth_output);
+	sink.input.connect(check.output);
+	
+	gr.setup();
+	gr.run();
+	
+	REQUIRE(check.frames == 3);
+	REQUIRE(check.filled_pixels > 3 * width_ * height_ / 2);
+	REQUIRE(check.filled_pixels < 3 * width_ * height_);
+	REQUIRE(check.depth_valid);
+}
@@ -0,0 +1,141 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/image/morphology.h>
+#include <mf/image/kernel.h>
+#include <mf/nd/ndarray.h>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace mf;
+
+namespace {
+
+ndarray<2, byte> reference_morphology_(const ndarray_view<2, const byte>& in, const bool_image_kernel& kernel, bool erode) {
+	ndarray<2, byte> out(in.shape());
+	std::ptrdiff_t ry = kernel.shape()[0] / 2, rx = kernel.shape()[1] / 2;
+	for(std::ptrdiff_t y = 0; y < in.shape()[0]; ++y)
+	for(std::ptrdiff_t x = 0; x < in.shape()[1]; ++x) {
+		bool result = erode;
+		for(std::ptrdiff_t i = 0; i < kernel.shape()[0]; ++i)
+		for(std::ptrdiff_t j = 0; j < kernel.shape()[1]; ++j) {
+			if(! kernel[i][j]) continue;
+			// dilation uses reflected kernel
+			std::ptrdiff_t in_y = erode ? (y + i - ry) : (y - i + ry);
+			std::ptrdiff_t in_x = erode ? (x + j - rx) : (x - j + rx);
+			if(in_y < 0 || in_y >= in.shape()[0] || in_x < 0 || in_x >= in.shape()[1]) continue;
+			bool set = (in[in_y][in_x] != 0);
+			if(erode) result = result && set;
+			else result = result || set;
+		}
+		out[y][x] = (result ? 0xff : 0x00);
+	}
+	return out;
+}
+
+}
+
+
+TEST_CASE("morphology", "[image][morphology]") {
+	auto shp = make_ndsize(40, 53);
+	ndarray<2, byte> mask(shp);
+	std::srand(1);
+	for(std::ptrdiff_t y = 0; y < shp[0]; ++y) for(std::ptrdiff_t x = 0; x < shp[1]; ++x) {
+		bool in_shape = (y > 5 && y < 30 && x > 8 && x < 45);
+		mask[y][x] = ((std::rand() % 20 == 0) != in_shape) ? 1 + std::rand() % 255 : 0;
+	}
+	
+	bool_image_kernel irregular(make_ndsize(3, 7));
+	for(std::ptrdiff_t i = 0; i < 3; ++i) for(std::ptrdiff_t j = 0; j < 7; ++j)
+		irregular[i][j] = (j != 2 && j != 3) && (i != 0 || j > 4);
+	
+	SECTION("kernel") {
+		morphology_kernel box(box_image_kernel(5).cview());
+		REQUIRE(box.is_box());
+		REQUIRE(box.segments().size() == 5);
+		
+		morphology_kernel disk(disk_image_kernel(7).cview());
+		REQUIRE_FALSE(disk.is_box());
+		REQUIRE(disk.segments().size() == 7);
+		REQUIRE(disk.segments()[0].length == 1);
+		REQUIRE(disk.segments()[0].start == 3);
+		REQUIRE(disk.segments()[3].length == 7);
+		
+		morphology_kernel irr(irregular.cview());
+		REQUIRE(irr.segments().size() == 5);
+		auto refl = irr.reflected();
+		REQUIRE(refl.segments()[0].row == 2);
+		REQUIRE(refl.segments()[0].start == 0);
+		REQUIRE(refl.segments()[0].length == 2);
+	}
+	
+	SECTION("erode, dilate") {
+		for(const bool_image_kernel& k : { box_image_kernel(5), box_image_kernel(1), disk_image_kernel(7), disk_image_kernel(15), irregular }) {
+			morphology_kernel kernel(k.cview());
+			ndarray<2, byte> out(shp);
+			
+			erode(mask.cview(), out.view(), kernel);
+			REQUIRE(out == reference_morphology_(mask.cview(), k, true));
+			
+			dilate(mask.cview(), out.view(), kernel);
+			REQUIRE(out == reference_morphology_(mask.cview(), k, false));
+		}
+	}
+	
+	SECTION("in-place, strided") {
+		for(const bool_image_kernel& k : { box_image_kernel(7), disk_image_kernel(9), irregular }) {
+			morphology_kernel kernel(k.cview());
+			ndarray<2, byte> arr(mask);
+			erode(arr.cview(), arr.view(), kernel);
+			REQUIRE(arr == reference_morphology_(mask.cview(), k, true));
+			
+			ndarray<2, byte> out(make_ndsize(shp[0], 2*shp[1]));
+			auto section = out.view().section(make_ndptrdiff(0, 0), make_ndptrdiff(shp[0], 2*shp[1]), make_ndptrdiff(1, 2));
+			ndarray<2, byte> wide(make_ndsize(shp[0], 2*shp[1]));
+			auto in_section = wide.view().section(make_ndptrdiff(0, 1), make_ndptrdiff(shp[0], 2*shp[1]), make_ndptrdiff(1, 2));
+			std::copy(mask.begin(), mask.end(), in_section.begin());
+			REQUIRE(section.shape() == in_section.shape());
+			dilate(in_section, section, kernel);
+			REQUIRE(section == reference_morphology_(mask.cview(), k, false));
+		}
+	}
+	
+	SECTION("opening, closing") {
+		morphology_kernel kernel(disk_image_kernel(5).cview());
+		ndarray<2, byte> opened(shp), closed(shp), twice(shp);
+		opening(mask.cview(), opened.view(), kernel);
+		closing(mask.cview(), closed.view(), kernel);
+		for(std::ptrdiff_t y = 0; y < shp[0]; ++y) for(std::ptrdiff_t x = 0; x < shp[1]; ++x) {
+			if(opened[y][x]) REQUIRE(mask[y][x]);
+			if(mask[y][x]) REQUIRE(closed[y][x]);
+		}
+		
+		// idempotent
+		opening(opened.cview(), twice.view(), kernel);
+		REQUIRE(twice == opened);
+		closing(closed.cview(), twice.view(), kernel);
+		REQUIRE(twice == closed);
+		
+		// isolated noise gets removed
+		REQUIRE(opened[1][1] == 0);
+		REQUIRE(closed[20][20] == 0xff);
+	}
+}
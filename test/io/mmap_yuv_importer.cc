@@ -0,0 +1,89 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/io/mmap_yuv_importer.h>
+#include <mf/io/yuv_importer.h>
+#include <mf/nd/ndarray.h>
+#include <mf/color.h>
+#include <fstream>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+
+using namespace mf;
+
+
+TEST_CASE("mmap_yuv_importer", "[io][mmap_yuv_importer]") {
+	const std::string filename = "mmap_yuv_importer_test.yuv";
+	const std::ptrdiff_t height = 8, width = 40, duration = 3;
+	const std::size_t frame_size = height * width * 3 / 2;
+	auto value = [&](time_unit t, std::size_t i) { return std::uint8_t(t * 31 + i * 7); };
+	
+	{
+		std::ofstream file(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		for(time_unit t = 0; t < duration; ++t) for(std::size_t i = 0; i < frame_size; ++i) file.put(value(t, i));
+	}
+	
+	mmap_yuv_importer importer(filename, make_ndsize(height, width), 420);
+	importer.set_prefetch_duration(2);
+	yuv_importer reference_importer(filename, make_ndsize(height, width), 420);
+	REQUIRE(importer.total_duration() == duration);
+	
+	SECTION("planes") {
+		auto y = importer.y_plane(1);
+		auto cb = importer.cb_plane(1);
+		auto cr = importer.cr_plane(1);
+		REQUIRE(y.shape() == make_ndsize(height, width));
+		REQUIRE(cb.shape() == make_ndsize(height / 2, width / 2));
+		REQUIRE(cr.shape() == make_ndsize(height / 2, width / 2));
+		REQUIRE(y[2][3] == value(1, 2 * width + 3));
+		REQUIRE(cb[2][3] == value(1, height * width + 2 * (width / 2) + 3));
+		REQUIRE(cr[2][3] == value(1, height * width * 5 / 4 + 2 * (width / 2) + 3));
+	}
+	
+	SECTION("planes view into mapping") {
+		// no copy: planes point into the file mapping, also after reading and seeking
+		const byte* frame_data = importer.mapping().data() + 2 * frame_size;
+		ndarray<2, ycbcr_color> frame(make_ndsize(height, width));
+		importer.read_frame(frame.view());
+		importer.seek(2);
+		REQUIRE(reinterpret_cast<const byte*>(importer.y_plane(2).start()) == frame_data);
+		REQUIRE(reinterpret_cast<const byte*>(importer.cb_plane(2).start()) == frame_data + height * width);
+		REQUIRE(reinterpret_cast<const byte*>(importer.cr_plane(2).start()) == frame_data + height * width * 5 / 4);
+		REQUIRE(importer.y_plane(2).strides() == make_ndptrdiff(width, 1));
+	}
+	
+	SECTION("read and seek") {
+		ndarray<2, ycbcr_color> frame(make_ndsize(height, width));
+		ndarray<2, ycbcr_color> reference_frame(make_ndsize(height, width));
+		for(time_unit t : { 0, 1, 2, 1, 0 }) {
+			importer.seek(t);
+			reference_importer.seek(t);
+			importer.read_frame(frame.view());
+			reference_importer.read_frame(reference_frame.view());
+			REQUIRE(importer.current_time() == t + 1);
+			// compare elements, padding bytes of ycbcr_color may differ
+			REQUIRE(std::equal(frame.view().begin(), frame.view().end(), reference_frame.view().begin()));
+		}
+	}
+	
+	std::remove(filename.c_str());
+}
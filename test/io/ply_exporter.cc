@@ -0,0 +1,137 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/io/ply_exporter.h>
+#include <mf/point_cloud/point.h>
+#include <mf/nd/ndarray.h>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mf;
+
+namespace {
+
+/// Read PLY header, return vertex count and set \a in to start of data.
+std::size_t read_ply_header_(std::ifstream& in, std::vector<std::string>& properties) {
+	std::size_t count = 0;
+	std::string line;
+	while(std::getline(in, line) && line != "end_header") {
+		std::istringstream str(line);
+		std::string word;
+		str >> word;
+		if(word == "element") { str >> word >> count; }
+		else if(word == "property") { str >> word >> word; properties.push_back(word); }
+	}
+	return count;
+}
+
+}
+
+
+TEST_CASE("ply_exporter", "[io][ply_exporter]") {
+	const std::string filename = "ply_exporter_test.ply";
+	const std::size_t n = 200000; // more than one staging buffer
+	const std::size_t scalar_size = sizeof(Eigen_scalar);
+	
+	ndarray<1, point_full> points(make_ndsize(n));
+	std::size_t non_null_count = 0;
+	for(std::ptrdiff_t i = 0; i < n; ++i) {
+		point_full& pt = points[i];
+		pt = point_full(point_xyz(Eigen_vec3(i, 2*i, 3*i)));
+		pt.normal() = Eigen_vec3(0.0, 1.0, i);
+		pt.color() = rgb_color{ std::uint8_t(i), std::uint8_t(i / 256), 7 };
+		pt.weight() = 0.5 * i;
+		if(i % 3 == 1 || (i > 1000 && i < 1100)) get<point_xyz>(pt) = point_xyz();
+		else ++non_null_count;
+	}
+	
+	SECTION("binary full") {
+		{
+			ply_exporter exporter(filename, true, false);
+			exporter.write(points.cview()(0, 1234));
+			exporter.write(points.cview()(1234, n));
+		}
+		
+		std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+		std::vector<std::string> properties;
+		REQUIRE(read_ply_header_(in, properties) == non_null_count);
+		REQUIRE(properties.size() == 10);
+		
+		const std::size_t record_size = 7*scalar_size + 3;
+		std::vector<char> record(record_size);
+		bool all_equal = true;
+		for(std::ptrdiff_t i = 0; i < n; ++i) {
+			const point_full& pt = points[i];
+			if(get<point_xyz>(pt).is_null()) continue;
+			in.read(record.data(), record_size);
+			Eigen_scalar x, nz, w;
+			std::memcpy(&x, record.data(), scalar_size);
+			std::memcpy(&nz, record.data() + 5*scalar_size, scalar_size);
+			std::memcpy(&w, record.data() + 6*scalar_size + 3, scalar_size);
+			all_equal = all_equal && (x == pt.position()[0]) && (nz == pt.normal()[2]) && (w == pt.weight());
+			all_equal = all_equal && (std::uint8_t(record[6*scalar_size]) == pt.color().r);
+			all_equal = all_equal && (std::uint8_t(record[6*scalar_size + 1]) == pt.color().g);
+		}
+		REQUIRE(all_equal);
+		REQUIRE(in.peek() == std::char_traits<char>::eof());
+	}
+	
+	SECTION("binary xyz") {
+		{
+			ply_exporter exporter(filename, false, false);
+			exporter.write(points.cview());
+		}
+		
+		std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+		std::vector<std::string> properties;
+		REQUIRE(read_ply_header_(in, properties) == non_null_count);
+		REQUIRE(properties.size() == 3);
+		
+		std::vector<Eigen_scalar> data(3 * non_null_count);
+		in.read(reinterpret_cast<char*>(data.data()), data.size() * scalar_size);
+		REQUIRE(in.gcount() == data.size() * scalar_size);
+		REQUIRE(in.peek() == std::char_traits<char>::eof());
+		REQUIRE(data[0] == 0.0);
+		REQUIRE(data[3] == 2.0); // point 1 is null
+		REQUIRE(data[5] == 6.0);
+	}
+	
+	SECTION("ascii") {
+		{
+			ply_exporter exporter(filename, true, true);
+			exporter.write(points.cview()(0, 10));
+		}
+		
+		std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+		std::vector<std::string> properties;
+		REQUIRE(read_ply_header_(in, properties) == 7);
+		std::string line;
+		std::size_t lines = 0;
+		while(std::getline(in, line)) ++lines;
+		REQUIRE(lines == 7);
+	}
+	
+	std::remove(filename.c_str());
+}
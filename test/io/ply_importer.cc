@@ -0,0 +1,186 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/io/ply_importer.h>
+#include <mf/io/ply_exporter.h>
+#include <mf/point_cloud/point.h>
+#include <mf/nd/ndarray.h>
+#include <mf/utility/io.h>
+#include <mf/exceptions.h>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <limits>
+
+using namespace mf;
+
+namespace {
+
+template<typename T>
+void write_big_endian_(std::ofstream& out, T value) {
+	if(host_is_little_endian) flip_endianness(value);
+	out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}
+
+
+TEST_CASE("ply_importer", "[io][ply_importer]") {
+	const std::string filename = "ply_importer_test.ply";
+	
+	SECTION("exported") {
+		const std::size_t n = 10000; // more than one ASCII chunk
+		ndarray<1, point_full> points(make_ndsize(n));
+		for(std::ptrdiff_t i = 0; i < n; ++i) {
+			point_full& pt = points[i];
+			pt = point_full(point_xyz(Eigen_vec3(i, -2.5*i, 0.25*i)));
+			pt.normal() = Eigen_vec3(0.0, 1.0, i);
+			pt.color() = rgb_color{ std::uint8_t(i), std::uint8_t(i / 256), 7 };
+			pt.weight() = 0.5 * i;
+		}
+		
+		for(bool ascii : { false, true }) for(bool full : { true, false }) {
+			{
+				ply_exporter exporter(filename, full, ascii);
+				exporter.write(points.cview());
+			}
+			
+			ply_importer importer(filename);
+			REQUIRE(importer.size() == n);
+			REQUIRE(importer.is_ascii() == ascii);
+			REQUIRE(importer.is_binary() == ! ascii);
+			if(! ascii) REQUIRE(importer.has_host_layout_position());
+			REQUIRE(importer.tell() == 0);
+			
+			std::vector<point_full> read_points(n, point_full(point_xyz()));
+			importer.read(read_points.data(), n/2);
+			REQUIRE(importer.tell() == n/2);
+			importer.read(read_points.data() + n/2, n - n/2);
+			REQUIRE(importer.tell() == n);
+			
+			bool all_equal = true;
+			for(std::ptrdiff_t i = 0; i < n; ++i) {
+				const point_full& pt = read_points[i];
+				const point_full& expected = points[i];
+				bool eq = ! get<point_xyz>(pt).is_null();
+				if(ascii) eq = eq && pt.position().isApprox(expected.position());
+				else eq = eq && (pt.position() == expected.position());
+				if(full) {
+					if(ascii) eq = eq && pt.normal().isApprox(expected.normal()) && (std::abs(pt.weight() - expected.weight()) < 1e-3);
+					else eq = eq && (pt.normal() == expected.normal()) && (pt.weight() == expected.weight());
+					eq = eq && (pt.color() == expected.color());
+				} else {
+					eq = eq && (pt.normal() == Eigen_vec3::Zero()) && (pt.weight() == 1.0);
+					eq = eq && (pt.color() == rgb_color(255, 255, 255));
+				}
+				all_equal = all_equal && eq;
+			}
+			REQUIRE(all_equal);
+			
+			importer.rewind();
+			std::vector<point_xyz> read_xyz(n);
+			importer.read(read_xyz.data(), n);
+			REQUIRE(read_xyz[n-1].position().isApprox(points[n-1].position()));
+		}
+	}
+	
+	SECTION("big endian float") {
+		{
+			std::ofstream out(filename, std::ios_base::binary);
+			out << "ply\r\nformat binary_big_endian 1.0\r\ncomment test\r\n"
+				<< "element camera 2\r\nproperty short a\r\n"
+				<< "element vertex 3\r\nproperty float x\r\nproperty int foo\r\nproperty float y\r\nproperty float z\r\n"
+				<< "property uchar red\r\nproperty uchar green\r\nproperty uchar blue\r\nproperty ushort weight\r\n"
+				<< "end_header\r\n";
+			write_big_endian_<std::int16_t>(out, -1);
+			write_big_endian_<std::int16_t>(out, -1);
+			for(int i = 0; i < 3; ++i) {
+				write_big_endian_<float>(out, 1.5f * i);
+				write_big_endian_<std::int32_t>(out, 12345);
+				write_big_endian_<float>(out, 2.0f);
+				write_big_endian_<float>(out, -0.5f * i);
+				out.put(char(10 * i)).put(char(20)).put(char(200));
+				write_big_endian_<std::uint16_t>(out, 300 + i);
+			}
+		}
+		
+		ply_importer importer(filename);
+		REQUIRE(importer.size() == 3);
+		REQUIRE(importer.is_binary());
+		REQUIRE_FALSE(importer.has_host_layout_position());
+		
+		std::vector<point_full> read_points(3, point_full(point_xyz()));
+		importer.read(read_points.data(), 3);
+		for(int i = 0; i < 3; ++i) {
+			const point_full& pt = read_points[i];
+			REQUIRE_FALSE(get<point_xyz>(pt).is_null());
+			REQUIRE(pt.position() == Eigen_vec3(1.5 * i, 2.0, -0.5 * i));
+			REQUIRE(pt.color() == rgb_color(10 * i, 20, 200));
+			REQUIRE(pt.normal() == Eigen_vec3::Zero());
+			REQUIRE(pt.weight() == 300 + i);
+		}
+	}
+	
+	SECTION("ascii with elements before vertex") {
+		{
+			std::ofstream out(filename, std::ios_base::binary);
+			out << "ply\r\nformat ascii 1.0\r\n"
+				<< "element camera 2\r\nproperty int a\r\n"
+				<< "element vertex 4\r\nproperty float x\r\nproperty float y\r\nproperty int foo\r\nproperty float z\r\n"
+				<< "property float nx\r\n"
+				<< "element face 1\r\nproperty list uchar int vertex_indices\r\n"
+				<< "end_header\r\n"
+				<< "1\r\n2\r\n"
+				<< "1.5 2 99 -3e2 0.7\r\n"
+				<< "  4\t5 99  6 0.7 \r\n"
+				<< "-.5 +3. 0 1E+1 0\r\n"
+				<< "0.1 123456789012345678901234 0 -inf 0\r\n"
+				<< "3 0 1 2\r\n";
+		}
+		
+		ply_importer importer(filename);
+		REQUIRE(importer.size() == 4);
+		REQUIRE(importer.is_ascii());
+		
+		std::vector<point_full> read_points(4, point_full(point_xyz()));
+		importer.read(read_points.data(), 4);
+		REQUIRE(read_points[0].position() == Eigen_vec3(1.5, 2.0, -300.0));
+		REQUIRE(read_points[1].position() == Eigen_vec3(4.0, 5.0, 6.0));
+		REQUIRE(read_points[2].position() == Eigen_vec3(-0.5, 3.0, 10.0));
+		REQUIRE(read_points[3].position()[0] == 0.1);
+		REQUIRE(read_points[3].position()[1] == 123456789012345678901234.0);
+		REQUIRE(read_points[3].position()[2] == -std::numeric_limits<double>::infinity());
+		REQUIRE(read_points[0].normal() == Eigen_vec3::Zero()); // incomplete normal is not read
+	}
+	
+	SECTION("invalid") {
+		{
+			std::ofstream out(filename, std::ios_base::binary);
+			out << "ply\nformat binary_little_endian 1.0\nelement vertex 100\n"
+				<< "property float x\nproperty float y\nproperty float z\nend_header\n";
+		}
+		REQUIRE_THROWS_AS(ply_importer{filename}, ply_importer_error);
+	}
+	
+	std::remove(filename.c_str());
+}
@@ -0,0 +1,81 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/io/yuv_importer.h>
+#include <mf/nd/ndarray.h>
+#include <mf/color.h>
+#include <fstream>
+#include <cstdio>
+#include <vector>
+
+using namespace mf;
+
+
+TEST_CASE("yuv_importer", "[io][yuv_importer]") {
+	const std::string filename = "yuv_importer_test.yuv";
+	
+	auto test_sampling = [&](int sampling, std::ptrdiff_t chroma_scale) {
+		// width not multiple of vector width, so that scalar code processes tail
+		const std::ptrdiff_t height = 6, width = 70;
+		const std::ptrdiff_t chroma_height = height / chroma_scale, chroma_width = width / chroma_scale;
+		auto y_value = [&](std::ptrdiff_t y, std::ptrdiff_t x) { return std::uint8_t(y * width + x); };
+		auto cb_value = [&](std::ptrdiff_t y, std::ptrdiff_t x) { return std::uint8_t(7 * (y * chroma_width + x) + 1); };
+		auto cr_value = [&](std::ptrdiff_t y, std::ptrdiff_t x) { return std::uint8_t(3 * (y * chroma_width + x) + 2); };
+		
+		// write file with 2 frames
+		{
+			std::vector<std::uint8_t> frame;
+			for(std::ptrdiff_t y = 0; y < height; ++y) for(std::ptrdiff_t x = 0; x < width; ++x) frame.push_back(y_value(y, x));
+			for(std::ptrdiff_t y = 0; y < chroma_height; ++y) for(std::ptrdiff_t x = 0; x < chroma_width; ++x) frame.push_back(cb_value(y, x));
+			for(std::ptrdiff_t y = 0; y < chroma_height; ++y) for(std::ptrdiff_t x = 0; x < chroma_width; ++x) frame.push_back(cr_value(y, x));
+			std::ofstream file(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+			file.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+			file.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+		}
+		
+		auto verify = [&](const ndarray_view<2, ycbcr_color>& vw) {
+			for(std::ptrdiff_t y = 0; y < height; ++y) for(std::ptrdiff_t x = 0; x < width; ++x) {
+				const ycbcr_color& col = vw[y][x];
+				REQUIRE(col.y == y_value(y, x));
+				REQUIRE(col.cb == cb_value(y / chroma_scale, x / chroma_scale));
+				REQUIRE(col.cr == cr_value(y / chroma_scale, x / chroma_scale));
+			}
+		};
+		
+		yuv_importer importer(filename, make_ndsize(height, width), sampling);
+		REQUIRE(importer.total_duration() == 2);
+		
+		// contiguous output view
+		ndarray<2, ycbcr_color> contiguous(make_ndsize(height, width));
+		importer.read_frame(contiguous.view());
+		verify(contiguous.view());
+		
+		// strided output view
+		ndarray<2, ycbcr_color> strided(make_ndsize(height, 2 * width));
+		importer.read_frame(strided()(0, 2 * width, 2));
+		verify(strided()(0, 2 * width, 2));
+		
+		std::remove(filename.c_str());
+	};
+	
+	SECTION("4:2:0") { test_sampling(420, 2); }
+	SECTION("4:4:4") { test_sampling(444, 1); }
+}
@@ -0,0 +1,132 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <mf/nd/ndarray.h>
+#include <mf/nd/ndarray_algorithm.h>
+
+using namespace mf;
+
+namespace {
+
+struct pair_elem {
+	int a;
+	char b; // padding after b
+	bool operator==(const pair_elem& other) const { return (a == other.a) && (b == other.b); }
+};
+
+}
+
+
+TEST_CASE("ndarray algorithm", "[nd][ndarray_algorithm]") {
+	ndarray<3, int> arr(make_ndsize(4, 5, 6));
+	for(std::size_t i = 0; i < arr.size(); ++i) *(arr.start() + i) = i;
+	
+	SECTION("loop collapse") {
+		using loop_type = detail::ndarray_loop<3, 2>;
+		auto strides = arr.strides();
+		
+		loop_type full(arr.shape(), {{ strides, strides }});
+		REQUIRE(full.run_length() == 4*5*6);
+		REQUIRE(full.runs_count() == 1);
+		REQUIRE(full.run_stride(0) == sizeof(int));
+		
+		auto sec = arr.view()(0, 4)(1, 4)();
+		loop_type partial(sec.shape(), {{ sec.strides(), ndarray_view<3, int>::default_strides(sec.shape()) }});
+		REQUIRE(partial.run_length() == 3*6);
+		REQUIRE(partial.runs_count() == 4);
+		
+		auto sec1 = arr.view()()()(1, 4);
+		loop_type partial1(sec1.shape(), {{ sec1.strides(), ndarray_view<3, int>::default_strides(sec1.shape()) }});
+		REQUIRE(partial1.run_length() == 3);
+		REQUIRE(partial1.runs_count() == 4*5);
+		
+		auto sec2 = arr.view()(0, 4, 2)();
+		loop_type partial2(sec2.shape(), {{ sec2.strides(), sec2.strides() }});
+		REQUIRE(partial2.run_length() == 5*6);
+		REQUIRE(partial2.runs_count() == 2);
+		
+		auto col = arr.view()()(2)(3);
+		loop_type single(col.shape(), {{ col.strides(), col.strides() }});
+		REQUIRE(single.run_length() == 4);
+		REQUIRE(single.run_stride(0) == 5*6*sizeof(int));
+		
+		loop_type empty(make_ndsize(4, 0, 6), {{ strides, strides }});
+		REQUIRE(empty.runs_count() == 0);
+		REQUIRE(empty.run([](const auto&) { return false; }));
+	}
+	
+	SECTION("for_each") {
+		std::vector<int> values;
+		ndarray_for_each(arr.view()(1, 3)()(0, 6, 2), [&values](int& i) { values.push_back(i); });
+		std::vector<int> expected;
+		auto sec = arr.view()(1, 3)()(0, 6, 2);
+		for(auto it = sec.begin(); it != sec.end(); ++it) expected.push_back(*it);
+		REQUIRE(values == expected);
+		
+		ndarray_for_each(arr.view(), [](int& i) { i = -i; });
+		REQUIRE(arr[1][2][3] == -(1*30 + 2*6 + 3));
+		
+		ndarray<3, int> arr2(arr.shape());
+		ndarray_for_each(arr.cview(), arr2.view(), [](const int& a, int& b) { b = 2*a; });
+		REQUIRE(arr2[3][4][5] == 2*arr[3][4][5]);
+	}
+	
+	SECTION("copy, transform") {
+		// contiguous runs, memcpy
+		ndarray<3, int> out(make_ndsize(4, 4, 6));
+		ndarray_copy(arr.cview()()(1, 5)(), out.view());
+		REQUIRE(out == arr.cview()()(1, 5)());
+		REQUIRE(out[2][0][0] == arr[2][1][0]);
+		
+		// strided
+		ndarray<3, int> out2(make_ndsize(2, 5, 3));
+		ndarray_copy(arr.cview()(0, 4, 2)()(0, 6, 2), out2.view());
+		REQUIRE(out2 == arr.cview()(0, 4, 2)()(0, 6, 2));
+		
+		// converting
+		ndarray<3, float> fl(arr.shape());
+		ndarray_copy(arr.cview(), fl.view());
+		REQUIRE(fl[3][2][1] == float(arr[3][2][1]));
+		ndarray_transform(fl.cview(), arr.view(), [](float f) { return int(f) + 1; });
+		REQUIRE(arr[3][2][1] == 3*30 + 2*6 + 1 + 1);
+	}
+	
+	SECTION("equal") {
+		ndarray<3, int> arr2(arr);
+		REQUIRE(ndarray_equal(arr.cview(), arr2.cview()));
+		arr2[3][4][5] = 0;
+		REQUIRE_FALSE(ndarray_equal(arr.cview(), arr2.cview()));
+		REQUIRE(ndarray_equal(arr.cview()()()(0, 5), arr2.cview()()()(0, 5)));
+		REQUIRE_FALSE(ndarray_equal(arr.cview()()()(0, 5), arr2.cview()()(0, 4)()));
+		
+		// elements with padding bytes get compared with operator==
+		std::vector<pair_elem> raw_a(10), raw_b(10);
+		std::memset(raw_a.data(), 0x00, 10 * sizeof(pair_elem));
+		std::memset(raw_b.data(), 0xff, 10 * sizeof(pair_elem));
+		for(int i = 0; i < 10; ++i) { raw_a[i].a = raw_b[i].a = i; raw_a[i].b = raw_b[i].b = 'x'; }
+		ndarray_view<1, pair_elem> a(raw_a.data(), make_ndsize(10)), b(raw_b.data(), make_ndsize(10));
+		REQUIRE(ndarray_equal(a, b));
+		REQUIRE(a == b);
+	}
+}
@@ -85,6 +85,44 @@ TEST_CASE("ndarray_view_opaque", "[nd][ndarray_view_opaque]") {
 	}
 	
 	
+	SECTION("contiguous, with stride padding") {
+		// frames 3 and 7 are skipped by the views: runs of 3 frames, and one run per row
+		auto shp = make_ndsize(2, 3);
+		ndarray_opaque_frame_format frm(make_ndarray_format<int>(10));
+		std::ptrdiff_t fs = frm.frame_size();
+		std::vector<int> raw1(8 * 10);
+		std::vector<int> raw2(8 * 10);
+		for(std::size_t i = 0; i < raw1.size(); ++i) {
+			raw1[i] = i;
+			raw2[i] = 2*i + 1;
+		}
+		ndarray_view_opaque<2> vw1(static_cast<void*>(&raw1[0]), shp, make_ndptrdiff(4*fs, fs), frm);
+		ndarray_view_opaque<2> vw2(static_cast<void*>(&raw2[0]), shp, make_ndptrdiff(4*fs, fs), frm);
+		REQUIRE(vw1 != vw2);
+		vw1 = vw2;
+		REQUIRE(vw1 == vw2);
+		for(std::ptrdiff_t i = 0; i < 10; ++i) {
+			REQUIRE(raw1[3*10 + i] == 3*10 + i);
+			REQUIRE(raw1[7*10 + i] == 7*10 + i);
+			REQUIRE(raw1[6*10 + i] == raw2[6*10 + i]);
+		}
+		raw1[7*10] = -1;
+		REQUIRE(vw1 == vw2);
+		raw1[6*10 + 9] = -1;
+		REQUIRE(vw1 != vw2);
+	
+		// every second frame: one frame per run
+		ndarray_view_opaque<2> vw3(static_cast<void*>(&raw1[0]), make_ndsize(2, 2), make_ndptrdiff(4*fs, 2*fs), frm);
+		ndarray_view_opaque<2> vw4(static_cast<void*>(&raw2[0]), make_ndsize(2, 2), make_ndptrdiff(4*fs, 2*fs), frm);
+		raw1[1*10] = -1;
+		REQUIRE(vw3 != vw4);
+		vw3 = vw4;
+		REQUIRE(vw3 == vw4);
+		REQUIRE(raw1[1*10] == -1);
+		REQUIRE(raw1[6*10 + 9] == raw2[6*10 + 9]);
+	}
+	
+	
 	SECTION("non-contiguous") {
 		// 4 kinds of padding:
 		// (1) between array elements in frame part
@@ -190,6 +190,33 @@ TEST_CASE("ndarray_opaque_frame_format", "[nd][ndarray_opaque_frame_format]") {
 	}
 	
 	
+	SECTION("add and extract parts") {
+		// planar 4:2:0 frame, following a part with higher alignment
+		ndarray_opaque_frame_format planar_frm;
+		planar_frm.add_part(make_ndarray_format<std::uint8_t>(8 * 6));
+		planar_frm.add_part(make_ndarray_format<std::uint8_t>(4 * 3));
+		planar_frm.add_part(make_ndarray_format<std::uint8_t>(4 * 3));
+		REQUIRE(planar_frm.frame_size() == 8 * 6 * 3 / 2);
+		REQUIRE(planar_frm.is_contiguous());
+		
+		ndarray_opaque_frame_format frm;
+		frm.add_part(make_ndarray_format<std::int8_t>(3));
+		frm.add_parts(ndarray_opaque_frame_format(make_ndarray_format<std::int32_t>(5)));
+		frm.add_parts(planar_frm);
+		REQUIRE(frm.parts_count() == 5);
+		REQUIRE(frm.part_at(1).offset == 4);
+		REQUIRE(frm.part_at(2).offset == 4 + 5*4);
+		REQUIRE(frm.part_at(3).offset == 4 + 5*4 + 8*6);
+		REQUIRE(frm.part_at(4).offset == 4 + 5*4 + 8*6 + 4*3);
+		REQUIRE_FALSE(frm.is_contiguous());
+		REQUIRE(frm.frame_alignment_requirement() == 4);
+		
+		REQUIRE(frm.extract_parts(2, 3) == planar_frm);
+		REQUIRE(frm.extract_parts(1, 1) == ndarray_opaque_frame_format(make_ndarray_format<std::int32_t>(5)));
+		REQUIRE(frm.extract_parts(0, 2).part_at(1).offset == 4);
+	}
+	
+	
 	SECTION("raw") {
 		ndarray_opaque_frame_format frm(1024, 2);
 		REQUIRE(frm.is_defined());
@@ -0,0 +1,96 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/nd/ndarray.h>
+#include <mf/nd/ndarray_parallel.h>
+#include <mf/nd/ndarray_filter.h>
+#include <cstdint>
+
+using namespace mf;
+
+
+TEST_CASE("ndarray parallel", "[nd][ndarray_parallel]") {
+	ndarray<3, int> arr(make_ndsize(40, 300, 50));
+	for(std::size_t i = 0; i < arr.size(); ++i) *(arr.start() + i) = i % 1000;
+	
+	SECTION("tiles") {
+		auto tiles = parallel_tiles(arr.shape(), sizeof(int), 64 * 1024);
+		// slice on axis 0 is 60000 bytes: chunks of one slice
+		REQUIRE(tiles.size() == 40);
+		REQUIRE(tiles[3] == make_ndspan(make_ndptrdiff(3, 0, 0), make_ndptrdiff(4, 300, 50)));
+		
+		auto small_tiles = parallel_tiles(arr.shape(), sizeof(int), 16 * 1024);
+		// slices on axis 1 are 200 bytes: chunks of 81 slices
+		REQUIRE(small_tiles.size() == 40 * 4);
+		REQUIRE(small_tiles[1] == make_ndspan(make_ndptrdiff(0, 81, 0), make_ndptrdiff(1, 162, 50)));
+		REQUIRE(small_tiles[3] == make_ndspan(make_ndptrdiff(0, 243, 0), make_ndptrdiff(1, 300, 50)));
+		
+		std::size_t total = 0;
+		for(const auto& tile : small_tiles) total += tile.size();
+		REQUIRE(total == arr.size());
+		
+		REQUIRE(parallel_tiles(make_ndsize(0, 10), 4).empty());
+		REQUIRE(parallel_tiles(make_ndsize(10, 10), 4).size() == 1);
+	}
+	
+	SECTION("copy, transform, for_each") {
+		ndarray<3, int> out(arr.shape());
+		parallel_copy(arr.cview(), out.view());
+		REQUIRE(out == arr);
+		
+		ndarray<3, int> strided_out(make_ndsize(40, 300, 25));
+		parallel_copy(arr.cview()()()(0, 50, 2), strided_out.view());
+		REQUIRE(strided_out == arr.cview()()()(0, 50, 2));
+		
+		ndarray<3, float> fl(arr.shape());
+		parallel_transform(arr.cview(), fl.view(), [](int i) { return 0.5f * i; });
+		REQUIRE(fl[12][34][5] == 0.5f * arr[12][34][5]);
+		
+		parallel_for_each(out.view(), [](int& i) { i = -i; });
+		REQUIRE(out[39][299][49] == -arr[39][299][49]);
+	}
+	
+	SECTION("reduce") {
+		std::int64_t expected = 0;
+		for(int i : arr) expected += i;
+		std::int64_t sum = parallel_reduce(arr.cview(), std::int64_t(0),
+			[](std::int64_t acc, int i) { return acc + i; },
+			[](std::int64_t a, std::int64_t b) { return a + b; });
+		REQUIRE(sum == expected);
+	}
+	
+	SECTION("apply_kernel") {
+		ndarray<2, float> in(make_ndsize(200, 300)), out(in.shape()), expected(in.shape());
+		for(std::ptrdiff_t y = 0; y < 200; ++y) for(std::ptrdiff_t x = 0; x < 300; ++x) in[y][x] = (x * y) % 17;
+		ndarray<2, float> kernel(make_ndsize(3, 5));
+		for(std::size_t i = 0; i < kernel.size(); ++i) *(kernel.start() + i) = i;
+		
+		auto sum = [](const auto& placement, float& out) {
+			float s = 0.0;
+			for(auto it = placement.view_section.begin(); it != placement.view_section.end(); ++it)
+				s += *it * placement.kernel_section.at(it.coordinates());
+			out = s;
+		};
+		apply_kernel(sum, in.cview(), expected.view(), kernel.cview());
+		parallel_apply_kernel(sum, in.cview(), out.view(), kernel.cview());
+		REQUIRE(out == expected);
+	}
+}
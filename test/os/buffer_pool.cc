@@ -0,0 +1,117 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/os/buffer_pool.h>
+#include <mf/os/memory.h>
+#include <mf/common.h>
+
+using namespace mf;
+
+
+TEST_CASE("buffer_pool", "[buffer_pool]") {
+	buffer_pool& pool = buffer_pool::instance();
+	std::size_t original_capacity = pool.capacity();
+	pool.set_capacity(64 * 1024 * 1024);
+	pool.clear();
+	
+	SECTION("heap") {
+		raw_allocator allocator;
+		std::size_t n = pool.minimal_heap_size();
+		auto stat = pool.get_statistics();
+		
+		void* buf1 = allocator.raw_allocate(n, 16);
+		REQUIRE(pool.get_statistics().misses == stat.misses + 1);
+		allocator.raw_deallocate(buf1, n);
+		REQUIRE(pool.get_statistics().retained_buffers == 1);
+		REQUIRE(pool.get_statistics().retained_size == n);
+
+		// same size: reuses buffer
+		void* buf2 = allocator.raw_allocate(n, 16);
+		REQUIRE(buf2 == buf1);
+		REQUIRE(pool.get_statistics().hits == stat.hits + 1);
+		REQUIRE(pool.get_statistics().retained_buffers == 0);
+		
+		// other size: not reused
+		void* buf3 = allocator.raw_allocate(2 * n, 16);
+		REQUIRE(pool.get_statistics().misses == stat.misses + 2);
+		
+		allocator.raw_deallocate(buf2, n);
+		allocator.raw_deallocate(buf3, 2 * n);
+		REQUIRE(pool.get_statistics().retained_size == 3 * n);
+		
+		// small buffers bypass pool
+		void* buf4 = allocator.raw_allocate(n / 2, 16);
+		allocator.raw_deallocate(buf4, n / 2);
+		REQUIRE(pool.get_statistics().misses == stat.misses + 2);
+		REQUIRE(pool.get_statistics().retained_buffers == 2);
+	}
+	
+	SECTION("ring") {
+		raw_ring_allocator allocator;
+		std::size_t n = raw_round_up_to_fit_system_page_size(100);
+		auto stat = pool.get_statistics();
+	
+		byte* buf1 = static_cast<byte*>(allocator.raw_allocate(n));
+		buf1[7] = byte(123);
+		allocator.raw_deallocate(buf1, n);
+		
+		// same size and options: reuses mapping
+		byte* buf2 = static_cast<byte*>(allocator.raw_allocate(n));
+		REQUIRE(buf2 == buf1);
+		REQUIRE(pool.get_statistics().hits == stat.hits + 1);
+		REQUIRE(buf2[n + 7] == byte(123));
+		
+		// other options: not reused
+		raw_ring_allocator numa_allocator(false, 0);
+		allocator.raw_deallocate(buf2, n);
+		void* buf3 = numa_allocator.raw_allocate(n);
+		REQUIRE(buf3 != buf2);
+		REQUIRE(pool.get_statistics().misses == stat.misses + 2);
+		numa_allocator.raw_deallocate(buf3, n);
+		REQUIRE(pool.get_statistics().retained_buffers == 2);
+	}
+	
+	SECTION("capacity") {
+		raw_allocator allocator;
+		std::size_t n = pool.minimal_heap_size();
+		
+		pool.set_capacity(2 * n);
+		void* buf1 = allocator.raw_allocate(n);
+		void* buf2 = allocator.raw_allocate(n);
+		void* buf3 = allocator.raw_allocate(n);
+		allocator.raw_deallocate(buf1, n);
+		allocator.raw_deallocate(buf2, n);
+		allocator.raw_deallocate(buf3, n);
+		REQUIRE(pool.get_statistics().retained_size == 2 * n);
+		
+		pool.set_capacity(n);
+		REQUIRE(pool.get_statistics().retained_size == n);
+		
+		pool.set_capacity(0);
+		REQUIRE(pool.get_statistics().retained_size == 0);
+		void* buf4 = allocator.raw_allocate(n);
+		allocator.raw_deallocate(buf4, n);
+		REQUIRE(pool.get_statistics().retained_buffers == 0);
+	}
+	
+	pool.clear();
+	pool.set_capacity(original_capacity);
+}
@@ -26,10 +26,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 using namespace mf;
 
 
-TEST_CASE("ring_allocator", "[ring_allocator]") {
-	raw_ring_allocator allocator;
-	std::size_t n = raw_round_up_to_fit_system_page_size(100);
-	
+static void test_ring_allocator_(raw_ring_allocator& allocator, std::size_t n) {
 	// allocate
 	void* buf_raw = allocator.raw_allocate(n);
 	REQUIRE(buf_raw != nullptr);
@@ -56,3 +53,27 @@ TEST_CASE("ring_allocator", "[ring_allocator]") {
 	// deallocate
 	allocator.raw_deallocate(buf_raw, n);
 }
+
+
+TEST_CASE("ring_allocator", "[ring_allocator]") {
+	SECTION("default") {
+		raw_ring_allocator allocator;
+		test_ring_allocator_(allocator, raw_round_up_to_fit_system_page_size(100));
+	}
+	
+	SECTION("huge pages") {
+		// falls back to normal pages when no huge pages available
+		raw_ring_allocator allocator(true);
+		REQUIRE(allocator.huge_pages());
+		test_ring_allocator_(allocator, raw_round_up_to_fit_system_page_size(100));
+		test_ring_allocator_(allocator, 2 * 1024 * 1024);
+	}
+	
+	SECTION("numa node") {
+		int node = current_numa_node();
+		if(node == -1) node = 0;
+		raw_ring_allocator allocator(false, node);
+		REQUIRE(allocator.numa_node() == node);
+		test_ring_allocator_(allocator, raw_round_up_to_fit_system_page_size(100));
+	}
+}
@@ -0,0 +1,67 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/os/worker_pool.h>
+#include <mf/common.h>
+#include <atomic>
+#include <vector>
+#include <stdexcept>
+
+using namespace mf;
+
+
+TEST_CASE("worker_pool", "[worker_pool]") {
+	worker_pool& pool = worker_pool::instance();
+	std::size_t original_workers_count = pool.workers_count();
+	pool.set_workers_count(3);
+	
+	SECTION("parallel_for") {
+		std::vector<std::atomic<int>> calls(1000);
+		for(auto& c : calls) c = 0;
+		pool.parallel_for(calls.size(), [&calls](std::ptrdiff_t i) { calls[i]++; });
+		for(auto& c : calls) REQUIRE(c == 1);
+		
+		pool.parallel_for(0, [](std::ptrdiff_t) { FAIL(); });
+	}
+	
+	SECTION("nested") {
+		std::atomic<int> count(0);
+		pool.parallel_for(8, [&](std::ptrdiff_t) {
+			pool.parallel_for(8, [&](std::ptrdiff_t) { count++; });
+		});
+		REQUIRE(count == 64);
+	}
+	
+	SECTION("exception") {
+		REQUIRE_THROWS_AS(
+			pool.parallel_for(100, [](std::ptrdiff_t i) { if(i == 50) throw std::runtime_error("test"); }),
+			std::runtime_error
+		);
+	}
+	
+	SECTION("no workers") {
+		pool.set_workers_count(0);
+		std::thread::id caller = std::this_thread::get_id();
+		pool.parallel_for(10, [caller](std::ptrdiff_t) { REQUIRE(std::this_thread::get_id() == caller); });
+	}
+	
+	pool.set_workers_count(original_workers_count);
+}
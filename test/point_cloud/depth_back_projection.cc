@@ -0,0 +1,78 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/point_cloud/depth_back_projection.h>
+#include <mf/nd/ndarray.h>
+#include <cstdint>
+
+using namespace mf;
+
+TEST_CASE("depth back-projection", "[point_cloud][depth_back_projection]") {
+	depth_projection_parameters dparam;
+	dparam.z_near = 1.0;
+	dparam.z_far = 100.0;
+	dparam.flip_z = false;
+	
+	Eigen_mat3 intrinsic; intrinsic <<
+		400.0, 0.0, 160.0,
+		0.0, 380.0, 110.0,
+		0.0, 0.0, 1.0;
+	projection_image_camera<std::uint16_t> cam(
+		pose(Eigen_vec3(0.5, -0.2, 3.0), Eigen_quaternion(Eigen_angleaxis(0.3, Eigen_vec3::UnitY()))),
+		intrinsic,
+		dparam,
+		make_ndsize(320, 230)
+	);
+	cam.flip_pixel_coordinates();
+	
+	const std::size_t height = 230, width = 320;
+	ndarray<2, std::uint16_t> depth(make_ndsize(height, width));
+	for(std::ptrdiff_t y = 0; y < height; ++y) for(std::ptrdiff_t x = 0; x < width; ++x)
+		depth[y][x] = ((x + y) % 11 == 0) ? 0 : std::uint16_t(1000 + 97 * x + 13 * y);
+	
+	auto compare = [&](const ndarray_view<2, const point_xyz>& points) {
+		bool all_equal = true;
+		for(std::ptrdiff_t y = 0; y < height; ++y) for(std::ptrdiff_t x = 0; x < width; ++x) {
+			const point_xyz& pt = points[y][x];
+			std::uint16_t d = depth[y][x];
+			if(d == 0) {
+				all_equal = all_equal && pt.is_null();
+			} else {
+				Eigen_vec3 expected = cam.point(cam.to_image(make_ndptrdiff(y, x)), cam.to_depth(d));
+				all_equal = all_equal && ! pt.is_null() && pt.position().isApprox(expected, 1e-9);
+			}
+		}
+		return all_equal;
+	};
+	
+	SECTION("contiguous") {
+		ndarray<2, point_xyz> points(depth.shape());
+		back_project<std::uint16_t>(depth.cview(), cam, points.view());
+		REQUIRE(compare(points.cview()));
+	}
+	
+	SECTION("strided") {
+		ndarray<2, point_xyz> points(make_ndsize(height, 2 * width));
+		auto section = points.view()(0, height)(0, 2 * width, 2);
+		back_project<std::uint16_t>(depth.cview(), cam, section);
+		REQUIRE(compare(section));
+	}
+}
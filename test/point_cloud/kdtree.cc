@@ -0,0 +1,116 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/point_cloud/kdtree.h>
+#include <mf/geometry/projection_view_frustum.h>
+#include <mf/nd/ndarray.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace mf;
+
+TEST_CASE("point_cloud_kdtree", "[point_cloud][kdtree]") {
+	const std::size_t n = 20000;
+	ndarray<1, point_xyz> points(make_ndsize(n));
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<Eigen_scalar> dist(-10.0, 10.0);
+	for(std::size_t i = 0; i < n; ++i) {
+		if(i % 7 == 3) points[i] = point_xyz();
+		else points[i] = point_xyz(Eigen_vec3(dist(gen), dist(gen), 0.3 * dist(gen)));
+	}
+	std::vector<std::ptrdiff_t> valid;
+	for(std::ptrdiff_t i = 0; i < std::ptrdiff_t(n); ++i) if(! points[i].is_null()) valid.push_back(i);
+	
+	point_cloud<const point_xyz> pc(points.cview());
+	point_cloud_kdtree tree(pc);
+	REQUIRE(tree.size() == valid.size());
+	
+	std::vector<Eigen_vec3> centers;
+	for(int i = 0; i < 200; ++i) centers.emplace_back(dist(gen), dist(gen), dist(gen));
+	centers.push_back(points[0].position());
+	
+	SECTION("radius search") {
+		const Eigen_scalar radius = 1.5;
+		auto results = tree.radius_search(centers, radius);
+		REQUIRE(results.size() == centers.size());
+		bool all_equal = true;
+		for(std::size_t q = 0; q < centers.size(); ++q) {
+			std::vector<std::ptrdiff_t> expected;
+			for(std::ptrdiff_t i : valid)
+				if((points[i].position() - centers[q]).squaredNorm() <= radius * radius) expected.push_back(i);
+			std::vector<std::ptrdiff_t> got = results[q];
+			std::sort(got.begin(), got.end());
+			all_equal = all_equal && (got == expected);
+		}
+		REQUIRE(all_equal);
+		REQUIRE_FALSE(results.back().empty());
+	}
+	
+	SECTION("nearest neighbors") {
+		const std::size_t k = 10;
+		auto results = tree.nearest_neighbors(centers, k);
+		bool all_equal = true;
+		for(std::size_t q = 0; q < centers.size(); ++q) {
+			std::vector<Eigen_scalar> expected;
+			for(std::ptrdiff_t i : valid) expected.push_back((points[i].position() - centers[q]).squaredNorm());
+			std::sort(expected.begin(), expected.end());
+			const auto& got = results[q];
+			all_equal = all_equal && (got.size() == k);
+			for(std::size_t j = 0; j < k && j < got.size(); ++j) {
+				all_equal = all_equal && (got[j].first == expected[j]);
+				all_equal = all_equal && ((points[got[j].second].position() - centers[q]).squaredNorm() == got[j].first);
+			}
+		}
+		REQUIRE(all_equal);
+		REQUIRE(results.back().front().second == 0);
+		REQUIRE(tree.nearest_neighbors(centers[0], n).size() == valid.size());
+	}
+	
+	SECTION("frustum cull") {
+		depth_projection_parameters dparam;
+		dparam.z_near = 1.0;
+		dparam.z_far = 8.0;
+		auto fr = projection_view_frustum::symmetric_perspective_fov(angle::degrees(60), angle::degrees(40), dparam);
+		auto planes = fr.planes();
+		
+		std::vector<std::ptrdiff_t> got = tree.frustum_cull(fr);
+		std::sort(got.begin(), got.end());
+		std::vector<std::ptrdiff_t> expected;
+		for(std::ptrdiff_t i : valid) {
+			bool inside = std::all_of(planes.begin(), planes.end(), [&](const Eigen_hyperplane3& pl) {
+				return pl.signedDistance(points[i].position()) > 0;
+			});
+			if(inside) expected.push_back(i);
+		}
+		REQUIRE(got == expected);
+		REQUIRE(expected.size() > 100);
+		REQUIRE(fr.contains(points[expected.front()].position()));
+	}
+	
+	SECTION("empty") {
+		ndarray<1, point_xyz> null_points(make_ndsize(5));
+		point_cloud_kdtree empty_tree(null_points.cview());
+		REQUIRE(empty_tree.size() == 0);
+		REQUIRE(empty_tree.radius_search(Eigen_vec3::Zero(), 1.0).empty());
+		REQUIRE(empty_tree.nearest_neighbors(Eigen_vec3::Zero(), 3).empty());
+	}
+}
@@ -238,3 +238,48 @@ TEST_CASE("rng", "[queue][rng]") {
 		REQUIRE(rng.readable_duration() == 3);
 	}
 }
+
+
+TEST_CASE("rng with huge pages", "[queue][rng]") {
+	// frame size not multiple of page size nor huge page size, like video frames
+	ndarray_opaque_frame_format frm;
+	frm.add_part(make_ndarray_format<std::uint8_t>(3 * 640 * 360));
+	const std::size_t frame_size = frm.frame_size();
+	std::size_t capacity = 3;
+	raw_ring_allocator allocator(true);
+	REQUIRE_FALSE(is_multiple_of(capacity * frame_size, system_page_size()));
+	
+	// ring size is rounded up to huge page size (if supported), so that huge pages can be used
+	ring rng(frm, capacity, allocator);
+	if(system_huge_page_size() != 0) REQUIRE(allocator.segment_granularity() == system_huge_page_size());
+	auto whole = rng.section(0, capacity);
+	REQUIRE(whole.strides().front() >= std::ptrdiff_t(frame_size));
+	REQUIRE(is_multiple_of(whole.strides().front() * capacity, allocator.segment_granularity()));
+	
+	auto fill = [&](const frame_array_view& section, std::ptrdiff_t i, int value) {
+		byte* frame = static_cast<byte*>(section[i].start());
+		std::fill(frame, frame + frame_size, byte(value));
+	};
+	auto is_filled = [&](const frame_array_view& section, std::ptrdiff_t i, int value) {
+		const byte* frame = static_cast<const byte*>(section[i].start());
+		return std::all_of(frame, frame + frame_size, [value](byte b) { return b == byte(value); });
+	};
+	
+	// write and read across the end of the ring
+	auto w_section(rng.begin_write(2));
+	fill(w_section, 0, 1);
+	fill(w_section, 1, 2);
+	rng.end_write(2);
+	rng.skip(2);
+	w_section.reset(rng.begin_write(3));
+	fill(w_section, 0, 3);
+	fill(w_section, 1, 4);
+	fill(w_section, 2, 5);
+	rng.end_write(3);
+	
+	auto r_section(rng.begin_read(3));
+	REQUIRE(is_filled(r_section, 0, 3));
+	REQUIRE(is_filled(r_section, 1, 4));
+	REQUIRE(is_filled(r_section, 2, 5));
+	rng.end_read(3);
+}
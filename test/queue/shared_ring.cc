@@ -432,3 +432,252 @@ TEST_CASE("shared_ring", "[queue][shared_ring]") {
 		}
 	}
 }
+
+
+TEST_CASE("shared_ring producer and consumer", "[queue][shared_ring]") {
+	auto frm = opaque_frame_format();
+	const time_unit end_time = 300;
+	
+	// durations chosen such that write and read waits never exceed capacity together (no deadlock)
+	// and varying so that sections wrap around at different positions
+	for(time_unit capacity : { 1, 2, 3, 4, 5, 7, 8, 13, 16 }) {
+		shared_ring rng(frm, capacity, end_time);
+		time_unit max_write_duration = (capacity + 1) / 2;
+		time_unit max_read_duration = capacity + 1 - max_write_duration;
+		
+		MF_TEST_THREAD() {
+			for(int i = 0;; ++i) {
+				time_unit duration = 1 + (i % max_write_duration);
+				auto w_section = rng.begin_write(duration);
+				if(w_section.duration() == 0) break;
+				MF_TEST_THREAD_REQUIRE(w_section.start_time() == rng.write_start_time());
+				// sometimes write less than requested
+				time_unit written = (i % 3 == 2) ? (w_section.duration() + 1) / 2 : w_section.duration();
+				for(std::ptrdiff_t j = 0; j < written; ++j) w_section[j] = make_opaque_frame(w_section.time_at(j));
+				rng.end_write(written);
+			}
+			MF_TEST_THREAD_REQUIRE(rng.writer_reached_end());
+		};
+		
+		time_unit expected_time = 0;
+		bool all_frames_correct = true;
+		for(int i = 0; ! rng.reader_reached_end(); ++i) {
+			time_unit duration = 1 + ((7 * i) % max_read_duration);
+			auto r_section = rng.begin_read(duration);
+			REQUIRE(r_section.start_time() == expected_time);
+			REQUIRE(r_section.duration() == std::min(duration, end_time - expected_time));
+			for(std::ptrdiff_t j = 0; j < r_section.duration(); ++j)
+				all_frames_correct = all_frames_correct && (opaque_frame_index(r_section[j]) == expected_time + j);
+			// sometimes read less than available
+			time_unit read = (i % 4 == 3) ? r_section.duration() / 2 : r_section.duration();
+			rng.end_read(read);
+			expected_time += read;
+		}
+		REQUIRE(all_frames_correct);
+		REQUIRE(expected_time == end_time);
+		REQUIRE(rng.begin_read(1).duration() == 0);
+	}
+}
+
+
+TEST_CASE("shared_ring non-blocking access", "[queue][shared_ring]") {
+	auto frm = opaque_frame_format();
+	shared_ring rng(frm, 4, 6);
+	
+	// empty: nothing readable
+	REQUIRE(rng.try_begin_read(1).is_null());
+	
+	// fill
+	auto w_section = rng.try_begin_write(4);
+	REQUIRE_FALSE(w_section.is_null());
+	REQUIRE(w_section.start_time() == 0);
+	REQUIRE(w_section.duration() == 4);
+	for(std::ptrdiff_t i = 0; i < 4; ++i) w_section[i] = make_opaque_frame(i);
+	rng.end_write(4);
+	
+	// full: nothing writable
+	REQUIRE(rng.try_begin_write(1).is_null());
+	REQUIRE(rng.try_begin_read(4).duration() == 4);
+	rng.end_read(1);
+	
+	// one frame writable
+	REQUIRE(rng.try_begin_write(2).is_null());
+	w_section.reset(rng.try_begin_write(1));
+	REQUIRE_FALSE(w_section.is_null());
+	REQUIRE(w_section.start_time() == 4);
+	w_section[0] = make_opaque_frame(4);
+	rng.end_write(1);
+	
+	// more frames requested than readable
+	REQUIRE(rng.try_begin_read(4).duration() == 4);
+	rng.end_read(4);
+	REQUIRE(rng.try_begin_read(1).is_null());
+	
+	// near end: truncated, and zero-length at end
+	w_section.reset(rng.try_begin_write(3));
+	REQUIRE(w_section.duration() == 1);
+	w_section[0] = make_opaque_frame(5);
+	rng.end_write(1);
+	REQUIRE(rng.writer_reached_end());
+	REQUIRE(rng.try_begin_write(1).duration() == 0);
+	
+	auto r_section = rng.try_begin_read(3);
+	REQUIRE(r_section.duration() == 1);
+	REQUIRE(compare_opaque_frames(r_section, {5}));
+	rng.end_read(1);
+	REQUIRE(rng.reader_reached_end());
+	REQUIRE(rng.try_begin_read(1).duration() == 0);
+}
+
+
+TEST_CASE("shared_ring seek with parked writer", "[queue][shared_ring]") {
+	auto frm = opaque_frame_format();
+	shared_ring rng(frm, 5, 200);
+	
+	SECTION("writer waiting for frames") {
+		// fill buffer, so that writer waits
+		auto w_section = rng.begin_write(5);
+		for(std::ptrdiff_t i = 0; i < 5; ++i) w_section[i] = make_opaque_frame(i);
+		rng.end_write(5);
+		
+		std::atomic<time_unit> write_start{-1};
+		MF_TEST_THREAD() {
+			auto w_section = rng.begin_write(2);
+			write_start = w_section.start_time();
+			for(std::ptrdiff_t i = 0; i < 2; ++i) w_section[i] = make_opaque_frame(w_section.time_at(i));
+			rng.end_write(2);
+		};
+		
+		std::this_thread::sleep_for(10ms);
+		REQUIRE(write_start == -1);
+		
+		// long seek: writer wakes up and writes at new position
+		rng.seek(100);
+		auto r_section = rng.begin_read(2);
+		REQUIRE(write_start == 100);
+		REQUIRE(compare_opaque_frames(r_section, {100, 101}));
+		rng.end_read(2);
+	}
+	
+	SECTION("writer accessing frames") {
+		std::atomic<bool> accessing{false}, ending{false};
+		MF_TEST_THREAD() {
+			auto w_section = rng.begin_write(2);
+			MF_TEST_THREAD_REQUIRE(w_section.start_time() == 0);
+			accessing = true;
+			std::this_thread::sleep_for(20ms);
+			for(std::ptrdiff_t i = 0; i < 2; ++i) w_section[i] = make_opaque_frame(w_section.time_at(i));
+			ending = true;
+			rng.end_write(2);
+			
+			// next write is at the seek target
+			w_section.reset(rng.begin_write(3));
+			MF_TEST_THREAD_REQUIRE(w_section.start_time() == 100);
+			for(std::ptrdiff_t i = 0; i < 3; ++i) w_section[i] = make_opaque_frame(w_section.time_at(i));
+			rng.end_write(3);
+		};
+		
+		while(! accessing) std::this_thread::yield();
+		
+		// seek waits until writer ends its access
+		rng.seek(100);
+		REQUIRE(ending);
+		REQUIRE(rng.read_start_time() == 100);
+		
+		auto r_section = rng.begin_read(3);
+		REQUIRE(compare_opaque_frames(r_section, {100, 101, 102}));
+		rng.end_read(3);
+	}
+}
+
+
+TEST_CASE("shared_ring break waiting thread", "[queue][shared_ring]") {
+	auto frm = opaque_frame_format();
+	shared_ring rng(frm, 5, 200);
+	
+	// break is retried until the waiter returns: it must stop waiting whether
+	// it is still spinning, or already blocked on the condition variable
+	SECTION("reader") {
+		std::atomic<bool> done{false};
+		bool broken = false, wait_broken = false;
+		MF_TEST_THREAD() {
+			wait_broken = ! rng.wait_readable();
+			broken = rng.begin_read(3).is_null();
+			done = true;
+		};
+		for(int i = 0; ! done; ++i) {
+			rng.break_reader();
+			if(i % 2) std::this_thread::sleep_for(1ms);
+			else std::this_thread::yield();
+		}
+		REQUIRE(wait_broken);
+		REQUIRE(broken);
+		REQUIRE(rng.read_start_time() == 0);
+	}
+	
+	SECTION("writer") {
+		auto w_section = rng.begin_write(5);
+		for(std::ptrdiff_t i = 0; i < 5; ++i) w_section[i] = make_opaque_frame(i);
+		rng.end_write(5);
+		
+		std::atomic<bool> done{false};
+		bool broken = false, wait_broken = false;
+		MF_TEST_THREAD() {
+			wait_broken = ! rng.wait_writable();
+			broken = rng.begin_write(3).is_null();
+			done = true;
+		};
+		for(int i = 0; ! done; ++i) {
+			rng.break_writer();
+			if(i % 2) std::this_thread::sleep_for(1ms);
+			else std::this_thread::yield();
+		}
+		REQUIRE(wait_broken);
+		REQUIRE(broken);
+		REQUIRE(rng.write_start_time() == 5);
+	}
+}
+
+
+TEST_CASE("shared_ring end of stream with partial write", "[queue][shared_ring]") {
+	auto frm = opaque_frame_format();
+	const time_unit end_time = 11;
+	shared_ring rng(frm, 4, end_time);
+	
+	MF_TEST_THREAD() {
+		time_unit t = 0;
+		for(;;) {
+			auto w_section = rng.begin_write(4);
+			if(w_section.duration() == 0) {
+				MF_TEST_THREAD_REQUIRE(w_section.start_time() == end_time);
+				break;
+			}
+			MF_TEST_THREAD_REQUIRE(w_section.start_time() == t);
+			// last section gets truncated to 3 frames (8, 9, 10), of which only 2 get written at first
+			time_unit written = (t == 8) ? 2 : w_section.duration();
+			for(std::ptrdiff_t i = 0; i < written; ++i) w_section[i] = make_opaque_frame(w_section.time_at(i));
+			rng.end_write(written);
+			t += written;
+		}
+		MF_TEST_THREAD_REQUIRE(rng.writer_reached_end());
+	};
+	
+	auto r_section = rng.begin_read(4);
+	REQUIRE(compare_opaque_frames(r_section, {0, 1, 2, 3}));
+	rng.end_read(4);
+	r_section.reset(rng.begin_read(4));
+	REQUIRE(compare_opaque_frames(r_section, {4, 5, 6, 7}));
+	rng.end_read(4);
+	
+	// truncated at end time, and waits for frame written after the partial write
+	r_section.reset(rng.begin_read(4));
+	REQUIRE(r_section.start_time() == 8);
+	REQUIRE(r_section.duration() == 3);
+	REQUIRE(compare_opaque_frames(r_section, {8, 9, 10}));
+	rng.end_read(3);
+	
+	REQUIRE(rng.reader_reached_end());
+	r_section.reset(rng.begin_read(4));
+	REQUIRE(r_section.duration() == 0);
+	REQUIRE(r_section.start_time() == end_time);
+}
@@ -0,0 +1,136 @@
+/*
+Author : Tim Lenertz
+Date : May 2016
+
+Copyright (c) 2016, Université libre de Bruxelles
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+documentation files to deal in the Software without restriction, including the rights to use, copy, modify, merge,
+publish the Software, and to permit persons to whom the Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch.hpp>
+#include <mf/stereo/disparity_cost_volume.h>
+#include <mf/nd/ndarray.h>
+#include <cmath>
+#include <random>
+
+using namespace mf;
+
+namespace {
+
+projection_image_camera<int> make_camera_(real x, real principal_x) {
+	depth_projection_parameters dparam;
+	dparam.z_near = 1.0;
+	dparam.z_far = 100.0;
+	dparam.flip_z = false;
+	Eigen_mat3 intrinsic; intrinsic <<
+		100.0, 0.0, principal_x,
+		0.0, 100.0, 24.0,
+		0.0, 0.0, 1.0;
+	return projection_image_camera<int>(
+		pose(Eigen_vec3(x, 0.0, 0.0), Eigen_quaternion::Identity()),
+		intrinsic,
+		dparam,
+		make_ndsize(64, 48)
+	);
+}
+
+}
+
+
+TEST_CASE("disparity_cost_volume", "[stereo][disparity_cost_volume]") {
+	const std::ptrdiff_t rows = 48, columns = 64;
+	auto true_disparity = [](std::ptrdiff_t y, std::ptrdiff_t x) {
+		return (y >= 16 && y < 32 && x >= 24 && x < 44) ? 9 : 3;
+	};
+	
+	// Source pixel (y, x) shows target pixel (y, x - disparity)
+	ndarray<2, float> source_image(make_ndsize(rows, columns));
+	ndarray<2, float> target_image(make_ndsize(rows, columns));
+	std::mt19937 gen(3);
+	std::uniform_real_distribution<float> dist(0.0f, 255.0f);
+	for(std::ptrdiff_t y = 0; y < rows; ++y) for(std::ptrdiff_t x = 0; x < columns; ++x) target_image[y][x] = dist(gen);
+	for(std::ptrdiff_t y = 0; y < rows; ++y) for(std::ptrdiff_t x = 0; x < columns; ++x)
+		source_image[y][x] = target_image[y][std::max<std::ptrdiff_t>(x - true_disparity(y, x), 0)];
+	
+	auto cost = [&](const projection_image_camera<int>&, const ndptrdiff<2>& s, const projection_image_camera<int>&, const ndptrdiff<2>& t) {
+		return std::abs(source_image[s[1]][s[0]] - target_image[t[1]][t[0]]);
+	};
+	
+	auto left_cam = make_camera_(-0.5, 32.0);
+	auto right_cam = make_camera_(+0.5, 32.0);
+	disparity_cost_volume<decltype(cost)> cost_volume(left_cam, right_cam, true, cost, 16);
+	REQUIRE(cost_volume.shape() == make_ndsize(rows, columns));
+	REQUIRE(cost_volume.zero_disparity_offset() == 0);
+	REQUIRE(cost_volume.target_coordinates(make_ndptrdiff(20, 10), 3) == make_ndptrdiff(17, 10));
+	REQUIRE(cost_volume.target_coordinates(make_ndptrdiff(1, 10), 3) == make_ndptrdiff(0, 10));
+	REQUIRE(cost_volume.cost(make_ndptrdiff(20, 10), 3) == 0.0);
+	REQUIRE(cost_volume.cost(make_ndptrdiff(20, 10), 4) != 0.0);
+	
+	SECTION("zero disparity offset") {
+		auto shifted_cam = make_camera_(+0.5, 39.0);
+		disparity_cost_volume<decltype(cost)> shifted_volume(left_cam, shifted_cam, true, cost, 16);
+		REQUIRE(shifted_volume.zero_disparity_offset() == 7);
+		disparity_cost_volume<decltype(cost)> reverse_volume(right_cam, left_cam, false, cost, 16);
+		REQUIRE(reverse_volume.zero_disparity_offset() == 0);
+		REQUIRE(reverse_volume.target_coordinates(make_ndptrdiff(20, 10), 3) == make_ndptrdiff(23, 10));
+	}
+	
+	SECTION("raw costs") {
+		cost_volume.compute(0);
+		REQUIRE(cost_volume.volume().shape() == make_ndsize(16, rows, columns));
+		bool all_equal = true;
+		for(std::ptrdiff_t d = 0; d < 16; ++d)
+		for(std::ptrdiff_t y = 0; y < rows; ++y) for(std::ptrdiff_t x = 0; x < columns; ++x)
+			all_equal = all_equal && (cost_volume.aggregated_cost(make_ndptrdiff(x, y), d) == float(cost_volume.cost(make_ndptrdiff(x, y), d)));
+		REQUIRE(all_equal);
+	}
+	
+	SECTION("aggregation") {
+		const std::ptrdiff_t radius = 2;
+		cost_volume.compute(radius);
+		ndarray<3, float> raw(make_ndsize(16, rows, columns));
+		for(std::ptrdiff_t d = 0; d < 16; ++d)
+		for(std::ptrdiff_t y = 0; y < rows; ++y) for(std::ptrdiff_t x = 0; x < columns; ++x)
+			raw[d][y][x] = cost_volume.cost(make_ndptrdiff(x, y), d);
+		
+		bool all_equal = true;
+		for(std::ptrdiff_t d = 0; d < 16; d += 5)
+		for(std::ptrdiff_t y = 0; y < rows; ++y) for(std::ptrdiff_t x = 0; x < columns; ++x) {
+			double sum = 0.0;
+			int count = 0;
+			for(std::ptrdiff_t wy = std::max<std::ptrdiff_t>(y - radius, 0); wy <= std::min(y + radius, rows - 1); ++wy)
+			for(std::ptrdiff_t wx = std::max<std::ptrdiff_t>(x - radius, 0); wx <= std::min(x + radius, columns - 1); ++wx) {
+				sum += raw[d][wy][wx];
+				++count;
+			}
+			all_equal = all_equal && (std::abs(cost_volume.aggregated_cost(make_ndptrdiff(x, y), d) - sum / count) < 1e-3);
+		}
+		REQUIRE(all_equal);
+	}
+	
+	SECTION("disparity extraction") {
+		cost_volume.compute(1);
+		auto count_correct = [&](const ndarray<2, std::int32_t>& disparity_map) {
+			REQUIRE(disparity_map.shape() == make_ndsize(rows, columns));
+			std::ptrdiff_t correct = 0, total = 0;
+			for(std::ptrdiff_t y = 2; y < rows - 2; ++y) for(std::ptrdiff_t x = 12; x < columns - 2; ++x) {
+				correct += (disparity_map[y][x] == true_disparity(y, x));
+				++total;
+			}
+			return double(correct) / total;
+		};
+		REQUIRE(count_correct(cost_volume.winner_take_all()) > 0.9);
+		REQUIRE(count_correct(cost_volume.semi_global_matching(5.0f, 40.0f)) > 0.9);
+	}
+}
@@ -25,6 +25,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #include <string>
 #include <thread>
 #include <utility>
+#include <type_traits>
 #include <functional>
 #include <exception>
 #include <stdexcept>
@@ -75,9 +76,12 @@ private:
 	}
 	
 public:
+	/// Run \a func in new thread.
+	/** \a func is copied into the thread, because it is usually a temporary lambda which gets destroyed before the
+	 ** thread runs. */
 	template<typename Func>
 	thread_runner(Func&& func) :
-		thread_([&]{ thread_main_(std::forward<Func>(func)); }) { }
+		thread_([this, f = std::decay_t<Func>(std::forward<Func>(func))]{ thread_main_(f); }) { }
 	
 	thread_runner(thread_runner&& runner) :
 		thread_(std::move(runner.thread_)) { }